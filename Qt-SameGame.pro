@@ -0,0 +1,12 @@
+# Top-level project: the game, the headless solver, corpus generator and replay verifier, the benchmarks which link its engine and model without the GUI, and the engine tests.
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    SameGame \
+    tools/solve \
+    tools/gencorpus \
+    tools/verify \
+    bench/movescan \
+    bench/engine \
+    tests
@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui
+QT       += core gui concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -14,13 +14,11 @@ TEMPLATE = app
 
 SOURCES += main.cpp\
         samegamewindow.cpp \
-    game.cpp \
     boardview.cpp \
     newgamedialog.cpp
 
 HEADERS  += \
     boardview.hpp \
-    game.hpp \
     samegamewindow.hpp \
     newgamedialog.hpp
 
@@ -28,3 +26,5 @@ FORMS    += samegamewindow.ui \
     newgamedialog.ui
 
 QMAKE_CXXFLAGS += -std=c++11
+
+include(model.pri)
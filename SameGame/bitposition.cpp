@@ -0,0 +1,587 @@
+#include "bitposition.hpp"
+
+/* My headers */
+#include "zobrist.hpp" // Board hashing
+
+/* STL Headers */
+#include <algorithm> // fill(), find(), min(), max()
+#include <cstring> // memmove()
+
+#if defined(__BMI2__) && defined(__x86_64__)
+#include <immintrin.h> // _pext_u64()
+#endif
+
+using namespace std; // To save some typing
+
+/*** Bit helpers ***/
+
+/**
+ * @brief lowestBit Finds the position of the lowest set bit of a word.
+ * @param m_word The word. Must not be 0.
+ * @return The position of the lowest set bit, in [0, 63].
+ */
+static int lowestBit(uint64_t m_word)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(m_word); // Single instruction on most CPUs
+#else
+    int n = 0; // Bit position
+
+    while ((m_word & 1) == 0) // Shift until the lowest bit is set
+    {
+        m_word >>= 1;
+        n++;
+    }
+
+    return n;
+#endif
+}
+
+/**
+ * @brief countBits Counts the set bits of a word.
+ * @param m_word The word.
+ * @return The # of set bits.
+ */
+static int countBits(uint64_t m_word)
+{
+#ifdef __GNUC__
+    return __builtin_popcountll(m_word);
+#else
+    int n = 0; // # of bits so far
+
+    for ( ; m_word != 0; m_word &= m_word - 1) // Clear the lowest bit until none are left
+    {
+        n++;
+    }
+
+    return n;
+#endif
+}
+
+/**
+ * @brief squeeze Removes some bits from a column mask, and moves the bits above each of them down one place: the blocks above a
+ * removed block fall onto the blocks below it.
+ * @param m_mask The column mask.
+ * @param m_removed The bits to remove.
+ * @return The mask with the removed bits squeezed out.
+ */
+static uint64_t squeeze(uint64_t m_mask, uint64_t m_removed)
+{
+#if defined(__BMI2__) && defined(__x86_64__)
+    return _pext_u64(m_mask, ~m_removed); // Gathers the kept bits at the bottom in one instruction
+#else
+    uint64_t below; // Bits below the lowest removed bit
+
+    while (m_removed != 0) // Remove the lowest bit, and shift everything above it (the other removed bits too) down one place
+    {
+        below = (m_removed & (0 - m_removed)) - 1;
+        m_mask = (m_mask & below) | ((m_mask >> 1) & ~below);
+        m_removed = (m_removed >> 1) & ~below;
+    }
+
+    return m_mask;
+#endif
+}
+
+/**
+ * @brief fillColumn Grows a set of blocks within one column to the whole vertical runs of blocks which contain them.
+ * @param m_seed The blocks. Must be a subset of m_mask.
+ * @param m_mask The blocks of the same colour in the column.
+ * @return The runs.
+ */
+static uint64_t fillColumn(uint64_t m_seed, uint64_t m_mask)
+{
+    uint64_t prev; // The runs before the last step
+
+    do // Grow one row up and down until nothing changes
+    {
+        prev = m_seed;
+        m_seed = (m_seed | (m_seed << 1) | (m_seed >> 1)) & m_mask;
+    }
+    while (m_seed != prev);
+
+    return m_seed;
+}
+
+/**
+ * @brief isEmptyColumn Determines if a column holds no blocks.
+ * @param m_masks The column's masks.
+ * @param m_nColours The # of masks.
+ * @return True if every mask is 0.
+ */
+static bool isEmptyColumn(const uint64_t* m_masks, int m_nColours)
+{
+    int k; // Colour counter
+
+    for (k = 0; k < m_nColours; k++)
+    {
+        if (m_masks[k] != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief runAbove Fetches the vertical run of blocks which starts at a block and goes up, in one step: adding the block's bit to
+ * the mask carries through the run, flipping exactly its bits and the empty bit above it.
+ * @param m_bit The block's bit. Must be in m_mask.
+ * @param m_mask The blocks of the same colour in the column.
+ * @return The run.
+ */
+static uint64_t runAbove(uint64_t m_bit, uint64_t m_mask)
+{
+    return ((m_mask + m_bit) ^ m_mask) & m_mask;
+}
+
+/*** Constructors ***/
+
+/**
+ * @brief BitPosition::BitPosition Constructor. Creates a position on an empty 0x0 board, with no points.
+ */
+BitPosition::BitPosition() :
+    m_rows(0),
+    m_cols(0),
+    m_width(0),
+    m_nColours(0),
+    m_score(0),
+    m_hash(0), // Empty boards hash to 0
+    m_hashValid(true)
+{
+}
+
+/**
+ * @brief BitPosition::BitPosition Constructor. Creates a position on a copy of the given board. Each colour on the board gets its
+ * own masks.
+ * @param m_board The board. Must have at most BITPOSITION_MAX_ROWS rows, and its blocks must rest on the bottom and the left,
+ * as they always do after a move.
+ * @param m_score The points already scored.
+ */
+BitPosition::BitPosition(const BoardGrid& m_board, int m_score) :
+    m_rows(m_board.getRows()),
+    m_cols(m_board.getCols()),
+    m_width(0),
+    m_score(m_score),
+    m_hash(0),
+    m_hashValid(false)
+{
+    int x; // Column counter
+    int y; // Row counter
+    Cell c; // Current cell
+
+    for (y = 0; y < m_rows; y++) // Find the colours
+    {
+        for (x = 0; x < m_cols; x++)
+        {
+            c = m_board.at(x, y);
+
+            if (c != BoardGrid::EMPTY && find(c_colours.begin(), c_colours.end(), c) == c_colours.end()) // New colour
+            {
+                c_colours.push_back(c);
+            }
+        }
+    }
+
+    m_nColours = c_colours.size();
+    c_masks.assign((m_cols+2) * m_nColours, 0);
+    c_group.assign(m_cols+2, 0);
+    c_movable.assign(m_cols+2, 0);
+    c_first.assign(m_cols+2, 0);
+
+    for (y = 0; y < m_rows; y++) // Set each block's bit
+    {
+        for (x = 0; x < m_cols; x++)
+        {
+            c = m_board.at(x, y);
+
+            if (c != BoardGrid::EMPTY)
+            {
+                column(x)[find(c_colours.begin(), c_colours.end(), c) - c_colours.begin()] |= uint64_t(1) << (m_rows-1 - y);
+            }
+        }
+    }
+
+    while (m_width < m_cols && m_board.at(m_width, m_rows-1) != BoardGrid::EMPTY) // Count the occupied columns
+    {
+        m_width++;
+    }
+}
+
+/*** Copying ***/
+
+/**
+ * @brief BitPosition::assign Copies another position's board, score and hash. The scratch buffers aren't copied, and once both
+ * positions have the same board size and colours, no memory is allocated.
+ * @param m_other The position to copy.
+ */
+void BitPosition::assign(const BitPosition& m_other)
+{
+    m_rows = m_other.m_rows;
+    m_cols = m_other.m_cols;
+    m_width = m_other.m_width;
+    m_nColours = m_other.m_nColours;
+    m_score = m_other.m_score;
+    m_hash = m_other.m_hash;
+    m_hashValid = m_other.m_hashValid;
+    c_colours = m_other.c_colours;
+    c_masks = m_other.c_masks; // Reuses our masks if they are big enough
+
+    if (c_group.size() != size_t(m_cols+2)) // Board size changed
+    {
+        c_group.assign(m_cols+2, 0);
+        c_movable.assign(m_cols+2, 0);
+        c_first.assign(m_cols+2, 0);
+    }
+}
+
+/**
+ * @brief BitPosition::store Copies the board into a BoardGrid.
+ * @param m_board The board to copy into. Resized to fit.
+ */
+void BitPosition::store(BoardGrid& m_board) const
+{
+    int x; // Column counter
+    int k; // Colour counter
+    uint64_t bits; // Blocks of the current colour which haven't been copied yet
+
+    m_board.resize(m_rows, m_cols);
+
+    for (x = 0; x < m_width; x++) // Loop through the occupied columns
+    {
+        for (k = 0; k < m_nColours; k++)
+        {
+            for (bits = column(x)[k]; bits != 0; bits &= bits - 1) // Loop through the blocks
+            {
+                m_board.set(x, m_rows-1 - lowestBit(bits), c_colours[k]);
+            }
+        }
+    }
+}
+
+/*** Queries ***/
+
+/**
+ * @brief BitPosition::getHash Fetches the board's Zobrist hash, computing it if a move has been played since it was last asked
+ * for. Uses the board indices a BoardGrid of the same size would, so the hash is the same as Position's.
+ * @return The hash.
+ */
+uint64_t BitPosition::getHash() const
+{
+    int x; // Column counter
+    int k; // Colour counter
+    uint64_t bits; // Blocks of the current colour which haven't been hashed yet
+
+    if (!m_hashValid) // Stale
+    {
+        m_hash = 0;
+
+        for (x = 0; x < m_width; x++)
+        {
+            for (k = 0; k < m_nColours; k++)
+            {
+                for (bits = column(x)[k]; bits != 0; bits &= bits - 1)
+                {
+                    m_hash ^= zobristKey((m_rows - lowestBit(bits)) * (m_cols+2) + x + 1, c_colours[k]); // Row from the top is m_rows-1 - bit
+                }
+            }
+        }
+
+        m_hashValid = true;
+    }
+
+    return m_hash;
+}
+
+/**
+ * @brief BitPosition::isOver Determines if no legal move is left: no colour's mask overlaps itself shifted up by one row, or the
+ * same colour's mask in the next column.
+ * @return True if the game is over.
+ */
+bool BitPosition::isOver() const
+{
+    const uint64_t* cur; // Masks of the current column
+    const uint64_t* next; // Masks of the column to its right. The padding column after the board is empty.
+    int x; // Column counter
+    int k; // Colour counter
+
+    for (x = 0; x < m_width; x++)
+    {
+        cur = column(x);
+        next = cur + m_nColours;
+
+        for (k = 0; k < m_nColours; k++)
+        {
+            if ((cur[k] & ((cur[k] >> 1) | next[k])) != 0) // A block with the same colour above it or to its right
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/*** Moves ***/
+
+/**
+ * @brief BitPosition::play Plays a move, with the same rules and scoring as Position::play(). The group is grown as a mask, then
+ * each column which lost blocks has the group's bits squeezed out of every colour's mask, and empty columns are dropped.
+ * @param m_move The move.
+ * @return The # of blocks removed, or 0 if the move isn't on the board, is on an empty cell, or is on a single block.
+ */
+int BitPosition::play(const Move& m_move)
+{
+    uint64_t bit; // Bit of the clicked block
+    uint64_t* masks; // Masks of its column
+    int colour; // Colour of the clicked block
+    int n; // # of blocks removed
+    int lo; // Leftmost column which lost blocks
+    int hi; // Rightmost column which lost blocks
+    int x; // Column counter
+    int k; // Colour counter
+    int d; // Column the next occupied column moves to
+    bool gap = false; // True if a column was emptied
+
+    if (m_move.x < 0 || m_move.x >= m_width || m_move.y < 0 || m_move.y >= m_rows) // Not on the board, or in an empty column
+    {
+        return 0;
+    }
+
+    bit = uint64_t(1) << (m_rows-1 - m_move.y);
+    masks = column(m_move.x);
+
+    for (colour = 0; colour < m_nColours && (masks[colour] & bit) == 0; colour++) // Find the block's colour
+    {
+    }
+
+    if (colour == m_nColours // Nothing to remove
+        || (((masks[colour] << 1) | (masks[colour] >> 1) | masks[colour - m_nColours] | masks[colour + m_nColours]) & bit) == 0) // Single block
+    {
+        return 0;
+    }
+
+    n = grow(colour, m_move.x, bit, lo, hi);
+
+    for (x = lo; x <= hi; x++) // Let the blocks fall
+    {
+        masks = column(x);
+
+        for (k = 0; k < m_nColours; k++)
+        {
+            masks[k] = squeeze(masks[k], c_group[x+1]);
+        }
+
+        c_group[x+1] = 0;
+        gap = gap || (masks[colour] == 0 && isEmptyColumn(masks, m_nColours)); // Only a colour which lost blocks can empty a column
+    }
+
+    if (gap) // Drop the empty columns
+    {
+        for (x = d = lo; x < m_width; x++)
+        {
+            masks = column(x);
+
+            if (isEmptyColumn(masks, m_nColours))
+            {
+                continue;
+            }
+
+            if (d != x)
+            {
+                memmove(column(d), masks, m_nColours * sizeof(uint64_t));
+            }
+
+            d++;
+        }
+
+        fill(column(d), column(m_width), 0);
+        m_width = d;
+    }
+
+    m_hashValid = false;
+    m_score += (n*(n+1))/2; // Same scoring as Game
+    return n;
+}
+
+/**
+ * @brief BitPosition::legalMoves Lists every legal move, in the same order as Position::legalMoves(): the first block of each
+ * group with at least 2 blocks, in a scan of the rows from the bottom up and of each row from left to right. Each colour's blocks
+ * which have a neighbour of their colour are found with one pass of shifts and ANDs, then grown into groups one group at a time.
+ * Most groups are a run within one column, or runs in two columns which touch nothing else, and are found without growing them.
+ * The first block of a group in scan order is its lowest block, leftmost among equals; those blocks are marked in a mask per
+ * column, then sorted by row with a counting sort.
+ * @param m_moves Receives the moves. Its previous contents are discarded.
+ * @return The # of legal moves.
+ */
+int BitPosition::legalMoves(vector<Move>& m_moves)
+{
+    const uint64_t* masks; // Masks of the current column
+    uint64_t* movable = c_movable.data() + 1; // Blocks of the current colour which start groups, by column
+    uint64_t* first = c_first.data() + 1; // First block of each group found, by column
+    uint64_t m; // Mask of the current colour in the current column
+    uint64_t run; // Vertical run of the current group's seed block
+    uint64_t right; // Runs of the same colour which it touches in the next column
+    uint64_t bits; // First blocks of a column which haven't been counted or placed yet
+    int starts[BITPOSITION_MAX_ROWS] = {}; // # of groups starting on each row, then the place of the row's next move
+    int total = 0; // # of legal moves
+    int n; // # of groups starting on a row
+    int x; // Column counter
+    int i; // Column counter, within a group
+    int k; // Colour counter
+    int b; // Row counter, from the bottom
+    int lo; // Leftmost column of the current group
+    int hi; // Rightmost column of the current group
+    int firstRow; // Lowest row of the current group, from the bottom
+    int firstCol; // Leftmost column of the group on that row
+
+    for (k = 0; k < m_nColours; k++) // Loop through the colours
+    {
+        for (x = 0; x < m_width; x++) // Find the blocks with a neighbour of the same colour
+        {
+            masks = column(x);
+            m = masks[k];
+            movable[x] = m & ((m << 1) | (m >> 1) | masks[k - m_nColours] | masks[k + m_nColours]);
+        }
+
+        for (x = 0; x < m_width; x++) // Grow each group from its leftmost column. Groups reaching further left were found already.
+        {
+            masks = column(x);
+
+            while (movable[x] != 0)
+            {
+                run = runAbove(movable[x] & (0 - movable[x]), masks[k]); // The block below a movable block of its colour is movable too, so the lowest one starts its run
+
+                right = fillColumn(run & masks[k + m_nColours], masks[k + m_nColours]); // The runs it touches in the next column
+
+                if (right == 0) // The run is the whole group
+                {
+                    first[x] |= run & (0 - run);
+                    movable[x] &= ~run;
+                    continue;
+                }
+
+                if ((right & (masks[k + 2*m_nColours] | (masks[k] & ~run))) == 0) // The group is those runs, in two columns
+                {
+                    if (lowestBit(right) < lowestBit(run)) // Strictly lower, so ties keep the left column
+                    {
+                        first[x+1] |= right & (0 - right);
+                    }
+
+                    else
+                    {
+                        first[x] |= run & (0 - run);
+                    }
+
+                    movable[x] &= ~run;
+                    movable[x+1] &= ~right;
+                    continue;
+                }
+
+                grow(k, x, run & (0 - run), lo, hi);
+                firstRow = BITPOSITION_MAX_ROWS;
+                firstCol = lo;
+
+                for (i = lo; i <= hi; i++) // Find the group's first block, and take the group out of the movable blocks
+                {
+                    if (c_group[i+1] != 0 && lowestBit(c_group[i+1]) < firstRow) // Strictly lower, so ties keep the leftmost column
+                    {
+                        firstRow = lowestBit(c_group[i+1]);
+                        firstCol = i;
+                    }
+
+                    movable[i] &= ~c_group[i+1];
+                    c_group[i+1] = 0;
+                }
+
+                first[firstCol] |= uint64_t(1) << firstRow;
+            }
+        }
+    }
+
+    for (x = 0; x < m_width; x++) // Count the groups starting on each row
+    {
+        for (bits = first[x]; bits != 0; bits &= bits - 1)
+        {
+            starts[lowestBit(bits)]++;
+        }
+    }
+
+    for (b = 0; b < m_rows; b++) // Turn the counts into the place of each row's first move
+    {
+        n = starts[b];
+        starts[b] = total;
+        total += n;
+    }
+
+    m_moves.resize(total);
+
+    for (x = 0; x < m_width; x++) // Place the moves, column by column, so that each row's moves are in column order
+    {
+        for (bits = first[x]; bits != 0; bits &= bits - 1)
+        {
+            b = lowestBit(bits);
+            m_moves[starts[b]].x = x;
+            m_moves[starts[b]].y = m_rows-1 - b;
+            starts[b]++;
+        }
+
+        first[x] = 0;
+    }
+
+    return total;
+}
+
+/*** Helpers ***/
+
+/**
+ * @brief BitPosition::grow Finds the group containing a block, as a mask per column in c_group, which must be all zero. The
+ * group is grown within a column to whole vertical runs at once, then into the columns beside it through the blocks of the same
+ * colour next to it. Only columns whose part of the group has grown are looked at again, so a small group costs a few masks.
+ * @param m_colour The block's colour.
+ * @param m_x The block's column.
+ * @param m_seed The block's bit.
+ * @param m_loCol Receives the leftmost column of the group.
+ * @param m_hiCol Receives the rightmost column of the group.
+ * @return The # of blocks in the group.
+ */
+int BitPosition::grow(int m_colour, int m_x, uint64_t m_seed, int& m_loCol, int& m_hiCol)
+{
+    uint64_t* group = c_group.data() + 1; // The group, by column. The padding columns have no blocks, so the group never reaches them.
+    uint64_t mask; // Blocks of the colour in the neighbouring column
+    uint64_t seed; // Blocks of the group which it reaches in the neighbouring column
+    int x; // Column whose part of the group has grown
+    int nb; // Column beside it
+    int n; // # of blocks in the group
+
+    group[m_x] = fillColumn(m_seed, column(m_x)[m_colour]);
+    n = countBits(group[m_x]);
+    m_loCol = m_hiCol = m_x;
+    c_work.clear();
+    c_work.push_back(m_x);
+
+    while (!c_work.empty()) // Loop until no column's part of the group grows
+    {
+        x = c_work.back();
+        c_work.pop_back();
+
+        for (nb = x-1; nb <= x+1; nb += 2) // The columns to the left and right
+        {
+            mask = column(nb)[m_colour];
+            seed = group[x] & mask & ~group[nb]; // Blocks beside the group which aren't in it yet
+
+            if (seed != 0) // The group grows into this column
+            {
+                seed = fillColumn(seed, mask) & ~group[nb]; // Runs are either wholly in the group or not at all
+                group[nb] |= seed;
+                n += countBits(seed);
+                m_loCol = min(m_loCol, nb);
+                m_hiCol = max(m_hiCol, nb);
+                c_work.push_back(nb);
+            }
+        }
+    }
+
+    return n;
+}
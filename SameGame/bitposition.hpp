@@ -0,0 +1,72 @@
+#ifndef BITPOSITION_HPP
+#define BITPOSITION_HPP
+
+/* C++ Headers */
+#include <cstdint> // uint64_t
+#include <vector> // STL vectors
+
+/* My headers */
+#include "boardgrid.hpp" // Boards to copy from
+#include "position.hpp" // Moves, and the rules this follows
+
+using namespace std;
+
+#define BITPOSITION_MAX_ROWS 64 // Tallest board a BitPosition can hold: one bit per row
+
+/**
+ * @brief The BitPosition class. A Position stored as bitboards: one 64-bit mask per column for each colour on the board, with
+ * bit 0 on the bottom row. It has the same rules, scoring, move order and hash keys as Position, and the subset of its interface
+ * which search code uses, so the solver gives the same results with it.
+ *
+ * Masks are per column rather than per row because that is the direction blocks fall in: once a group is removed, each column
+ * only has to squeeze the removed bits out of its masks, and an empty column is dropped by moving whole columns of masks left.
+ * Groups are found by growing a mask of cells, a column at a time, with shifts and ANDs, and a board has moves left if any
+ * colour's mask overlaps itself shifted by one row or its neighbouring column's mask.
+ *
+ * Only boards with at most BITPOSITION_MAX_ROWS rows fit.
+ */
+class BitPosition
+{
+    public:
+        /* Constructors */
+        BitPosition(); // Creates a position on an empty 0x0 board
+        explicit BitPosition(const BoardGrid& m_board, int m_score = 0); // Creates a position on a board with at most BITPOSITION_MAX_ROWS rows
+
+        /* Copying */
+        void assign(const BitPosition& m_other); // Copies another position's board, score and hash, but not its scratch buffers
+        void store(BoardGrid& m_board) const; // Copies the board into a BoardGrid, resizing it to fit
+
+        /* Queries */
+        int getScore() const { return m_score; } // Fetches the points scored so far
+        uint64_t getHash() const; // Fetches the Zobrist hash of the board, with the same keys as Position
+        bool isOver() const; // True if no legal move is left
+
+        /* Moves */
+        int play(const Move& m_move); // Plays a move and returns the # of blocks removed, or 0 if the move wasn't legal
+        int legalMoves(vector<Move>& m_moves); // Lists one block of each group which can be removed, in the same order as Position
+
+    private:
+        /* Helpers */
+        const uint64_t* column(int m_x) const { return &c_masks[(m_x+1) * m_nColours]; } // Fetches the masks of a column
+        uint64_t* column(int m_x) { return &c_masks[(m_x+1) * m_nColours]; } // Fetches the masks of a column
+        int grow(int m_colour, int m_x, uint64_t m_seed, int& m_loCol, int& m_hiCol); // Finds the group containing a block, in c_group
+
+        /* Data */
+        int m_rows; // # of rows
+        int m_cols; // # of columns
+        int m_width; // # of occupied columns. They are always the leftmost ones.
+        int m_nColours; // # of colours which were on the starting board
+        int m_score; // Points scored so far
+        mutable uint64_t m_hash; // Zobrist hash of the board, if m_hashValid
+        mutable bool m_hashValid; // False once a move has made m_hash stale
+        vector<Cell> c_colours; // Cell value of each colour
+        vector<uint64_t> c_masks; // Masks of each colour, column by column, with an empty column on either side of the board
+
+        /* Scratch buffers */
+        vector<uint64_t> c_group; // Cells of the group being grown, per column, with the same padding as c_masks. Zero between uses.
+        vector<uint64_t> c_movable; // Blocks of one colour which have a neighbour of that colour and aren't in a listed group yet
+        vector<int> c_work; // Columns whose part of the group being grown has to be grown into their neighbours
+        vector<uint64_t> c_first; // First block of each group found by legalMoves(), per column, with the same padding. Zero between uses.
+};
+
+#endif // BITPOSITION_HPP
@@ -0,0 +1,199 @@
+#include "boardgenerator.hpp"
+
+/* My headers */
+#include "threadpool.hpp" // Workers
+
+/* STL Headers */
+#include <algorithm> // min()
+#include <cstring> // memcpy()
+
+using namespace std; // To save some typing
+
+/* Defines */
+#define GEN_CHUNK_CELLS (1 << 20) // Rough # of cells generated by one task
+
+/*** Types ***/
+enum Direction
+{
+    LEFT = 1, // Start at 1
+    RIGHT,
+    TOP,
+    BOTTOM
+};
+
+/*** Constructor ***/
+
+/**
+ * @brief BoardGenerator::BoardGenerator Constructor. Creates a generator with no boards.
+ * @param m_rows The # of rows on each board.
+ * @param m_cols The # of columns on each board.
+ * @param m_nColours The # of colours, excluding black.
+ */
+BoardGenerator::BoardGenerator(int m_rows, int m_cols, int m_nColours) :
+    m_rows(m_rows),
+    m_cols(m_cols),
+    m_nColours(m_nColours),
+    m_count(0),
+    m_firstSeed(0)
+{
+}
+
+/*** Generation ***/
+
+/**
+ * @brief BoardGenerator::generate Generates a batch of boards, replacing any generated before. The arena is allocated once, and
+ * the boards are split into chunks of about a million cells, which the workers generate in place.
+ * @param m_firstSeed Seed of the first board. Board i gets seed firstSeed + i.
+ * @param m_count The # of boards to generate.
+ * @param m_nThreads The # of threads to generate on, or 0 for one per core.
+ */
+void BoardGenerator::generate(uint64_t m_firstSeed, size_t m_count, int m_nThreads)
+{
+    size_t cells = size_t(m_rows) * m_cols; // Cells per board
+    size_t chunk = max<size_t>(1, GEN_CHUNK_CELLS / max<size_t>(1, cells)); // Boards per task
+    size_t lo; // First board of a chunk
+    ThreadPool pool(m_nThreads); // Workers
+
+    this->m_firstSeed = m_firstSeed;
+    this->m_count = m_count;
+    c_arena.assign(m_count * cells, BoardGrid::EMPTY); // fill() expects empty boards
+
+    for (lo = 0; lo < m_count; lo += chunk) // Queue the chunks
+    {
+        size_t hi = min(m_count, lo + chunk); // One past the last board of the chunk
+
+        pool.submit([this, lo, hi, cells] ()
+        {
+            Rng rng; // Restarted for each board
+            size_t i; // Board counter
+
+            for (i = lo; i < hi; i++)
+            {
+                rng.seed(getSeed(i));
+                skipColours(rng, this->m_nColours);
+                fill(rng, this->m_nColours, &c_arena[i * cells], this->m_rows, this->m_cols, this->m_cols);
+            }
+        });
+    }
+
+    pool.wait();
+}
+
+/**
+ * @brief BoardGenerator::skipColours Draws the numbers which Game draws to pick its colours, before it fills the board: a red,
+ * green and blue component in [1, 255] for each colour.
+ * @param m_rng The generator, freshly seeded.
+ * @param m_nColours The # of colours.
+ */
+void BoardGenerator::skipColours(Rng& m_rng, int m_nColours)
+{
+    int i; // Component counter
+
+    for (i = 0; i < 3 * m_nColours; i++)
+    {
+        m_rng.inRange(1, 255);
+    }
+}
+
+/**
+ * @brief BoardGenerator::fill Fills an empty board with blocks. The top-left block gets a random colour, then random directions
+ * are drawn (never the same one twice) until one with empty cells is found, and a random # of the cells in that direction get
+ * the same colour. Only right and down can have empty cells next to the top-left block. Every other cell gets a random colour,
+ * row by row.
+ *
+ * This draws exactly the same numbers, in the same order, as Game's original cell-by-cell set-up, so it gives the same board
+ * for the same seed. Unlike it, a 1x1 board doesn't loop forever looking for a direction.
+ * @param m_rng The generator.
+ * @param m_nColours The # of colours, excluding black.
+ * @param m_origin The board's top-left cell. Every cell must be empty.
+ * @param m_rows The # of rows.
+ * @param m_cols The # of columns.
+ * @param m_stride The distance between two vertically adjacent cells.
+ */
+void BoardGenerator::fill(Rng& m_rng, int m_nColours, Cell* m_origin, int m_rows, int m_cols, int m_stride)
+{
+    bool used[BOTTOM+1] = { false }; // Directions drawn so far
+    Cell first; // Colour of the top-left block and its run
+    Cell* row; // Row being filled
+    int dir; // Direction drawn
+    int n; // Length of the run
+    int x; // Column counter
+    int y; // Row counter
+
+    if (m_rows <= 0 || m_cols <= 0) // Nothing to fill
+    {
+        return;
+    }
+
+    first = Cell(m_rng.inRange(1, m_nColours));
+    m_origin[0] = first;
+
+    while (m_rows > 1 || m_cols > 1) // Draw directions until one has room for a run
+    {
+        dir = m_rng.inRange(LEFT, BOTTOM);
+
+        if (used[dir]) // Already tried, draw again
+        {
+            continue;
+        }
+
+        used[dir] = true;
+
+        if (dir == RIGHT && m_cols > 1) // Run along the top row
+        {
+            n = m_rng.inRange(1, m_cols - 1);
+
+            for (x = 1; x <= n; x++)
+            {
+                m_origin[x] = first;
+            }
+
+            break;
+        }
+
+        if (dir == BOTTOM && m_rows > 1) // Run down the left column
+        {
+            n = m_rng.inRange(1, m_rows - 1);
+
+            for (y = 1; y <= n; y++)
+            {
+                m_origin[y * m_stride] = first;
+            }
+
+            break;
+        }
+    }
+
+    for (y = 0; y < m_rows; y++) // Give every other cell a random colour
+    {
+        row = m_origin + y * m_stride;
+
+        for (x = 0; x < m_cols; x++)
+        {
+            if (row[x] == BoardGrid::EMPTY) // Not part of the run
+            {
+                row[x] = Cell(m_rng.inRange(1, m_nColours));
+            }
+        }
+    }
+}
+
+/*** Access ***/
+
+/**
+ * @brief BoardGenerator::copyTo Copies a generated board into a BoardGrid, resizing it to fit.
+ * @param m_i The board's index.
+ * @param m_board The grid to copy into.
+ */
+void BoardGenerator::copyTo(size_t m_i, BoardGrid& m_board) const
+{
+    const Cell* src = getBoard(m_i); // Board's first row
+    int y; // Row counter
+
+    m_board.resize(m_rows, m_cols);
+
+    for (y = 0; y < m_rows; y++) // Copy row by row, inside the border
+    {
+        memcpy(m_board.data() + m_board.index(0, y), src + y * m_cols, m_cols);
+    }
+}
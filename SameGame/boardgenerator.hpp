@@ -0,0 +1,52 @@
+#ifndef BOARDGENERATOR_HPP
+#define BOARDGENERATOR_HPP
+
+/* C++ Headers */
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+#include <vector> // STL vectors
+
+/* My headers */
+#include "boardgrid.hpp" // Cells, and boards to copy into
+#include "rng.hpp" // Random numbers
+
+using namespace std;
+
+/**
+ * @brief The BoardGenerator class. Generates boards in bulk, with the same layout as Game: the top-left block and a random run
+ * of blocks to its right or below it share a colour, and every other block gets a random colour.
+ *
+ * Boards are written straight into one preallocated arena, row by row with no border, and generated on a ThreadPool. Board i is
+ * generated from seed firstSeed + i, exactly as Game(rows, cols, nColours, firstSeed + i) would generate it, so any board in a
+ * corpus can be played as a Game, and any Game can be found again in a corpus.
+ */
+class BoardGenerator
+{
+    public:
+        /* Constructor */
+        BoardGenerator(int m_rows, int m_cols, int m_nColours); // Creates a generator for boards of the given size and # of colours
+
+        /* Generation */
+        void generate(uint64_t m_firstSeed, size_t m_count, int m_nThreads = 0); // Generates boards for the seeds [firstSeed, firstSeed + count), on the given # of threads, or one per core if 0
+        static void skipColours(Rng& m_rng, int m_nColours); // Draws the numbers Game spends on picking its colours
+        static void fill(Rng& m_rng, int m_nColours, Cell* m_origin, int m_rows, int m_cols, int m_stride); // Fills an empty board with blocks
+
+        /* Access */
+        size_t getCount() const { return m_count; } // Fetches the # of boards generated
+        int getRows() const { return m_rows; } // Fetches the # of rows on each board
+        int getCols() const { return m_cols; } // Fetches the # of columns on each board
+        int getNumColours() const { return m_nColours; } // Fetches the # of colours
+        uint64_t getSeed(size_t m_i) const { return m_firstSeed + m_i; } // Fetches the seed board i was generated from
+        const Cell* getBoard(size_t m_i) const { return c_arena.data() + m_i * m_rows * m_cols; } // Fetches board i's cells, row by row
+        void copyTo(size_t m_i, BoardGrid& m_board) const; // Copies board i into a BoardGrid
+
+    private:
+        int m_rows; // # of rows on each board
+        int m_cols; // # of columns on each board
+        int m_nColours; // # of colours, excluding black
+        size_t m_count; // # of boards generated
+        uint64_t m_firstSeed; // Seed of board 0
+        vector<Cell> c_arena; // Every board's cells, one board after another
+};
+
+#endif // BOARDGENERATOR_HPP
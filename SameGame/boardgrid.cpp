@@ -0,0 +1,301 @@
+#include "boardgrid.hpp"
+
+/* My headers */
+#include "movescan.hpp" // Vectorised scan for legal moves
+
+/* STL Headers */
+#include <algorithm> // fill(), find_if()
+
+using namespace std; // To save some typing
+
+/*** Constants ***/
+const Cell BoardGrid::EMPTY; // Definitions, so that the constants can be passed by reference
+const Cell BoardGrid::BORDER;
+const Cell BoardGrid::REMOVED;
+
+/*** Constructors ***/
+
+/**
+ * @brief BoardGrid::BoardGrid Constructor. Creates an empty board with no cells.
+ */
+BoardGrid::BoardGrid()
+{
+    resize(0, 0); // Only the border
+}
+
+/**
+ * @brief BoardGrid::BoardGrid Constructor. Creates an empty board of the given size.
+ * @param m_rows The number of rows on the board.
+ * @param m_cols The number of columns on the board.
+ */
+BoardGrid::BoardGrid(int m_rows, int m_cols)
+{
+    resize(m_rows, m_cols); // Allocate the cells and the border
+}
+
+/*** Size ***/
+
+/**
+ * @brief BoardGrid::resize Resizes the board to the given size and empties it.
+ * @param m_newRows The new number of rows.
+ * @param m_newCols The new number of columns.
+ */
+void BoardGrid::resize(int m_newRows, int m_newCols)
+{
+    m_rows = m_newRows; // Store the new size
+    m_cols = m_newCols;
+    m_stride = m_cols + 2; // Each row has a border cell on its left and on its right
+    c_cells.assign((m_rows+2) * m_stride, BORDER); // A border row above and below the board. Everything starts as border...
+    clear(); // ...and then the board itself is emptied.
+}
+
+/*** Whole-board operations ***/
+
+/**
+ * @brief BoardGrid::clear Sets every cell on the board (but not the border) to EMPTY.
+ */
+void BoardGrid::clear()
+{
+    int r; // Row counter
+
+    for (r = 0; r < m_rows; r++) // Loop through the rows
+    {
+        fill(c_cells.begin() + index(0, r), c_cells.begin() + index(m_cols, r), EMPTY); // Empty this row
+    }
+}
+
+/**
+ * @brief BoardGrid::isEmpty Determines if every cell on the board is empty.
+ * @return True if the board is empty, false otherwise.
+ */
+bool BoardGrid::isEmpty() const
+{
+    int r; // Row counter
+    const Cell* rowStart; // First cell of the current row
+
+    for (r = 0; r < m_rows; r++) // Loop through the rows
+    {
+        rowStart = c_cells.data() + index(0, r); // Skip the left border
+
+        if (find_if(rowStart, rowStart + m_cols, [](Cell m_c) { return m_c != EMPTY; }) != rowStart + m_cols) // Found a cell which isn't empty
+        {
+            return false;
+        }
+    }
+
+    return true; // If we got here, the board is empty
+}
+
+/**
+ * @brief BoardGrid::hasMoves Determines if any cell on the board has a neighbour of the same colour, without using a group
+ * index. Each row is compared with itself shifted by one cell and with the row below in a single vectorised pass, which stops
+ * at the first pair it finds.
+ * @return True if a legal move exists, false otherwise.
+ */
+bool BoardGrid::hasMoves() const
+{
+    if (m_rows == 0 || m_cols == 0) // No cells at all
+    {
+        return false;
+    }
+
+    return scanForMove(c_cells.data(), index(0, 0), index(m_cols-1, m_rows-1) + 1, m_stride); // Every cell on the board
+}
+
+/*** Group operations ***/
+
+/**
+ * @brief BoardGrid::floodRemove Removes the group of same-coloured cells which contains the given cell, using an iterative
+ * scanline flood fill. Each run of the group's colour along a row is cleared in one go, and only the first cell of each matching
+ * run in the rows above and below is pushed onto the work stack, so the stack stays small even for very large groups.
+ * @param m_start The index of a cell in the group.
+ * @param m_work A work stack for the fill. Passed in so that its memory can be reused between calls. Its contents are discarded.
+ * @param m_removed Receives the indices of the removed cells. Its previous contents are discarded.
+ * @param m_fill The value to write into the removed cells. Must not be the group's colour.
+ * @return The number of cells removed. 0 if the starting cell is empty or part of the border.
+ */
+int BoardGrid::floodRemove(int m_start, vector<int>& m_work, vector<int>& m_removed, Cell m_fill)
+{
+    Cell colour = c_cells[m_start]; // Colour of the group
+    Cell* cells = c_cells.data(); // Cells of the board, for quicker access
+    int seed; // Cell popped off the work stack
+    int left; // Leftmost cell of the current run
+    int right; // Rightmost cell of the current run
+    int i; // Cell counter
+    size_t n; // # of cells removed before the current run
+    int dir; // Direction counter (up, then down)
+    int offset; // Offset to the row above or below
+    bool inRun; // True while we're walking through a matching run in the row above or below
+
+    m_work.clear(); // Start with empty buffers
+    m_removed.clear();
+
+    if (colour == EMPTY || colour == BORDER || colour == m_fill) // Nothing to remove
+    {
+        return 0;
+    }
+
+    m_work.push_back(m_start); // Start at the given cell
+
+    while (!m_work.empty()) // Loop until every run of the group has been cleared
+    {
+        seed = m_work.back(); // Fetch the next seed
+        m_work.pop_back();
+
+        if (cells[seed] != colour) // Already cleared as part of another run
+        {
+            continue;
+        }
+
+        /* Find the whole run along this row. The border stops both loops at the edges. */
+        left = seed;
+        right = seed;
+
+        while (cells[left-1] == colour) // Extend to the left
+        {
+            left--;
+        }
+
+        while (cells[right+1] == colour) // Extend to the right
+        {
+            right++;
+        }
+
+        /* Clear the run, and remember its cells for the caller */
+        fill(cells + left, cells + right + 1, m_fill);
+        n = m_removed.size();
+        m_removed.resize(n + (right - left + 1));
+
+        for (i = left; i <= right; i++)
+        {
+            m_removed[n + (i - left)] = i;
+        }
+
+        /* Seed the matching runs in the rows above and below */
+        for (dir = 0; dir < 2; dir++)
+        {
+            offset = (dir == 0) ? -m_stride : m_stride; // Row above first, then the row below
+            inRun = false;
+
+            for (i = left; i <= right; i++)
+            {
+                if (cells[i+offset] == colour) // Part of the group
+                {
+                    if (!inRun) // Only the first cell of each run needs to be pushed
+                    {
+                        m_work.push_back(i+offset);
+                        inRun = true;
+                    }
+                }
+
+                else // The run ended
+                {
+                    inRun = false;
+                }
+            }
+        }
+    }
+
+    return m_removed.size(); // Every removed cell was recorded
+}
+
+/**
+ * @brief BoardGrid::compact Compacts the board after floodRemove() marked a group's cells as REMOVED. Blocks in the columns
+ * which lost cells fall down to fill the gaps, and then any column left empty is dropped, sliding the columns to its right one
+ * column to the left. Only the columns from loCol onwards are looked at, and the columns right of hiCol are only rewritten if
+ * a column was dropped.
+ *
+ * Each column's new contents are computed in one go and compared with its old contents, so every cell whose colour differs
+ * after the move is recorded exactly once, and no other cell is. REMOVED cells count as having the removed group's colour
+ * before the move.
+ * @param m_loCol The leftmost column holding REMOVED cells.
+ * @param m_hiCol The rightmost column holding REMOVED cells.
+ * @param m_removedColour The colour of the removed group.
+ * @param m_changes Receives the changed cells. Its previous contents are discarded.
+ * @param m_column Scratch space for a column. Passed in so that its memory can be reused.
+ * @return The rightmost column which changed, or -1 if nothing changed.
+ */
+int BoardGrid::compact(int m_loCol, int m_hiCol, Cell m_removedColour, vector<CellChange>& m_changes, vector<Cell>& m_column)
+{
+    Cell* cells = c_cells.data(); // Cells of the board, for quicker access
+    int d; // Destination column
+    int s = m_loCol; // Source column, >= d
+    int r; // Row counter
+    int i; // Index of a cell
+    int n; // # of blocks in the new column
+    int lastChanged = -1; // Rightmost column which changed
+    Cell before; // Colour of a cell before the move
+    Cell after; // Colour of a cell after the move
+    CellChange change; // Change being recorded
+
+    m_changes.clear();
+    m_column.resize(m_rows);
+
+    for (d = m_loCol; d < m_cols; d++) // Fill destination columns from left to right
+    {
+        /* Find the next source column which still has blocks. The border row stops the inner loops at the top. */
+        for ( ; s < m_cols; s++)
+        {
+            for (i = index(s, m_rows-1); cells[i] == REMOVED; i -= m_stride) // Skip removed blocks, from the bottom up
+            {
+            }
+
+            if (cells[i] != EMPTY && cells[i] != BORDER) // Found a block that stays
+            {
+                break;
+            }
+        }
+
+        if (s == d && d > m_hiCol) // Nothing was removed here and nothing has been dropped, so the rest is unchanged
+        {
+            break;
+        }
+
+        if (s >= m_cols && cells[index(d, m_rows-1)] == EMPTY) // No blocks left to move in, and this column (and all the ones after it) is already empty
+        {
+            break;
+        }
+
+        /* Let the source column's blocks fall to the bottom */
+        n = 0;
+
+        if (s < m_cols)
+        {
+            for (i = index(s, m_rows-1); cells[i] != EMPTY && cells[i] != BORDER; i -= m_stride) // From the bottom up, until the first empty cell
+            {
+                if (cells[i] != REMOVED) // This block stays
+                {
+                    m_column[n++] = cells[i];
+                }
+            }
+        }
+
+        /* Write them into the destination column, from the bottom up, recording every cell which changes */
+        for (r = 0, i = index(d, m_rows-1); r < m_rows; r++, i -= m_stride)
+        {
+            after = (r < n) ? m_column[r] : EMPTY;
+
+            if (cells[i] == EMPTY && after == EMPTY) // Old and new column are both empty from here up
+            {
+                break;
+            }
+
+            before = (cells[i] == REMOVED) ? m_removedColour : cells[i];
+
+            if (before != after) // This cell changed
+            {
+                change.index = i;
+                change.before = before;
+                change.after = after;
+                m_changes.push_back(change);
+                lastChanged = d;
+            }
+
+            cells[i] = after; // Always written, to clear REMOVED markers
+        }
+
+        s++; // This source column has been used
+    }
+
+    return lastChanged;
+}
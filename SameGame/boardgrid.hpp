@@ -0,0 +1,96 @@
+#ifndef BOARDGRID_HPP
+#define BOARDGRID_HPP
+
+/* C++ Headers */
+#include <cstdint> // uint8_t
+#include <vector> // STL vectors
+
+using namespace std;
+
+typedef uint8_t Cell; // A single cell of the board. Holds an index to the array of colours.
+
+/**
+ * @brief The CellChange struct. Records the change of a single cell during a move.
+ */
+struct CellChange
+{
+    int index; // Index of the cell in the flat array
+    Cell before; // Colour before the move
+    Cell after; // Colour after the move
+};
+
+/**
+ * @brief The CellSpan struct. A read-only view of a board's cells, for observers which need to read the board without copying
+ * it. Uses the same layout and indices as BoardGrid. Only valid until the board is resized or destroyed.
+ */
+struct CellSpan
+{
+    const Cell* cells; // The flat array of cells, border included
+    int rows; // # of rows on the board
+    int cols; // # of columns on the board
+    int stride; // Distance between a cell and the one below it
+
+    Cell at(int m_x, int m_y) const { return cells[(m_y+1)*stride + m_x + 1]; } // Fetches the cell at (x, y)
+    Cell cell(int m_i) const { return cells[m_i]; } // Fetches the cell at the given index
+    int xOf(int m_i) const { return m_i % stride - 1; } // Fetches the x position of the cell at the given index
+    int yOf(int m_i) const { return m_i / stride - 1; } // Fetches the y position of the cell at the given index
+};
+
+/**
+ * @brief The BoardGrid class. Holds the cells of a board in one flat, row-major array of bytes. The board is surrounded by a
+ * one-cell border of sentinel cells, so that the neighbours of any cell on the board can be read without bounds checks.
+ * This class doesn't depend on Qt, so it can be used by code which doesn't have a GUI.
+ *
+ * Cells are addressed either by their (x, y) position on the board, or by their index in the flat array. Moving left or right
+ * adds -1/+1 to an index, and moving up or down adds -stride/+stride.
+ */
+class BoardGrid
+{
+    public:
+        /* Cell values */
+        static const Cell EMPTY = 0; // Value of an empty (black) cell
+        static const Cell BORDER = 0xFF; // Value of the sentinel cells around the board. Never used as a colour.
+        static const Cell REMOVED = 0xFE; // Marks cells removed by a move until compact() runs. Never used as a colour.
+
+        /* Constructors */
+        BoardGrid(); // Creates an empty 0x0 board
+        BoardGrid(int m_rows, int m_cols); // Creates an empty board with the given # of rows and columns
+
+        /* Size */
+        void resize(int m_rows, int m_cols); // Resizes the board and empties it
+        int getRows() const { return m_rows; } // Fetches the # of rows on the board
+        int getCols() const { return m_cols; } // Fetches the # of columns on the board
+        int getStride() const { return m_stride; } // Fetches the distance between two vertically adjacent cells in the flat array
+
+        /* Addressing */
+        bool inBounds(int m_x, int m_y) const { return 0 <= m_x && m_x < m_cols && 0 <= m_y && m_y < m_rows; } // True if (x, y) is on the board
+        int index(int m_x, int m_y) const { return (m_y+1)*m_stride + m_x + 1; } // Converts an (x, y) position on the board to an index
+        int xOf(int m_i) const { return m_i % m_stride - 1; } // Fetches the x position of the cell at the given index
+        int yOf(int m_i) const { return m_i / m_stride - 1; } // Fetches the y position of the cell at the given index
+
+        /* Cell access. No bounds checks: (x, y) must be on the board, or on its border. */
+        Cell at(int m_x, int m_y) const { return c_cells[index(m_x, m_y)]; } // Fetches the cell at (x, y)
+        void set(int m_x, int m_y, Cell m_val) { c_cells[index(m_x, m_y)] = m_val; } // Sets the cell at (x, y)
+        Cell cell(int m_i) const { return c_cells[m_i]; } // Fetches the cell at the given index
+        void setCell(int m_i, Cell m_val) { c_cells[m_i] = m_val; } // Sets the cell at the given index
+        const Cell* data() const { return c_cells.data(); } // Fetches the flat array of cells, border included
+        Cell* data() { return c_cells.data(); } // Fetches the flat array of cells, border included
+        CellSpan span() const { CellSpan sp = { c_cells.data(), m_rows, m_cols, m_stride }; return sp; } // Fetches a read-only view of the cells
+
+        /* Whole-board operations */
+        void clear(); // Empties every cell on the board
+        bool isEmpty() const; // Returns true if every cell on the board is empty
+        bool hasMoves() const; // Returns true if any cell has a neighbour of the same colour
+
+        /* Group operations */
+        int floodRemove(int m_start, vector<int>& m_work, vector<int>& m_removed, Cell m_fill = EMPTY); // Removes the group of same-coloured cells containing the given cell
+        int compact(int m_loCol, int m_hiCol, Cell m_removedColour, vector<CellChange>& m_changes, vector<Cell>& m_column); // Applies gravity to the columns holding REMOVED cells, then drops empty columns
+
+    private:
+        int m_rows; // Number of rows
+        int m_cols; // Number of columns
+        int m_stride; // Number of cells in a row of the flat array (columns plus the left and right border)
+        vector<Cell> c_cells; // The cells, row by row, including the border
+};
+
+#endif // BOARDGRID_HPP
@@ -0,0 +1,40 @@
+#include "boardt.hpp"
+
+/**
+ * @brief kernelsOf Fetches the kernels of one board size.
+ * @param m_kernels Receives the kernels.
+ * @return True.
+ */
+template<int Rows, int Cols>
+static bool kernelsOf(BoardKernels& m_kernels)
+{
+    m_kernels.floodRemove = &BoardT<Rows, Cols>::floodRemove;
+    m_kernels.compact = &BoardT<Rows, Cols>::compact;
+    return true;
+}
+
+/**
+ * @brief boardKernelsFor Fetches the fixed-size kernels for a board size. The standard sizes are the square boards which are
+ * played and benchmarked most: 5x5, the game's default, 10x10, 15x15, the competition size, and 20x20. Only these are
+ * instantiated, since each size is a copy of the kernels' code.
+ * @param m_rows The # of rows.
+ * @param m_cols The # of columns.
+ * @param m_kernels Receives the kernels, if the size is a standard one.
+ * @return False if there are no kernels for this size, in which case BoardGrid's operations should be used.
+ */
+bool boardKernelsFor(int m_rows, int m_cols, BoardKernels& m_kernels)
+{
+    if (m_rows != m_cols) // Every standard board is square
+    {
+        return false;
+    }
+
+    switch (m_rows)
+    {
+        case 5: return kernelsOf<5, 5>(m_kernels);
+        case 10: return kernelsOf<10, 10>(m_kernels);
+        case 15: return kernelsOf<15, 15>(m_kernels);
+        case 20: return kernelsOf<20, 20>(m_kernels);
+        default: return false;
+    }
+}
@@ -0,0 +1,200 @@
+#ifndef BOARDT_HPP
+#define BOARDT_HPP
+
+/* C++ Headers */
+#include <array> // Fixed-size scratch buffers
+#include <vector> // STL vectors
+
+/* My headers */
+#include "boardgrid.hpp" // Cell values, layout and change records
+
+using namespace std;
+
+/*
+ * Fixed-size board kernels. The move operations of BoardGrid, instantiated for the standard board sizes, which Game runs
+ * instead of BoardGrid's when the dimensions match. They work on a board's cells in place, in BoardGrid's layout, and give the
+ * same results as BoardGrid's, so which one runs only changes the speed.
+ */
+
+typedef int (*FloodKernel)(Cell* m_cells, int m_start, vector<int>& m_removed, Cell m_fill); // Removes a group, like BoardGrid::floodRemove()
+typedef int (*CompactKernel)(Cell* m_cells, int m_loCol, int m_hiCol, Cell m_removedColour, vector<CellChange>& m_changes); // Compacts a board, like BoardGrid::compact()
+
+/**
+ * @brief The BoardKernels struct. The fixed-size kernels for one board size.
+ */
+struct BoardKernels
+{
+    FloodKernel floodRemove; // Removes a group
+    CompactKernel compact; // Lets blocks fall and drops empty columns
+};
+
+bool boardKernelsFor(int m_rows, int m_cols, BoardKernels& m_kernels); // Fetches the kernels for a board size. Returns false if it isn't a standard size.
+
+/**
+ * @brief The BoardT class. The geometry of a board whose size is fixed at compile time, and BoardGrid's move operations
+ * written against it. The stride and neighbour offsets are compile-time constants, every loop down a column has a constant
+ * trip count which the compiler can unroll, and scratch space lives in std::arrays on the stack, so nothing is allocated.
+ */
+template<int Rows, int Cols>
+class BoardT
+{
+    public:
+        static constexpr int STRIDE = Cols + 2; // Distance between two vertically adjacent cells
+        static constexpr int CELLS = Rows * Cols; // # of cells on the board
+        static constexpr int UP = -STRIDE; // Offset to the cell above
+        static constexpr int DOWN = STRIDE; // Offset to the cell below
+
+        /* Geometry */
+        static constexpr int index(int m_x, int m_y) { return (m_y+1)*STRIDE + m_x + 1; } // Converts an (x, y) position to an index
+
+        /* Group operations */
+        static int floodRemove(Cell* m_cells, int m_start, vector<int>& m_removed, Cell m_fill); // Removes the group containing the given cell
+        static int compact(Cell* m_cells, int m_loCol, int m_hiCol, Cell m_removedColour, vector<CellChange>& m_changes); // Lets blocks fall, then drops empty columns
+};
+
+/* Definitions of the constants, for when they are bound to references */
+template<int Rows, int Cols> constexpr int BoardT<Rows, Cols>::STRIDE;
+template<int Rows, int Cols> constexpr int BoardT<Rows, Cols>::CELLS;
+template<int Rows, int Cols> constexpr int BoardT<Rows, Cols>::UP;
+template<int Rows, int Cols> constexpr int BoardT<Rows, Cols>::DOWN;
+
+/*** Group operations ***/
+
+/**
+ * @brief BoardT::floodRemove Removes the group of same-coloured cells which contains the given cell, with a depth-first fill on
+ * a fixed-size stack. Each cell is filled as it is pushed, so it is pushed at most once, and the border never matches, so no
+ * bounds checks are needed. Removes the same cells as BoardGrid::floodRemove(), but lists them in another order.
+ * @param m_cells The board's cells, in BoardGrid's layout.
+ * @param m_start The index of a cell in the group.
+ * @param m_removed Receives the indices of the removed cells. Its previous contents are discarded.
+ * @param m_fill The value to write into the removed cells. Must not be the group's colour.
+ * @return The number of cells removed. 0 if the starting cell is empty or part of the border.
+ */
+template<int Rows, int Cols>
+int BoardT<Rows, Cols>::floodRemove(Cell* m_cells, int m_start, vector<int>& m_removed, Cell m_fill)
+{
+    Cell colour = m_cells[m_start]; // Colour of the group
+    array<int, CELLS> stack; // Cells whose neighbours haven't been checked yet
+    int top = 0; // # of cells on the stack
+    int i; // Cell popped off the stack
+
+    m_removed.clear();
+
+    if (colour == BoardGrid::EMPTY || colour == BoardGrid::BORDER || colour == m_fill) // Nothing to remove
+    {
+        return 0;
+    }
+
+    m_cells[m_start] = m_fill;
+    stack[top++] = m_start;
+
+    while (top > 0) // Loop until the whole group is gone
+    {
+        i = stack[--top];
+        m_removed.push_back(i);
+
+        if (m_cells[i-1] == colour) { m_cells[i-1] = m_fill; stack[top++] = i-1; }
+        if (m_cells[i+1] == colour) { m_cells[i+1] = m_fill; stack[top++] = i+1; }
+        if (m_cells[i+UP] == colour) { m_cells[i+UP] = m_fill; stack[top++] = i+UP; }
+        if (m_cells[i+DOWN] == colour) { m_cells[i+DOWN] = m_fill; stack[top++] = i+DOWN; }
+    }
+
+    return m_removed.size();
+}
+
+/**
+ * @brief BoardT::compact Compacts the board after floodRemove() marked a group's cells as REMOVED, exactly as
+ * BoardGrid::compact() does: the same cells end up in the same places, and the same changes are recorded in the same order.
+ * @param m_cells The board's cells, in BoardGrid's layout.
+ * @param m_loCol The leftmost column holding REMOVED cells.
+ * @param m_hiCol The rightmost column holding REMOVED cells.
+ * @param m_removedColour The colour of the removed group.
+ * @param m_changes Receives the changed cells. Its previous contents are discarded.
+ * @return The rightmost column which changed, or -1 if nothing changed.
+ */
+template<int Rows, int Cols>
+int BoardT<Rows, Cols>::compact(Cell* m_cells, int m_loCol, int m_hiCol, Cell m_removedColour, vector<CellChange>& m_changes)
+{
+    array<Cell, Rows> column; // Blocks of the source column, from the bottom up
+    int d; // Destination column
+    int s = m_loCol; // Source column, >= d
+    int r; // Row counter
+    int i; // Index of a cell
+    int n; // # of blocks in the new column
+    int lastChanged = -1; // Rightmost column which changed
+    Cell before; // Colour of a cell before the move
+    Cell after; // Colour of a cell after the move
+    CellChange change; // Change being recorded
+
+    m_changes.clear();
+
+    for (d = m_loCol; d < Cols; d++) // Fill destination columns from left to right
+    {
+        /* Find the next source column which still has blocks. The border row stops the inner loops at the top. */
+        for ( ; s < Cols; s++)
+        {
+            for (i = index(s, Rows-1); m_cells[i] == BoardGrid::REMOVED; i += UP) // Skip removed blocks, from the bottom up
+            {
+            }
+
+            if (m_cells[i] != BoardGrid::EMPTY && m_cells[i] != BoardGrid::BORDER) // Found a block that stays
+            {
+                break;
+            }
+        }
+
+        if (s == d && d > m_hiCol) // Nothing was removed here and nothing has been dropped, so the rest is unchanged
+        {
+            break;
+        }
+
+        if (s >= Cols && m_cells[index(d, Rows-1)] == BoardGrid::EMPTY) // No blocks left to move in, and the rest is already empty
+        {
+            break;
+        }
+
+        /* Let the source column's blocks fall to the bottom */
+        n = 0;
+
+        if (s < Cols)
+        {
+            for (i = index(s, Rows-1); m_cells[i] != BoardGrid::EMPTY && m_cells[i] != BoardGrid::BORDER; i += UP) // Until the first empty cell
+            {
+                if (m_cells[i] != BoardGrid::REMOVED) // This block stays
+                {
+                    column[n++] = m_cells[i];
+                }
+            }
+        }
+
+        /* Write them into the destination column, from the bottom up, recording every cell which changes */
+        for (r = 0, i = index(d, Rows-1); r < Rows; r++, i += UP)
+        {
+            after = (r < n) ? column[r] : BoardGrid::EMPTY;
+
+            if (m_cells[i] == BoardGrid::EMPTY && after == BoardGrid::EMPTY) // Old and new column are both empty from here up
+            {
+                break;
+            }
+
+            before = (m_cells[i] == BoardGrid::REMOVED) ? m_removedColour : m_cells[i];
+
+            if (before != after) // This cell changed
+            {
+                change.index = i;
+                change.before = before;
+                change.after = after;
+                m_changes.push_back(change);
+                lastChanged = d;
+            }
+
+            m_cells[i] = after; // Always written, to clear REMOVED markers
+        }
+
+        s++; // This source column has been used
+    }
+
+    return lastChanged;
+}
+
+#endif // BOARDT_HPP
@@ -2,10 +2,14 @@
 
 /* Qt includes */
 #include <QPainter> // Painter for painting
+#include <QPaintEvent> // Damaged area to repaint
+#include <QResizeEvent> // Resize events
 
 /* STL includes */
 #include <vector> // vector
 #include <exception> // exception
+#include <algorithm> // fill()
+#include <cstring> // memcpy()
 
 /* C includes */
 #include <cmath> // floor
@@ -13,6 +17,9 @@
 /* Qt includes */
 #include <QDebug> // qDebug()
 
+/* Defines */
+#define GRID_LINE 2 // Width of the black line drawn on the right and bottom of each square
+
 /*** Public methods ***/
 
 /**
@@ -21,7 +28,12 @@
  */
 BoardView::BoardView(QWidget *parent) : QWidget(parent), // Initialise parent
     canDraw(false), // Draw black initially
-    c_grid(5, vector<QColor>(5, QColor(0, 0, 0))) // Initialize grid to 5x5 array of black
+    c_cells(5*5, BoardGrid::EMPTY), // Initialize grid to 5x5 array of black
+    m_rows(5),
+    m_cols(5),
+    c_blank(Qt::black), // Empty squares, before a palette is set
+    c_invalid(Qt::white), // Same as Game::getColourFromIndex()
+    m_cacheValid(false) // Picture is built on the first paint
 {
     /* Widget setup */
     update(); // Initial paint
@@ -52,8 +64,8 @@ pair<int, int> BoardView::toModelCoords(int m_clickX, int m_clickY)
     int c_modelX; // Model x coord
     int c_modelY; // Model y coord
 
-    cellWidth = screenWidth / c_grid[0].size(); // Width of a cell = total width / # of columns
-    cellHeight = screenHeight / c_grid.size(); // Cell height = total height / # of rows
+    cellWidth = screenWidth / m_cols; // Width of a cell = total width / # of columns
+    cellHeight = screenHeight / m_rows; // Cell height = total height / # of rows
 
     /* Part 2: convert click point to model point */
     c_modelX = floor(m_clickX / cellWidth); // Dividing the distance from 0 to x (x) by the width of a cell gives you the # of “cell width units” away from the left - the x co-ord of the cell, in model (cell) units
@@ -67,37 +79,37 @@ pair<int, int> BoardView::toModelCoords(int m_clickX, int m_clickY)
  */
 void BoardView::reset()
 {
-    unsigned r; // Row counter
-    unsigned c; // Column counter
-
-    /* Set all squares to black */
-    for (r = 0; r < c_grid.size(); r++) // Loop through rows
-    {
-        for (c = 0; c < c_grid[r].size(); c++) // Loop through columns
-        {
-            c_grid[r][c] = QColor(0, 0, 0); // Set the square to black
-        }
-    }
+    fill(c_cells.begin(), c_cells.end(), BoardGrid::EMPTY); // Set all squares to black
 
+    c_hint.clear(); // The hinted squares may not exist any more
+    m_cacheValid = false; // Every square changed, so redraw the whole picture
     update(); // Repaint
 }
 
 /**
- * @brief BoardView::setSquareColour Sets the colour of the square at (x, y) to col and redraws the board.
+ * @brief BoardView::setSquareColour Sets the colour of the square at (x, y) to the given palette index. Only that square is
+ * redrawn into the cached picture, and only its area of the widget is repainted.
  * @param m_x The x coord of the square whose colour we will change.
  * @param m_y The y coord of the square whose colour we will change.
- * @param m_col The new colour of the square.
+ * @param m_colour The palette index of the square's new colour.
  * @return -1 if the coords are out of bounds, 0 if the change was successfully completed.
  */
-int BoardView::setSquareColour(unsigned m_x, unsigned m_y, QColor m_col)
+int BoardView::setSquareColour(unsigned m_x, unsigned m_y, Cell m_colour)
 {
     /* Bounds check */
-    if (m_y < c_grid.size() // y is within bounds
+    if (m_y < unsigned(m_rows) // y is within bounds
             && // Also need to check x
-        m_x < c_grid[0].size()) // x is within bounds
+        m_x < unsigned(m_cols)) // x is within bounds
     {
-        c_grid[m_y][m_x] = m_col; // Store the new colour
-        update(); // Redraw the board
+        c_cells[m_y*m_cols + m_x] = m_colour; // Store the new colour
+
+        if (m_cacheValid) // Patch the cached picture. If it isn't valid, the next paint rebuilds it anyway.
+        {
+            QPainter painter(&c_cache); // Paint into the picture
+            paintCell(painter, m_x, m_y);
+        }
+
+        update(cellRect(m_x, m_y)); // Repaint this square only
         return 0; // Indicate successful completion
     }
 
@@ -108,57 +120,175 @@ int BoardView::setSquareColour(unsigned m_x, unsigned m_y, QColor m_col)
 }
 
 /**
- * @brief BoardView::setBoardSize Sets the size of the new grid to
+ * @brief BoardView::setBoardSize Sets the size of the grid, and sets every square to black.
  * @param m_newWidth The new width of the board.
  * @param m_newHeight The board's new height.
  */
 void BoardView::setBoardSize(unsigned m_newWidth, unsigned m_newHeight)
 {
-    unsigned r; // Row counter
-
     if (m_newWidth > 0 && m_newHeight > 0) // Bounds check
     {
-        c_grid.resize(m_newHeight, vector<QColor>(m_newWidth, QColor(0, 0, 0))); // Resize row vector to m_newHeight rows, filling in empty spaces with a vector of m_newWidth cols of black
+        m_rows = m_newHeight;
+        m_cols = m_newWidth;
+        c_cells.assign(m_rows*m_cols, BoardGrid::EMPTY); // One byte per square, all black
+
+        c_hint.clear(); // The hinted squares may not exist any more
+        m_cacheValid = false; // Squares have a new size
+        update(); // Redraw the board with the new size
+    }
+}
+
+/*** Batch updates ***/
+
+/**
+ * @brief BoardView::setPalette Sets the colours which the squares' colour indices refer to. A brush is built for each colour
+ * here, once, so that drawing a square doesn't create any colour objects.
+ * @param m_palette The colours. Index 0 should be black, for empty squares.
+ */
+void BoardView::setPalette(const vector<QColor>& m_palette)
+{
+    unsigned i; // Colour counter
+
+    c_palette.clear(); // Our own brushes, the model may go away before we do
+
+    for (i = 0; i < m_palette.size(); i++) // Loop through the colours
+    {
+        c_palette.push_back(QBrush(m_palette[i]));
+    }
+
+    m_cacheValid = false; // Squares may have new colours
+    update();
+}
+
+/**
+ * @brief BoardView::applyUpdates Applies a list of square changes. Every change is bounds-checked and drawn into the cached
+ * picture, and then a single repaint is requested for the rectangle which covers all of them.
+ * @param m_updates The changes to apply.
+ * @param m_n The # of changes.
+ * @return The # of changes which were skipped because their coords were out of bounds.
+ */
+int BoardView::applyUpdates(const CellUpdate* m_updates, int m_n)
+{
+    unsigned rows = m_rows; // # of rows in the grid
+    unsigned cols = m_cols; // # of columns in the grid
+    int nSkipped = 0; // # of out-of-bounds changes
+    QRect damaged; // Area of the widget covered by the changed squares
+    QPainter painter; // Painter for the cached picture, only opened if it is valid
+    int i; // Change counter
+
+    if (m_cacheValid) // Patch the cached picture. If it isn't valid, the next paint rebuilds it anyway.
+    {
+        painter.begin(&c_cache);
+    }
 
-        /* Ensure each column vector is of the right size */
-        for (r = 0; r < c_grid.size(); r++) // Loop through the rows
+    for (i = 0; i < m_n; i++) // Loop through the changes
+    {
+        if (unsigned(m_updates[i].x) >= cols || unsigned(m_updates[i].y) >= rows) // Out of bounds (negative coords wrap around)
         {
-            c_grid[r].resize(m_newWidth, QColor(0, 0, 0)); // Resize this column vector to the new width, adding black elements if necessary
+            nSkipped++;
+            continue;
         }
 
-        update(); // Redraw the board with the new size
+        c_cells[m_updates[i].y*m_cols + m_updates[i].x] = m_updates[i].colour; // Store the new colour
+
+        if (m_cacheValid)
+        {
+            paintCell(painter, m_updates[i].x, m_updates[i].y);
+        }
+
+        damaged |= cellRect(m_updates[i].x, m_updates[i].y); // Grow the area to repaint
+    }
+
+    if (!damaged.isEmpty()) // Something changed
+    {
+        update(damaged); // One repaint for the whole batch
+    }
+
+    return nSkipped;
+}
+
+/**
+ * @brief BoardView::uploadFrame Replaces every square with the model's cells, resizing the grid to the board's size first if
+ * needed. Both hold colour indices, so each row is a single copy. The cached picture is rebuilt once, on the next paint.
+ * @param m_cells A view of the model's cells.
+ */
+void BoardView::uploadFrame(const CellSpan& m_cells)
+{
+    int r; // Row counter
+
+    if (m_cells.rows <= 0 || m_cells.cols <= 0) // Nothing to show
+    {
+        return;
+    }
+
+    m_rows = m_cells.rows; // Match the board's size
+    m_cols = m_cells.cols;
+    c_cells.resize(m_rows*m_cols);
+
+    for (r = 0; r < m_rows; r++) // Loop through rows of board
+    {
+        memcpy(&c_cells[r*m_cols], m_cells.cells + (r+1)*m_cells.stride + 1, m_cols); // Copy the row, skipping the border
+    }
+
+    c_hint.clear(); // The hinted squares may not exist any more
+    m_cacheValid = false; // Every square may have changed
+    update(); // One repaint for the whole frame
+}
+
+/*** Hints ***/
+
+/**
+ * @brief BoardView::setHint Outlines the given squares, to show the player a good move. The outline is drawn on top of the
+ * board, so the squares' colours are left alone.
+ * @param m_squares The (x, y) coords of the squares to outline.
+ */
+void BoardView::setHint(const vector<pair<int, int>>& m_squares)
+{
+    clearHint(); // Only one hint at a time
+    c_hint = m_squares;
+    update(hintRect()); // Draw the new outline
+}
+
+/**
+ * @brief BoardView::clearHint Removes the hint's outline, if there is one.
+ */
+void BoardView::clearHint()
+{
+    if (!c_hint.empty()) // Something to remove
+    {
+        update(hintRect()); // Repaint the squares under the old outline
+        c_hint.clear();
     }
 }
 
 /*** Protected methods ***/
 
 /**
- * @brief BoardView::paintEvent Paints the board on the widget when necessary.
+ * @brief BoardView::paintEvent Paints the board on the widget when necessary, by copying the damaged area from the cached
+ * picture of the board. The picture is rebuilt first if it is out of date.
  * @param event The paint event.
  */
 void BoardView::paintEvent(QPaintEvent * m_event)
 {
     QPainter painter(this); // Painter for drawing board
-    QColor black(0, 0, 0); // Black colour
-    int r; // Row counter
-    int c; // Column counter
-    int nRows = c_grid.size(); // # of rows to draw
-    int nCols = c_grid[0].size(); // # of cols to draw
-    int cellWidth = width() / nRows; // Width of a cell is total width / # of cells
-    int  cellHeight = height() / nCols; // Cell height = total height / # of rows
 
     try
     {
-        //qDebug() << "Cell width = " << cellWidth << endl << "Cell Height = " << cellHeight << endl;
+        if (!m_cacheValid) // The picture is out of date
+        {
+            rebuildCache(); // Draw every square once
+        }
 
-        painter.setPen(QPen(QBrush(black), 5)); // Draw the outline in black
+        painter.drawImage(m_event->rect(), c_cache, m_event->rect()); // A single blit of the damaged area
 
-        for (r = 0; r < nRows; r++) // Loop through rows of board
+        if (!c_hint.empty()) // Outline the hinted squares
         {
-            for (c = 0; c < nCols; c++) // Loop through columns of board
+            painter.setPen(QPen(Qt::white, GRID_LINE));
+            painter.setBrush(Qt::NoBrush);
+
+            for (vector<pair<int, int>>::const_iterator it = c_hint.begin(); it != c_hint.end(); it++) // Loop through the hinted squares
             {
-                painter.drawRect(c*cellWidth, r*cellHeight, cellWidth, cellHeight); // Draw the outline at this position in black
-                painter.fillRect(c*cellWidth, r*cellHeight, cellWidth, cellHeight, c_grid[r][c]); // Draw the coloured square at this position using its colour
+                painter.drawRect(cellRect(it->first, it->second).adjusted(1, 1, -GRID_LINE-1, -GRID_LINE-1)); // Inside the square's colour
             }
         }
     }
@@ -168,3 +298,109 @@ void BoardView::paintEvent(QPaintEvent * m_event)
         qDebug() << "BoardView caught standard exception, with message: " << e.what() << endl; // Print a message
     }
 }
+
+/**
+ * @brief BoardView::resizeEvent Handles a resize of the widget by throwing away the cached picture, which is rebuilt at the new
+ * size on the next paint.
+ * @param event The resize event.
+ */
+void BoardView::resizeEvent(QResizeEvent * m_event)
+{
+    QWidget::resizeEvent(m_event); // Let the parent handle it too
+    m_cacheValid = false; // Squares have a new size
+}
+
+/*** Private methods ***/
+
+/**
+ * @brief BoardView::cellRect Fetches the area of the widget covered by a square.
+ * @param m_x The x coord of the square.
+ * @param m_y The y coord of the square.
+ * @return The square's area, in widget coords.
+ */
+QRect BoardView::cellRect(int m_x, int m_y) const
+{
+    int cellWidth = width() / m_cols; // Width of a cell is total width / # of columns
+    int cellHeight = height() / m_rows; // Cell height = total height / # of rows
+
+    return QRect(m_x*cellWidth, m_y*cellHeight, cellWidth, cellHeight);
+}
+
+/**
+ * @brief BoardView::hintRect Fetches the area of the widget covered by the hint.
+ * @return The smallest rectangle containing every hinted square, or an empty rectangle if there is no hint.
+ */
+QRect BoardView::hintRect() const
+{
+    QRect area; // Area covered so far
+
+    for (vector<pair<int, int>>::const_iterator it = c_hint.begin(); it != c_hint.end(); it++) // Loop through the hinted squares
+    {
+        area |= cellRect(it->first, it->second);
+    }
+
+    return area;
+}
+
+/**
+ * @brief BoardView::paintCell Draws a square into the cached picture: its colour, with a black line along its right and bottom
+ * edges. Nothing outside the square's area is touched, so a square can be redrawn on its own.
+ * @param m_painter A painter which is painting on the cached picture.
+ * @param m_x The x coord of the square.
+ * @param m_y The y coord of the square.
+ */
+void BoardView::paintCell(QPainter& m_painter, int m_x, int m_y)
+{
+    QRect area = cellRect(m_x, m_y); // Area covered by the square
+
+    m_painter.fillRect(area, Qt::black); // Grid line
+    m_painter.fillRect(area.adjusted(0, 0, -GRID_LINE, -GRID_LINE), paletteBrush(c_cells[m_y*m_cols + m_x])); // The square's colour
+}
+
+/**
+ * @brief BoardView::rebuildCache Creates a new cached picture at the widget's size, and draws every square into it.
+ */
+void BoardView::rebuildCache()
+{
+    int r; // Row counter
+    int c; // Column counter
+
+    c_cache = QImage(size(), QImage::Format_RGB32); // Picture at the widget's size
+    c_cache.fill(Qt::black); // Any space left over after the squares stays black
+
+    QPainter painter(&c_cache); // Paint into the picture
+
+    for (r = 0; r < m_rows; r++) // Loop through rows of board
+    {
+        for (c = 0; c < m_cols; c++) // Loop through columns of board
+        {
+            paintCell(painter, c, r);
+        }
+    }
+
+    m_cacheValid = true;
+}
+
+/**
+ * @brief BoardView::paletteBrush Fetches the brush for the given palette index.
+ * @param m_index The index.
+ * @return The brush. Black if no palette has been set yet and the square is empty, white if the index is otherwise outside of
+ * the palette.
+ */
+const QBrush& BoardView::paletteBrush(Cell m_index) const
+{
+    if (size_t(m_index) < c_palette.size()) // Index is in range
+    {
+        return c_palette[m_index];
+    }
+
+    else if (m_index == BoardGrid::EMPTY) // No palette yet
+    {
+        return c_blank;
+    }
+
+    else
+    {
+        return c_invalid;
+    }
+}
@@ -3,6 +3,10 @@
 
 /* Qt includes */
 #include <QWidget>
+#include <QImage> // Cached picture of the board
+#include <QRect> // Screen area of a cell
+#include <QPainter> // Painter passed to the cell helper
+#include <QBrush> // Palette entries
 
 /* STL includes */
 #include <vector> // vector
@@ -14,6 +18,17 @@
 /* Namespaces */
 using namespace std; // Use the STL namespace to save typing
 
+/**
+ * @brief The CellUpdate struct. A change to one square of the view: its position, and its new colour as an index into the
+ * view's palette.
+ */
+struct CellUpdate
+{
+    int x; // x coord of the square
+    int y; // y coord of the square
+    Cell colour; // Index of the square's new colour in the palette
+};
+
 class BoardView : public QWidget
 {
     Q_OBJECT
@@ -23,12 +38,22 @@ class BoardView : public QWidget
         ~BoardView(); // Destructor
         void reset(); // Resets the view to display only black rectangles
         pair<int, int> toModelCoords(int m_clickX, int m_clickY); // Converts a click position to a model position
-        int setSquareColour(unsigned m_x, unsigned m_y, QColor m_col); // Sets the colour of a square at the given (x, y) pos to the given colour and redraws the board
+        int setSquareColour(unsigned m_x, unsigned m_y, Cell m_colour); // Sets the colour of a square at the given (x, y) pos to the given palette index and redraws it
         void setBoardSize(unsigned m_newWidth, unsigned m_newHeight); // Resizes grid to new width and height
 
+        /* Batch updates */
+        void setPalette(const vector<QColor>& m_palette); // Sets the colours which the squares' colour indices refer to
+        int applyUpdates(const CellUpdate* m_updates, int m_n); // Applies a list of square changes with a single repaint
+        void uploadFrame(const CellSpan& m_cells); // Replaces every square with the model's cells with a single repaint
+
+        /* Hints */
+        void setHint(const vector<pair<int, int>>& m_squares); // Outlines the given squares, replacing any previous hint
+        void clearHint(); // Removes the hint's outline
+
     protected:
         /* Event handlers */
-        void paintEvent(QPaintEvent *event) Q_DECL_OVERRIDE; // Handles painting by redrawing the board
+        void paintEvent(QPaintEvent *event) Q_DECL_OVERRIDE; // Handles painting by copying the damaged area from the cached picture of the board
+        void resizeEvent(QResizeEvent *event) Q_DECL_OVERRIDE; // Throws away the cached picture, which no longer fits the widget
 
         /* Event signals */
     signals:
@@ -37,8 +62,24 @@ class BoardView : public QWidget
     public slots:
 
     private: // Private stuff
+        /* Helpers */
+        QRect cellRect(int m_x, int m_y) const; // Fetches the area of the widget covered by the square at (x, y)
+        QRect hintRect() const; // Fetches the area of the widget covered by the hint
+        void paintCell(QPainter& m_painter, int m_x, int m_y); // Draws the square at (x, y) into the cached picture
+        void rebuildCache(); // Redraws every square into a new cached picture
+        const QBrush& paletteBrush(Cell m_index) const; // Fetches the brush for the given palette index
+
+        /* Data */
         bool canDraw; // Used to tell paintEvent whether or not it is allowed to draw anything but black
-        vector<vector<QColor>> c_grid; // 2D vector holding colours of each square to draw
+        vector<Cell> c_cells; // Palette index of each square to draw, one byte per square, row by row
+        int m_rows; // # of rows of squares
+        int m_cols; // # of columns of squares
+        vector<QBrush> c_palette; // Brush for each colour index, built once per game
+        QBrush c_blank; // Brush for empty squares when there is no palette
+        QBrush c_invalid; // Brush for colour indices outside of the palette
+        vector<pair<int, int>> c_hint; // (x, y) coords of the squares to outline. Drawn over the cached picture, not into it.
+        QImage c_cache; // Picture of the whole board, at the widget's size. Only changed squares are redrawn into it.
+        bool m_cacheValid; // False if c_cache must be rebuilt before the next paint
 };
 
 #endif // BOARDVIEW_HPP
@@ -0,0 +1,170 @@
+#include "changeset.hpp"
+
+/* STL Headers */
+#include <algorithm> // fill(), min(), max()
+
+using namespace std; // To save some typing
+
+/**
+ * @brief lowestBit Finds the position of the lowest set bit of a word.
+ * @param m_word The word. Must not be 0.
+ * @return The position of the lowest set bit, in [0, 63].
+ */
+static int lowestBit(uint64_t m_word)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(m_word); // Single instruction on most CPUs
+#else
+    int n = 0; // Bit position
+
+    while ((m_word & 1) == 0) // Shift until the lowest bit is set
+    {
+        m_word >>= 1;
+        n++;
+    }
+
+    return n;
+#endif
+}
+
+/*** Constructor ***/
+
+/**
+ * @brief ChangeSet::ChangeSet Constructor. Creates an empty set. Call reset() before marking cells.
+ */
+ChangeSet::ChangeSet() :
+    m_rows(0),
+    m_cols(0),
+    m_stride(0),
+    m_count(0)
+{
+    clear(); // Set up an empty range and rectangle
+}
+
+/*** Updating ***/
+
+/**
+ * @brief ChangeSet::reset Sizes the set for a board and empties it.
+ * @param m_board The board whose cells will be tracked.
+ */
+void ChangeSet::reset(const BoardGrid& m_board)
+{
+    m_rows = m_board.getRows();
+    m_cols = m_board.getCols();
+    m_stride = m_board.getStride();
+    c_bits.assign(((m_rows+2) * m_stride + 63) / 64, 0); // One bit per cell, border included, rounded up to whole words
+    m_count = 0;
+    clear();
+}
+
+/**
+ * @brief ChangeSet::mark Adds a cell to the set. Does nothing if it is already in it.
+ * @param m_i The board index of the cell.
+ */
+void ChangeSet::mark(int m_i)
+{
+    int word = m_i / 64; // Word holding this cell's bit
+    uint64_t bit = uint64_t(1) << (m_i % 64); // This cell's bit
+    int x = m_i % m_stride - 1; // Board coords of the cell
+    int y = m_i / m_stride - 1;
+
+    if ((c_bits[word] & bit) == 0) // Not marked yet
+    {
+        c_bits[word] |= bit;
+        m_count++;
+        m_loWord = min(m_loWord, word); // Widen the range of words to clear
+        m_hiWord = max(m_hiWord, word);
+        m_left = min(m_left, x); // Widen the bounding rectangle
+        m_top = min(m_top, y);
+        m_right = max(m_right, x);
+        m_bottom = max(m_bottom, y);
+    }
+}
+
+/**
+ * @brief ChangeSet::markAll Adds every cell on the board (but not the border) to the set.
+ */
+void ChangeSet::markAll()
+{
+    int x; // Column counter
+    int y; // Row counter
+
+    for (y = 0; y < m_rows; y++)
+    {
+        for (x = 0; x < m_cols; x++)
+        {
+            mark((y+1)*m_stride + x + 1);
+        }
+    }
+}
+
+/**
+ * @brief ChangeSet::clear Empties the set. Only the words which may hold set bits are cleared.
+ */
+void ChangeSet::clear()
+{
+    if (m_count > 0) // Something to clear
+    {
+        fill(c_bits.begin() + m_loWord, c_bits.begin() + m_hiWord + 1, 0);
+    }
+
+    m_count = 0;
+    m_loWord = c_bits.size(); // Empty range of words
+    m_hiWord = -1;
+    m_left = m_cols; // Empty rectangle
+    m_top = m_rows;
+    m_right = -1;
+    m_bottom = -1;
+}
+
+/*** Queries ***/
+
+/**
+ * @brief ChangeSet::first Fetches the first changed cell.
+ * @return The board index of the first changed cell, or -1 if the set is empty.
+ */
+int ChangeSet::first() const
+{
+    return next(m_loWord*64 - 1); // Start just before the first word which may have bits set
+}
+
+/**
+ * @brief ChangeSet::next Fetches the next changed cell after the given one. Whole words of unchanged cells are skipped at once.
+ * @param m_i The board index of a cell, or -1 to start from the beginning.
+ * @return The board index of the next changed cell, or -1 if there are none.
+ */
+int ChangeSet::next(int m_i) const
+{
+    int word; // Word being checked
+    uint64_t bits; // Bits of that word which are still to be visited
+
+    m_i++; // Start after the given cell
+
+    if (m_i < 0) // Started before the first cell
+    {
+        m_i = 0;
+    }
+
+    word = m_i / 64;
+
+    if (word > m_hiWord) // Past the last word with bits set
+    {
+        return -1;
+    }
+
+    bits = c_bits[word] & (~uint64_t(0) << (m_i % 64)); // Drop the bits before m_i
+
+    while (bits == 0) // Skip empty words
+    {
+        word++;
+
+        if (word > m_hiWord) // No more changed cells
+        {
+            return -1;
+        }
+
+        bits = c_bits[word];
+    }
+
+    return word*64 + lowestBit(bits);
+}
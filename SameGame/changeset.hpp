@@ -0,0 +1,56 @@
+#ifndef CHANGESET_HPP
+#define CHANGESET_HPP
+
+/* C++ Headers */
+#include <cstdint> // uint64_t
+#include <vector> // STL vectors
+
+/* My headers */
+#include "boardgrid.hpp" // Board whose cells are tracked
+
+using namespace std;
+
+/**
+ * @brief The ChangeSet class. The set of cells changed on a board since the observer last synced, stored as one bit per cell
+ * (addressed by the board's flat indices), plus the bounding rectangle of the changed cells. Marking a cell twice has no
+ * extra cost, so observers see each changed cell once, however many times it changed.
+ */
+class ChangeSet
+{
+    public:
+        /* Constructor */
+        ChangeSet(); // Creates an empty set for a 0x0 board
+
+        /* Updating */
+        void reset(const BoardGrid& m_board); // Sizes the set for the given board and empties it
+        void mark(int m_i); // Adds the cell at the given index to the set
+        void markAll(); // Adds every cell on the board to the set
+        void clear(); // Empties the set
+
+        /* Queries */
+        bool isEmpty() const { return m_count == 0; } // True if no cells have changed
+        int getCount() const { return m_count; } // Fetches the # of changed cells
+        int first() const; // Fetches the index of the first changed cell, or -1 if there are none
+        int next(int m_i) const; // Fetches the index of the next changed cell after the given one, or -1 if there are none
+
+        /* Bounding rectangle of the changed cells, in board coords. Only valid if the set isn't empty. */
+        int getLeft() const { return m_left; } // Leftmost changed column
+        int getTop() const { return m_top; } // Topmost changed row
+        int getRight() const { return m_right; } // Rightmost changed column
+        int getBottom() const { return m_bottom; } // Bottommost changed row
+
+    private:
+        vector<uint64_t> c_bits; // One bit per cell of the flat board
+        int m_rows; // # of rows on the board
+        int m_cols; // # of columns on the board
+        int m_stride; // Stride of the board's flat array
+        int m_count; // # of bits set
+        int m_loWord; // Lowest word which may have bits set
+        int m_hiWord; // Highest word which may have bits set
+        int m_left; // Bounding rectangle of the changed cells
+        int m_top;
+        int m_right;
+        int m_bottom;
+};
+
+#endif // CHANGESET_HPP
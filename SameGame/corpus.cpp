@@ -0,0 +1,270 @@
+#include "corpus.hpp"
+
+/* My headers */
+#include "snapshot.hpp" // Cell packing
+#include "zobrist.hpp" // Board hashes
+
+/* STL Headers */
+#include <cstring> // memcpy(), memcmp()
+
+using namespace std; // To save some typing
+
+/* Defines */
+#define CORPUS_ALIGN 8 // Alignment of every entry and of the index
+#define CORPUS_MAX_SIDE 16384 // Largest # of rows or columns an entry may claim
+
+static_assert(sizeof(CorpusHeader) == 8, "CorpusHeader must have no padding");
+static_assert(sizeof(CorpusEntryHeader) == 40, "CorpusEntryHeader must have no padding");
+static_assert(sizeof(CorpusTrailer) == 24, "CorpusTrailer must have no padding");
+
+/*** Writer ***/
+
+/**
+ * @brief CorpusWriter::CorpusWriter Constructor. Creates a writer with no file open.
+ */
+CorpusWriter::CorpusWriter() :
+    c_file(0),
+    m_offset(0),
+    m_ok(false)
+{
+}
+
+/**
+ * @brief CorpusWriter::~CorpusWriter Destructor. Finishes the corpus, if one is open.
+ */
+CorpusWriter::~CorpusWriter()
+{
+    close();
+}
+
+/**
+ * @brief CorpusWriter::open Creates a corpus file and writes its header.
+ * @param m_path The file's path.
+ * @return True if the file was created.
+ */
+bool CorpusWriter::open(const string& m_path)
+{
+    CorpusHeader header; // File header
+
+    close();
+    c_file = fopen(m_path.c_str(), "wb");
+    m_offset = 0;
+    m_ok = (c_file != 0);
+    c_offsets.clear();
+
+    memcpy(header.magic, CORPUS_MAGIC, sizeof(header.magic));
+    header.version = CORPUS_VERSION;
+    return m_ok && write(&header, sizeof(header));
+}
+
+/**
+ * @brief CorpusWriter::add Appends a board to the corpus.
+ * @param m_board The board. Every cell must be empty or a colour index up to nColours.
+ * @param m_nColours The # of colours, excluding black. At most 15.
+ * @param m_seed The seed the board was generated from.
+ * @param m_points Score already made on the board.
+ * @param m_best Best known final score from the board, or -1 if unknown.
+ * @return True if the board was written, false if no file is open, the board doesn't fit the format, or the write failed.
+ */
+bool CorpusWriter::add(const BoardGrid& m_board, int m_nColours, uint64_t m_seed, int m_points, int m_best)
+{
+    CorpusEntryHeader header; // Entry's metadata
+    static const uint8_t zeros[CORPUS_ALIGN] = { 0 }; // Padding
+    size_t cellBytes = snapshotCellBytes(m_board.getRows(), m_board.getCols(), 4); // Size of the packed cells
+
+    if (!m_ok || m_nColours < 1 || m_nColours > 15 || m_board.getRows() > CORPUS_MAX_SIDE || m_board.getCols() > CORPUS_MAX_SIDE) // Can't store it
+    {
+        return false;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.rows = m_board.getRows();
+    header.cols = m_board.getCols();
+    header.nColours = m_nColours;
+    header.points = m_points;
+    header.best = m_best;
+    header.seed = m_seed;
+    header.hash = zobristHash(m_board);
+
+    c_buffer.resize(cellBytes);
+    snapshotPackCells(m_board, 4, c_buffer.data());
+
+    c_offsets.push_back(m_offset);
+    return write(&header, sizeof(header)) && write(c_buffer.data(), cellBytes) && write(zeros, (CORPUS_ALIGN - m_offset % CORPUS_ALIGN) % CORPUS_ALIGN);
+}
+
+/**
+ * @brief CorpusWriter::close Writes the index and the trailer, and closes the file. Does nothing if no file is open.
+ * @return True if every write to the file succeeded.
+ */
+bool CorpusWriter::close()
+{
+    CorpusTrailer trailer; // End of the file
+    bool ok; // Result
+
+    if (c_file == 0) // Nothing open
+    {
+        return false;
+    }
+
+    trailer.indexOffset = m_offset;
+    trailer.count = c_offsets.size();
+    memcpy(trailer.magic, CORPUS_INDEX_MAGIC, sizeof(trailer.magic));
+    trailer.version = CORPUS_VERSION;
+
+    write(c_offsets.data(), c_offsets.size() * sizeof(uint64_t));
+    write(&trailer, sizeof(trailer));
+    ok = (fclose(c_file) == 0) && m_ok;
+    c_file = 0;
+    m_ok = false;
+    return ok;
+}
+
+/**
+ * @brief CorpusWriter::write Writes bytes to the file.
+ * @param m_data The bytes.
+ * @param m_size The # of bytes.
+ * @return False if this or any earlier write failed.
+ */
+bool CorpusWriter::write(const void* m_data, size_t m_size)
+{
+    if (m_ok && m_size > 0 && fwrite(m_data, 1, m_size, c_file) != m_size) // Disk full, or similar
+    {
+        m_ok = false;
+    }
+
+    m_offset += m_size;
+    return m_ok;
+}
+
+/*** Reader ***/
+
+/**
+ * @brief Corpus::Corpus Constructor. Creates a corpus with no file open.
+ */
+Corpus::Corpus() :
+    m_index(0),
+    m_count(0),
+    m_indexOffset(0)
+{
+}
+
+/**
+ * @brief Corpus::open Maps a corpus file and checks its header, trailer and index. Entries are only checked when read.
+ * @param m_path The file's path.
+ * @return 0 on success, or a description of what is wrong with the file.
+ */
+const char* Corpus::open(const string& m_path)
+{
+    CorpusHeader header; // File header
+    CorpusTrailer trailer; // File trailer
+    size_t size; // File size
+
+    close();
+
+    if (!c_file.open(m_path)) // Can't map it
+    {
+        return "couldn't open the corpus";
+    }
+
+    size = c_file.size();
+
+    if (size < sizeof(header) + sizeof(trailer)) // Too small for the header and trailer
+    {
+        close();
+        return "file is too small to be a corpus";
+    }
+
+    memcpy(&header, c_file.data(), sizeof(header));
+    memcpy(&trailer, c_file.data() + size - sizeof(trailer), sizeof(trailer));
+
+    if (memcmp(header.magic, CORPUS_MAGIC, sizeof(header.magic)) != 0 || memcmp(trailer.magic, CORPUS_INDEX_MAGIC, sizeof(trailer.magic)) != 0) // Not a corpus
+    {
+        close();
+        return "not a corpus";
+    }
+
+    if (header.version != CORPUS_VERSION || trailer.version != CORPUS_VERSION) // From another version
+    {
+        close();
+        return "corpus was written by an unsupported version";
+    }
+
+    if (trailer.indexOffset % CORPUS_ALIGN != 0 || trailer.indexOffset < sizeof(header) || trailer.indexOffset > size - sizeof(trailer) // Before any subtraction, so none wraps
+            || trailer.count != (size - sizeof(trailer) - trailer.indexOffset) / sizeof(uint64_t)
+            || (size - sizeof(trailer) - trailer.indexOffset) % sizeof(uint64_t) != 0) // Index doesn't fit the file
+    {
+        close();
+        return "corpus index is corrupt";
+    }
+
+    m_index = reinterpret_cast<const uint64_t*>(c_file.data() + trailer.indexOffset); // Aligned, since the mapping is
+    m_count = trailer.count;
+    m_indexOffset = trailer.indexOffset;
+    return 0;
+}
+
+/**
+ * @brief Corpus::close Unmaps the file. Entries fetched from it become invalid.
+ */
+void Corpus::close()
+{
+    c_file.close();
+    m_index = 0;
+    m_count = 0;
+    m_indexOffset = 0;
+}
+
+/**
+ * @brief Corpus::getEntry Fetches an entry's metadata, and a pointer to its packed cells inside the mapping. Takes O(1) time,
+ * and checks that the whole entry lies inside the entries area of the file.
+ * @param m_i The entry's index.
+ * @param m_entry Receives the entry.
+ * @return False if there is no such entry, or it is corrupt.
+ */
+bool Corpus::getEntry(size_t m_i, CorpusEntry& m_entry) const
+{
+    uint64_t offset; // Entry's offset
+
+    if (m_i >= m_count) // No such entry
+    {
+        return false;
+    }
+
+    offset = m_index[m_i];
+
+    if (offset < sizeof(CorpusHeader) || offset > m_indexOffset || m_indexOffset - offset < sizeof(CorpusEntryHeader)) // Header outside the entries
+    {
+        return false;
+    }
+
+    memcpy(&m_entry.header, c_file.data() + offset, sizeof(m_entry.header));
+
+    if (m_entry.header.rows > CORPUS_MAX_SIDE || m_entry.header.cols > CORPUS_MAX_SIDE || m_entry.header.nColours < 1 || m_entry.header.nColours > 15
+            || m_indexOffset - offset - sizeof(CorpusEntryHeader) < snapshotCellBytes(m_entry.header.rows, m_entry.header.cols, 4)) // Nonsense size, or cells outside the entries
+    {
+        return false;
+    }
+
+    m_entry.cells = c_file.data() + offset + sizeof(CorpusEntryHeader);
+    return true;
+}
+
+/**
+ * @brief Corpus::load Unpacks a board from the corpus.
+ * @param m_i The entry's index.
+ * @param m_board Receives the board, resized to fit.
+ * @return False if there is no such entry, or it is corrupt.
+ */
+bool Corpus::load(size_t m_i, BoardGrid& m_board) const
+{
+    CorpusEntry entry; // The entry
+
+    if (!getEntry(m_i, entry))
+    {
+        return false;
+    }
+
+    m_board.resize(entry.header.rows, entry.header.cols);
+    return snapshotUnpackCells(entry.cells, 4, entry.header.nColours, m_board);
+}
@@ -0,0 +1,135 @@
+#ifndef CORPUS_HPP
+#define CORPUS_HPP
+
+/* C++ Headers */
+#include <cstddef> // size_t
+#include <cstdint> // Fixed-size fields
+#include <cstdio> // FILE
+#include <string> // STL strings
+#include <vector> // STL vectors
+
+/* My headers */
+#include "boardgrid.hpp" // Boards being stored
+#include "mappedfile.hpp" // Reading without copying
+
+using namespace std;
+
+/*
+ * Puzzle corpora. A corpus is one file holding any number of boards, of any sizes, for batch analysis:
+ *
+ *   CorpusHeader                    8 bytes
+ *   entries                         each a CorpusEntryHeader, then its cells at 4 bits each (as in snapshot.hpp), padded to 8 bytes
+ *   index                           one 64-bit file offset per entry
+ *   CorpusTrailer                   24 bytes, at the very end
+ *
+ * The trailer locates the index, and the index locates every entry, so any board is found in O(1) without reading the others.
+ * Everything is little-endian and 8-byte aligned, so a mapped corpus is read in place. Colour indices must fit in 4 bits, so
+ * boards have at most 15 colours.
+ */
+
+#define CORPUS_MAGIC "SGCP" // First 4 bytes of a corpus
+#define CORPUS_INDEX_MAGIC "SGCI" // Magic in the trailer
+#define CORPUS_VERSION 1 // Current version of the format
+
+/**
+ * @brief The CorpusHeader struct. The start of a corpus file.
+ */
+struct CorpusHeader
+{
+    char magic[4]; // CORPUS_MAGIC
+    uint32_t version; // CORPUS_VERSION
+};
+
+/**
+ * @brief The CorpusEntryHeader struct. The metadata stored before each board's cells.
+ */
+struct CorpusEntryHeader
+{
+    uint32_t rows; // # of rows
+    uint32_t cols; // # of columns
+    uint32_t nColours; // # of colours, excluding black
+    int32_t points; // Score already made on the board, for positions taken from games in progress
+    int32_t best; // Best known final score from this board, or -1 if unknown
+    uint32_t reserved; // 0. Keeps the 64-bit fields aligned.
+    uint64_t seed; // Seed the board was generated from
+    uint64_t hash; // Zobrist hash of the board
+};
+
+/**
+ * @brief The CorpusTrailer struct. The end of a corpus file.
+ */
+struct CorpusTrailer
+{
+    uint64_t indexOffset; // File offset of the index
+    uint64_t count; // # of entries
+    char magic[4]; // CORPUS_INDEX_MAGIC
+    uint32_t version; // CORPUS_VERSION
+};
+
+/**
+ * @brief The CorpusEntry struct. One board in a mapped corpus. The cells point into the mapping, and are only valid while the
+ * corpus is open.
+ */
+struct CorpusEntry
+{
+    CorpusEntryHeader header; // Size and metadata
+    const uint8_t* cells; // Packed cells, 2 to a byte
+};
+
+/**
+ * @brief The CorpusWriter class. Writes a corpus, one board at a time. The index is kept in memory and written by close().
+ */
+class CorpusWriter
+{
+    public:
+        /* Constructor/destructor */
+        CorpusWriter(); // Creates a writer with no file open
+        ~CorpusWriter(); // Closes the file, if one is open
+
+        /* Writing */
+        bool open(const string& m_path); // Creates a corpus file, replacing any file with that name
+        bool add(const BoardGrid& m_board, int m_nColours, uint64_t m_seed, int m_points = 0, int m_best = -1); // Appends a board
+        bool close(); // Writes the index and closes the file. Returns false if any write failed.
+
+        /* Status */
+        size_t getCount() const { return c_offsets.size(); } // Fetches the # of boards written
+
+    private:
+        CorpusWriter(const CorpusWriter&); // Not copyable
+        CorpusWriter& operator=(const CorpusWriter&);
+
+        bool write(const void* m_data, size_t m_size); // Writes bytes and advances the offset
+
+        FILE* c_file; // The corpus file
+        uint64_t m_offset; // Offset of the next byte to write
+        bool m_ok; // False once a write has failed
+        vector<uint64_t> c_offsets; // Offset of each entry
+        vector<uint8_t> c_buffer; // Packed cells of the entry being written
+};
+
+/**
+ * @brief The Corpus class. A read-only, memory-mapped corpus. Once open, it can be read by any number of threads at once.
+ */
+class Corpus
+{
+    public:
+        /* Constructor */
+        Corpus(); // Creates a corpus with no file open
+
+        /* Opening */
+        const char* open(const string& m_path); // Maps a corpus file. Returns 0, or a description of what is wrong with it.
+        void close(); // Unmaps the file
+
+        /* Access */
+        size_t getCount() const { return m_count; } // Fetches the # of boards
+        bool getEntry(size_t m_i, CorpusEntry& m_entry) const; // Fetches board i's metadata and packed cells, without copying
+        bool load(size_t m_i, BoardGrid& m_board) const; // Unpacks board i into a board, resized to fit
+
+    private:
+        MappedFile c_file; // The mapped corpus
+        const uint64_t* m_index; // Offset of each entry, inside the mapping
+        size_t m_count; // # of entries
+        uint64_t m_indexOffset; // Where the entries end
+};
+
+#endif // CORPUS_HPP
@@ -0,0 +1,53 @@
+# Headless game engine. Doesn't use Qt, so it can be shared by the game and by command-line tools.
+
+INCLUDEPATH += $$PWD
+CONFIG += thread # The solver runs on std::thread
+
+# Hot-path tracing (trace.hpp) is compiled out unless the project is built with "qmake CONFIG+=trace".
+trace {
+    DEFINES += SAMEGAME_TRACE
+}
+
+SOURCES += \
+    $$PWD/bitposition.cpp \
+    $$PWD/boardgenerator.cpp \
+    $$PWD/boardgrid.cpp \
+    $$PWD/boardt.cpp \
+    $$PWD/changeset.cpp \
+    $$PWD/corpus.cpp \
+    $$PWD/groupindex.cpp \
+    $$PWD/highscores.cpp \
+    $$PWD/mappedfile.cpp \
+    $$PWD/movescan.cpp \
+    $$PWD/position.cpp \
+    $$PWD/replay.cpp \
+    $$PWD/rng.cpp \
+    $$PWD/snapshot.cpp \
+    $$PWD/solver.cpp \
+    $$PWD/threadpool.cpp \
+    $$PWD/trace.cpp \
+    $$PWD/transpositiontable.cpp \
+    $$PWD/undostack.cpp \
+    $$PWD/zobrist.cpp
+
+HEADERS += \
+    $$PWD/bitposition.hpp \
+    $$PWD/boardgenerator.hpp \
+    $$PWD/boardgrid.hpp \
+    $$PWD/boardt.hpp \
+    $$PWD/changeset.hpp \
+    $$PWD/corpus.hpp \
+    $$PWD/groupindex.hpp \
+    $$PWD/highscores.hpp \
+    $$PWD/mappedfile.hpp \
+    $$PWD/movescan.hpp \
+    $$PWD/position.hpp \
+    $$PWD/replay.hpp \
+    $$PWD/rng.hpp \
+    $$PWD/snapshot.hpp \
+    $$PWD/solver.hpp \
+    $$PWD/threadpool.hpp \
+    $$PWD/trace.hpp \
+    $$PWD/transpositiontable.hpp \
+    $$PWD/undostack.hpp \
+    $$PWD/zobrist.hpp
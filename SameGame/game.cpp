@@ -1,29 +1,29 @@
 #include "game.hpp"
 
+/* My headers */
+#include "boardgenerator.hpp" // Board layout
+#include "corpus.hpp" // Boards from corpora
+#include "snapshot.hpp" // Saved game format
+#include "trace.hpp" // Hot-path tracing
+#include "zobrist.hpp" // Board hashing
+
 /* STL Headers */
 #include <utility> // std::pair<>
 #include <ctime> // time()
 #include <iostream> // cerr
+#include <algorithm> // min(), max()
+#include <stdexcept> // runtime_error
+#include <string> // to_string()
 
 /* Qt headers */
-#include <QDebug> // qDebug()
-#include <qglobal.h> // qsrand(), qrand()
-#include <QDateTime> // QDateTime class (get # of seconds since epoch for randomization)
+#include <QFile> // Memory-mapped loading
+#include <QSaveFile> // Safe saving
 
 using namespace std; // To save some typing
 
 /* Defines */
 #define BLACK 0 // Colour black - index in colour vector
 
-/*** Types ***/
-enum Direction
-{
-    LEFT = 1, // Start at 1
-    RIGHT,
-    TOP,
-    BOTTOM
-};
-
 /*** Constructors/destructors ***/
 
 /**
@@ -31,43 +31,140 @@ enum Direction
  * @param rows The number of rows in this game.
  * @param cols The number of columns in this game
  * @param nColours The number of colours to use for this game. (excluding black, which is always used).
+ * @param m_seed The seed for the game's random numbers. The same seed, size and # of colours always give the same game.
  */
-Game::Game(int rows, int cols, int nColours)
+Game::Game(int rows, int cols, int nColours, uint64_t m_seed) :
+    c_board(rows, cols), // Create the board and initialize it to rows x cols of black
+    m_seed(m_seed),
+    c_rng(m_seed), // Each game has its own generator, so games can be set up on any thread
+    m_fromSeed(true)
 {
-    int i; // Loop counter
-    int r, g, b; // Hold randomised red, green, and blue values
-
     /* Initialise variables */
     m_maxCol = cols; // Use the given # of columns
     m_maxRow = rows; // Use the given # of rows
     c_points = 0; // Initialize points to 0
     m_nColours = nColours; // Save # of colours
-    //c_cBlocks(); // Create the queue of changed blocks
-    c_board = new vector<vector<int>>(m_maxRow, vector<int>(m_maxCol, 0)); // Create the board vector and initialize it to m_maxRow rows, containing m_maxCol columns of black each
+    m_dirtyLo = 0; // No move has changed any columns yet
+    m_dirtyHi = -1;
+    m_removedColour = BLACK; // Nor removed any blocks
+    c_cBlocks.reset(c_board); // Size the set of changed blocks for the board
     c_colours = new vector<QColor>(); // Create the vector of colours
 
-    c_colours->push_back(QColor(0, 0, 0)); // Add black to vector first
+    initColours(); // Pick the colours
+    initBoard(); // Set up the board
+    c_groups.rebuild(c_board); // Find all of the groups on the new board
+    m_hash = zobristHash(c_board); // Hash the new board
+    m_fixedSize = boardKernelsFor(m_maxRow, m_maxCol, c_kernels); // Standard sizes have faster moves
+}
 
-    /* Initialise vector of colours to contain nColours random colours */
-    for (i = 0; i < nColours; i++) // Create nColors random colours
+/**
+ * @brief Game::Game Constructor. Loads a game saved by save(). The file is memory-mapped and its cells are copied straight into
+ * the board, so even very large boards load in milliseconds.
+ * @param fname The name of the file to load.
+ * @throws runtime_error If the file can't be read, or isn't a valid saved game.
+ */
+Game::Game(string fname) :
+    c_colours(new vector<QColor>()),
+    c_points(0),
+    m_dirtyLo(0), // No move has changed any columns yet
+    m_dirtyHi(-1),
+    m_removedColour(BLACK),
+    m_hash(0),
+    m_seed(0),
+    m_fromSeed(false) // Saved games and corpus boards don't keep the moves which led to them
+{
+    QFile file(QString::fromStdString(fname)); // The saved game
+    QByteArray contents; // The file's contents, if it can't be mapped
+    const uchar* data; // The snapshot
+    SnapshotHeader header; // Size, score and seed
+    vector<uint32_t> palette; // Colours, as 0xAARRGGBB
+    const char* error = 0; // What's wrong with the file, if anything
+    size_t i; // Colour counter
+
+    if (!file.open(QIODevice::ReadOnly)) // Can't read the file
     {
-        r = randIntInRange(1, 255); // Random red component, but not black
-        g = randIntInRange(1, 255); // Random green component, but not black
-        b = randIntInRange(1, 255); // Random blue component excluding black
-        //qDebug() << "Game::Game(int, int, int): Creating colour (" << r << ", " << g << ", " << b << ").";
-        c_colours->push_back(QColor(r, g, b)); // Create a new colour with random R, G, and B components, and add it to the list of colorus.
+        delete c_colours;
+        throw runtime_error("Couldn't open " + fname + ": " + file.errorString().toStdString());
     }
 
-    initBoard(); // Set up the board
+    data = file.map(0, file.size()); // Use the page cache directly
+
+    if (data == 0) // Some files can't be mapped, so read them instead
+    {
+        contents = file.readAll();
+        data = reinterpret_cast<const uchar*>(contents.constData());
+    }
+
+    error = snapshotRead(data, file.size(), header, palette, c_board);
+
+    if (error == 0 && zobristHash(c_board) != header.hash) // The cells don't match the header
+    {
+        error = "saved game is corrupt";
+    }
+
+    if (error != 0)
+    {
+        delete c_colours;
+        throw runtime_error(fname + ": " + error);
+    }
+
+    m_maxRow = header.rows;
+    m_maxCol = header.cols;
+    m_nColours = header.nColours;
+    c_points = header.points;
+    m_seed = header.seed;
+    m_hash = header.hash;
+    c_rng.seed(m_seed);
+
+    for (i = 0; i < palette.size(); i++) // Rebuild the colours
+    {
+        c_colours->push_back(QColor::fromRgba(palette[i]));
+    }
+
+    c_cBlocks.reset(c_board); // The whole board is new to the controller
+    c_cBlocks.markAll();
+    c_groups.rebuild(c_board); // Find all of the groups on the loaded board
+    m_fixedSize = boardKernelsFor(m_maxRow, m_maxCol, c_kernels); // Standard sizes have faster moves
 }
 
 /**
- * @brief Game::Game Constructor. Loads a game from a file.
- * @param fname The name of the file to parse.
+ * @brief Game::Game Constructor. Creates a new game on a board from a corpus. The colours are picked from the entry's seed, so
+ * a board which was generated from that seed looks the same as it did in the game it was generated for.
+ * @param m_corpus The corpus, which must be open.
+ * @param m_entry The index of the board in the corpus.
+ * @throws runtime_error If there is no such entry, or it is corrupt.
  */
-Game::Game(string fname)
+Game::Game(const Corpus& m_corpus, size_t m_entry) :
+    c_colours(new vector<QColor>()),
+    m_dirtyLo(0), // No move has changed any columns yet
+    m_dirtyHi(-1),
+    m_removedColour(BLACK),
+    m_hash(0),
+    m_seed(0),
+    m_fromSeed(false) // Saved games and corpus boards don't keep the moves which led to them
 {
+    CorpusEntry entry; // The entry's metadata
+
+    if (!m_corpus.getEntry(m_entry, entry) || !m_corpus.load(m_entry, c_board) // No such entry, or corrupt
+            || zobristHash(c_board) != entry.header.hash) // The cells don't match the header
+    {
+        delete c_colours;
+        throw runtime_error("corpus entry " + to_string((unsigned long long)m_entry) + " is missing or corrupt");
+    }
 
+    m_maxRow = entry.header.rows;
+    m_maxCol = entry.header.cols;
+    m_nColours = entry.header.nColours;
+    c_points = entry.header.points;
+    m_seed = entry.header.seed;
+    m_hash = entry.header.hash;
+    c_rng.seed(m_seed);
+
+    initColours(); // Same colours as a game generated from the seed
+    c_cBlocks.reset(c_board); // The whole board is new to the controller
+    c_cBlocks.markAll();
+    c_groups.rebuild(c_board); // Find all of the groups on the board
+    m_fixedSize = boardKernelsFor(m_maxRow, m_maxCol, c_kernels); // Standard sizes have faster moves
 }
 
 /**
@@ -77,7 +174,6 @@ Game::~Game()
 {
     try
     {
-        delete c_board; // Finally, Delete the board vector
         delete c_colours; // Delete the colour vector
     }
 
@@ -87,6 +183,35 @@ Game::~Game()
     }
 }
 
+/**
+ * @brief Game::save Saves the game to a file, in the snapshot format described in snapshot.hpp. The snapshot is built in memory
+ * and written with one call, to a temporary file which replaces the target only once it is complete.
+ * @param fname The name of the file to save to.
+ * @return True if the game was saved, false otherwise.
+ */
+bool Game::save(string fname)
+{
+    QSaveFile file(QString::fromStdString(fname)); // Replaces the file only on commit()
+    vector<uint32_t> palette; // Colours, as 0xAARRGGBB
+    QByteArray buffer(int(snapshotBytes(m_maxRow, m_maxCol, m_nColours)), 0); // The snapshot
+    size_t i; // Colour counter
+
+    for (i = 0; i < c_colours->size(); i++)
+    {
+        palette.push_back((*c_colours)[i].rgba());
+    }
+
+    snapshotWrite(reinterpret_cast<uint8_t*>(buffer.data()), c_board, m_nColours, palette.data(), c_points, m_seed, m_hash);
+
+    if (!file.open(QIODevice::WriteOnly) || file.write(buffer) != buffer.size()) // Couldn't write it
+    {
+        file.cancelWriting();
+        return false;
+    }
+
+    return file.commit();
+}
+
 /**
  * @brief Game::getBlockColour Fetches the colour of a block at a specified x and y position.
  * @param m_x The x position of the blcok.
@@ -96,14 +221,12 @@ Game::~Game()
 int Game::getBlockColour(int m_x, int m_y)
 {
     int colInd; // Index of colour in colours array. Fetched from board array.
-    vector<int> tempVec; // Temporary vector to hold column vector
 
     /* Check x and y to ensure they are legal */
-    if ((0 <= m_x && m_x < m_maxCol) && (0 <= m_y && m_y < m_maxRow)) // x and y must be on the board
+    if (c_board.inBounds(m_x, m_y)) // x and y must be on the board
     {
         // Everything's OK
-        tempVec = c_board->at(m_y); // Fetch the columns at this row
-        colInd = tempVec.at(m_x); // Fetch the colour at this column
+        colInd = c_board.at(m_x, m_y); // Fetch the colour at this position
 
         //qDebug() << "Game::getBlockColour: index @ (" << m_x << ", " << m_y << ") = " << colInd << endl;
         return colInd; // Return the colour at this index
@@ -122,7 +245,7 @@ int Game::getBlockColour(int m_x, int m_y)
  */
 QColor Game::getColourFromIndex(int ind)
 {
-    if (0 <= ind && ind < m_nColours) // Index is in range
+    if (0 <= ind && ind <= m_nColours) // Index is in range. Index 0 is black, so there are m_nColours+1 colours.
     {
         return c_colours->at(ind); // Return the colour at this index
     }
@@ -133,6 +256,15 @@ QColor Game::getColourFromIndex(int ind)
     }
 }
 
+/**
+ * @brief Game::getColours Fetches the list of colours which cell values index into. Index 0 is black (an empty cell).
+ * @return The list of colours, which stays valid for the life of the game.
+ */
+const vector<QColor>& Game::getColours() const
+{
+    return *c_colours; // No copy
+}
+
 /**
  * @brief Game::isGameOver Determines if the game is over by checking the board to see if it is empty, or if no moves are
  * left.
@@ -153,21 +285,31 @@ int Game::removeBlock(int m_x, int m_y)
 {
     int m_nBlocksRemoved = 0; // # of blocks deleted by this invocation of the method
 
+    TRACE_SCOPE("Game::removeBlock");
+
     if (errorCheck(m_x, m_y) == 0) // X and y aren't invalid, we're not trying to delete a background block, and the block has adjacent squares of the same colour
     {
-        qDebug() << "Game::removeBlock: passed error check";
+        m_dirtyLo = m_maxCol; // No columns have changed yet
+        m_dirtyHi = -1;
 
-        if (hasAdjBlockOfSameColour(m_x, m_y) == 1) // Can only remove a block if it has at least 1 neighbour of the same colour
+        if (hasAdjBlockOfSameColour(m_y, m_x) == 1) // Can only remove a block if it has at least 1 neighbour of the same colour
         {
-            qDebug() << "Game::removeBlock: passed adj of same colour check";
-            m_nBlocksRemoved = removeBlocks(m_x, m_y, c_board->at(m_y).at(m_x)); // Remove all adjacent blocks of this colour
-            qDebug() << "Game::removeBlock: passed removeBlocks";
+            m_nBlocksRemoved = removeBlocks(m_x, m_y); // Remove all adjacent blocks of this colour
 
             if (m_nBlocksRemoved > 0) // Blocks were removed
             {
                 c_points += (m_nBlocksRemoved*(m_nBlocksRemoved+1))/2; // Score increases w/ each block, so it's sum(i=1 to nDeleted, i).
-                compactBoard(); // Push together blocks, top to bottom, right to left, to get rid of gaps caused by the deletion
-                qDebug() << "Game::removeBlock: passed compactBoard";
+                c_moves.push_back(Move { m_x, m_y }); // Log the move for the replay
+                compactBoard(); // Let blocks fall into the gaps caused by the deletion, and drop empty columns
+                c_undo.push(c_changes, (m_nBlocksRemoved*(m_nBlocksRemoved+1))/2, c_board.index(m_x, m_y)); // Remember what changed, so the move can be taken back
+
+                {
+                    TRACE_SCOPE("GroupIndex::update");
+                    c_groups.update(c_board, m_dirtyLo, m_dirtyHi); // Relabel only the columns which changed
+                }
+
+                TRACE_COUNTER("Game::cells_removed", m_nBlocksRemoved);
+                TRACE_COUNTER("Game::cells_scanned", (m_dirtyHi - m_dirtyLo + 1) * m_maxRow); // Cells the group index relabelled
             }
         }
     }
@@ -176,26 +318,71 @@ int Game::removeBlock(int m_x, int m_y)
 }
 
 /**
- * @brief Game::isBoardEmpty Determines if the board is completely empty.
- * @return True if the board is empty, false otherwise.
+ * @brief Game::undo Takes back the last move, by restoring only the blocks it changed. The score and the move log are wound
+ * back too, and the restored blocks are added to the set of changed blocks for the controller.
+ * @return False if no move has been made, or every move has already been taken back.
  */
-bool Game::isBoardEmpty()
+bool Game::undo()
 {
-    int r; // Row counter
-    int c; // Column counter
+    const UndoStep* step = c_undo.undo(c_board); // The move taken back
 
-    for (r = 0; r < m_maxRow; r++) // Loop through the rows
+    if (step == 0) // Nothing to undo
     {
-        for (c = 0; c < m_maxCol; c++) // Loop through the columns
-        {
-            if (c_board->at(r).at(c) != BLACK) // This cell isn't black
-            {
-                return false; // Found a cell which isn't black, therefore the board isn't empty
-            }
-        }
+        return false;
+    }
+
+    c_points -= step->points;
+    c_moves.pop_back();
+    applyStep(*step);
+    return true;
+}
+
+/**
+ * @brief Game::redo Plays the last move which was taken back again, by rewriting only the blocks it changed. Making a new move
+ * forgets the moves which were taken back.
+ * @return False if there is no move to play again.
+ */
+bool Game::redo()
+{
+    const UndoStep* step = c_undo.redo(c_board); // The move played again
+
+    if (step == 0) // Nothing to redo
+    {
+        return false;
     }
 
-    return true;  // If we got here, the board is empty.
+    c_points += step->points;
+    c_moves.push_back(Move { c_board.xOf(step->cell), c_board.yOf(step->cell) });
+    applyStep(*step);
+    return true;
+}
+
+/**
+ * @brief Game::canUndo Determines if a move can be taken back.
+ * @return True if a move can be undone.
+ */
+bool Game::canUndo() const
+{
+    return c_undo.canUndo();
+}
+
+/**
+ * @brief Game::canRedo Determines if a move which was taken back can be played again.
+ * @return True if a move can be redone.
+ */
+bool Game::canRedo() const
+{
+    return c_undo.canRedo();
+}
+
+/**
+ * @brief Game::isBoardEmpty Determines if the board is completely empty. Blocks always fall to the bottom and columns always
+ * slide left, so the board is empty exactly when its bottom-left cell is, and only that cell is looked at.
+ * @return True if the board is empty, false otherwise.
+ */
+bool Game::isBoardEmpty()
+{
+    return m_maxRow == 0 || m_maxCol == 0 || c_board.at(0, m_maxRow-1) == BLACK; // No bottom-left block, so no blocks at all
 }
 
 /**
@@ -217,56 +404,97 @@ int Game::getMaxCol()
 }
 
 /**
-  * @brief Game::getChangedBlocks Fetches the queue of recently-changed blocks.
-  * @return The queue of recently-changed blocks.
+  * @brief Game::getChangedBlocks Fetches the set of blocks changed since the last call to clearChangedBlocks(). Each block is in
+  * the set once, however many times it changed. Read the blocks' colours through getCells().
+  * @return The set of recently-changed blocks.
   */
- QQueue<pair<int, int>> Game::getChangedBlocks()
+ const ChangeSet& Game::getChangedBlocks() const
  {
-     return c_cBlocks; // Return the queue
+     return c_cBlocks; // No copy
  }
 
  /**
-  * @brief Game::clearChangedBlocks Clears the queue of recently-changed blocks.
+  * @brief Game::clearChangedBlocks Clears the set of recently-changed blocks.
   */
  void Game::clearChangedBlocks()
  {
-     c_cBlocks.clear(); // Clear the queue
+     c_cBlocks.clear(); // Clear the set
  }
 
+ /**
+  * @brief Game::getCells Fetches a read-only view of the board's cells, which stays valid for the life of the game.
+  * @return A view of the cells.
+  */
+ CellSpan Game::getCells() const
+ {
+     return c_board.span(); // No copy
+ }
+
+/**
+ * @brief Game::getBoard Fetches the board. Searches copy it, so that they can run on other threads while the game goes on.
+ * @return The board, which stays valid for the life of the game.
+ */
+const BoardGrid& Game::getBoard() const
+{
+    return c_board; // No copy
+}
+
+/**
+ * @brief Game::getHash Fetches the Zobrist hash of the board. Boards with the same size and the same blocks have the same hash,
+ * however they were reached.
+ * @return The hash.
+ */
+uint64_t Game::getHash() const
+{
+    return m_hash;
+}
+
+/**
+ * @brief Game::getSeed Fetches the seed the game's colours and board were generated from. A game created with the same seed,
+ * size and # of colours starts out the same.
+ * @return The seed.
+ */
+uint64_t Game::getSeed() const
+{
+    return m_seed;
+}
+
+/**
+ * @brief Game::getReplay Fetches the game's replay: its size, # of colours, seed, every move which removed blocks, and the score.
+ * Replaying the moves on the board generated from the seed reaches the same score, which replayVerify() checks.
+ * @param m_replay Receives the replay.
+ * @return False if the game was loaded from a save or a corpus, since its starting board can't be rebuilt from the seed.
+ */
+bool Game::getReplay(Replay& m_replay) const
+{
+    if (!m_fromSeed) // Started part-way through
+    {
+        return false;
+    }
+
+    m_replay.rows = m_maxRow;
+    m_replay.cols = m_maxCol;
+    m_replay.nColours = m_nColours;
+    m_replay.seed = m_seed;
+    m_replay.score = c_points;
+    m_replay.moves = c_moves;
+    return true;
+}
+
 /*** Private methods ***/
 
 /**
  * @brief Game::hasAdjBlockOfSameColour Determines if the block at the given location has at least 1 neighbour of the same colour.
+ * Answered from the group index: a block has such a neighbour exactly when its group has at least 2 blocks.
  * @param row The row of the block to check.
  * @param col The column of the block to check.
  * @return 1 if a neighbour with the same colour exists, 0 otherwise. Returns -1 if there are errors.
  */
 int Game::hasAdjBlockOfSameColour(int m_row, int m_col)
 {
-    int myCol = c_board->at(m_row).at(m_col); // Store the colour of this block for later comparison. Saves some calls.
-    qDebug() << "Colour of block at (" << m_col << ", " << m_row << ") = " << myCol;
-    vector<pair<int, int>> adj; // Vector containing adjacent blocks
-    pair<int, int> coord; // A single coordinate in the vector
-
     if (errorCheck(m_col, m_row) == 0) // Check for errors in the given coords - x and y are valid, and this isn't a black square
     {
-        qDebug() << "Game::hasAdjBlockOfSameColour: passed error check";
-        adj = adjBlocks(m_row, m_col); // Get a list of this cell's neighbours
-
-        for (vector<pair<int, int>>::iterator it = adj.begin(); it != adj.end(); it++) // Loop through list of adjacent blocks
-        {
-            coord = *it; // Store the coordinate of the adjacent block
-            qDebug() << "Game::hasAdjBlockOfSameColour: checking adjacent location (" << get<1>(coord) << ", " << get<0>(coord) << ")";
-
-            if (c_board->at(get<0>(coord)).at(get<1>(coord)) == myCol) // If the block at this position is of the same colour
-            {
-                qDebug() << "Game::hasAdjBlockOfSameColour: found matching colour (" << c_board->at(get<0>(coord)).at(get<1>(coord)) << ")" << endl;
-                return 1; // Found an adjacent block of the same colour
-            }
-        }
-
-        qDebug() << "Game::hasAdjBlockOfSameColour: returning 0" << endl;
-        return 0; // Didn't find any neighbours with the same colour
+        return c_groups.isMovable(c_board.index(m_col, m_row)) ? 1 : 0; // Look up the size of its group
     }
 
     else
@@ -276,284 +504,44 @@ int Game::hasAdjBlockOfSameColour(int m_row, int m_col)
 }
 
 /**
- * @brief Game::adjBlocks Finds all blocks on the board adjacent to a given block.
- * @param m_row The row of the block to check.
- * @param m_col The column of the block to check.
- * @return A vector containing coordinates of adjacent blocks.
+ * @brief Game::initColours Fills the list of colours with black, followed by nColours random colours from the game's generator.
  */
-vector<pair<int, int>> Game::adjBlocks(int m_row, int m_col)
+void Game::initColours()
 {
-    vector<pair<int, int>> adjBs; // Vector of adjacent blocks
-
-    qDebug() << "Game::adjBlocks: checking coord (" << m_col << ", " << m_row << ").";
-
-    /* Check for neighbours in all directions */
-
-    // Check for neighbour to left
-    if (errorCheck(m_col-1, m_row) != -1)
-    {
-        qDebug() << "Game::adjBlocks: coord (" << m_col-1 << ", " << m_row << ") exists. Adding it to vector.";
-        // There is a block to the left
-        adjBs.push_back(pair<int, int>(m_row, m_col-1)); // Add the coord (m_row, m_col-1) to the vector
-    }
-
-    // Check for neighbour to right
-    else if (errorCheck(m_col+1, m_row) != -1)
-    {
-        qDebug() << "Game::adjBlocks: coord (" << m_col+1 << ", " << m_row << ") exists. Adding it to vector.";
-        // There is a block to the right
-        adjBs.push_back(pair<int, int>(m_row, m_col+1)); // Add coord (m_row, m_col+1) to list of coords
-    }
+    int i; // Loop counter
+    int r, g, b; // Hold randomised red, green, and blue values
 
-    // Check for neighbour above
-    else if (errorCheck(m_col, m_row-1) != -1)
-    {
-        qDebug() << "Game::adjBlocks: coord (" << m_col << ", " << m_row-1 << ") exists. Adding it to vector.";
-        // There is a square above
-        adjBs.push_back(pair<int, int>(m_row-1, m_col));
-    }
+    c_colours->push_back(QColor(0, 0, 0)); // Add black to vector first
 
-    // Check for neighbour below
-    else if (errorCheck(m_col, m_row+1) != -1)
+    /* Initialise vector of colours to contain nColours random colours */
+    for (i = 0; i < m_nColours; i++) // Create nColors random colours
     {
-        qDebug() << "Game::adjBlocks: coord (" << m_col << ", " << m_row+1 << ") exists. Adding it to vector.";
-        // There is a block below
-        adjBs.push_back(pair<int, int>(m_row+1, m_col)); // Add the coord (m_row+1, m_col) to the vector
+        r = randIntInRange(1, 255); // Random red component, but not black
+        g = randIntInRange(1, 255); // Random green component, but not black
+        b = randIntInRange(1, 255); // Random blue component excluding black
+        c_colours->push_back(QColor(r, g, b)); // Create a new colour with random R, G, and B components, and add it to the list of colorus.
     }
-
-    return adjBs; // Return the vector of pairs (coordinates)
 }
 
-/*
- * @brief Game::initBoard Sets up the board for a new game by creating the array and initialising it to the given size
- * (rows x cols), then setting each cell to a random colour.
+/**
+ * @brief Game::initBoard Sets up the board for a new game, by filling the empty board with random colours from the game's
+ * generator, then marks every block as changed so that the controller draws the whole board.
  */
 void Game::initBoard()
 {
-    /* Data structures */
-    vector<int> usedDirs; // Vector which holds directions that have already been chosen (to prevent our selecting the same direction a second time)
-
-    /* Loop-control booleans */
-    bool dirChosen = false; // Controls loop which chooses a direction to go in
-
-    /* Algo vars */
-    int randColInd; // Index of random colour to use
-    int randDir; // Random direction to move in
-    int nFSqs; // Number of squares free in the chosen direction
-    int c_curX; // Current x pos
-    int c_curY; // Current y pos
-    int nToFill; // # of squares to fill in a given direction. Must be <= nFSqs.
-
-    /* Other vars */
-    int r = 0; // Row loop counter
-    int c = 0; // Column loop counter
-
-    for (r = 0; r < m_maxRow; r++) // Loop through rows
-    {
-        for (c = 0; c < m_maxCol; c++) // Loop through columns
-        {
-            /*col = randIntInRange(1, c_colours->size()-1); // Store index for debugging. Exclude black, so that board is filled.
-            //qDebug() << "Game::initBoard: colour index at (" << r << ", " << c << ") = " << col << endl;
-            c_board->at(r)[c] = col; // Set the value at this row and column to the generated colour index
-            c_cBlocks.enqueue(pair<int, int>(c, r)); // Add the coords of the initialised block to the queue of changed blocks so that it can be processed by the controller later on*/
-
-            //qDebug() << "Checking cell (" << c << ", " << r << ")";
-
-            if (c_board->at(r).at(c) == BLACK) // We don't want to change coloured squares
-            {
-                //qDebug() << "Cell (" << c << ", " << r << ") is black.";
-                randColInd = randIntInRange(1, c_colours->size()-1); // Choose a random colour index
-                //qDebug() << "Chosen colour index = " << randColInd;
-                c_board->at(r)[c] = randColInd; // Set this cell's colour to the randomly-chosen one
-                c_cBlocks.enqueue(pair<int, int>(c, r)); // Add changed block to queue
-                //qDebug() << "After assignment, colour index at (" << c << ", " << r << ") = " << c_board->at(r).at(c);
-
-                /* Choose a random direction with at least 1 black square */
-                while (!dirChosen) // Loop until a direction with at least 1 black square has been chosen
-                {
-                    //qDebug() << "No dir chosen yet.";
-                    randDir = randIntInRange(LEFT, BOTTOM); // Choose a random direction
-                    //qDebug() << "Random dir = " << randDir;
-
-                    /* Ensure that we haven't already checked that direction */
-                    if (find(usedDirs.begin(), usedDirs.end(), randDir) == std::end(usedDirs)) // The list doesn't contain that direction, so we haven't used it yet
-                    {
-                        //qDebug() << "Checking (currently) unchecked dir " << randDir;
-
-                        /* Check if there is at least 1 black square in that direction */
-                        switch (randDir) // Handle checks in different directions separately
-                        {
-                            case LEFT: // Checking the left
-                            {
-                                //qDebug() << "Checking left" << endl << "errorCheck(" << c-1 << ", " << r << ") = " << errorCheck(c-1, r);
-
-                                /* Use errorCheck to determine if square exists and is black. errorCheck returns -2 in this case */
-                                if (errorCheck(c-1, r) == -2) // Square to left exists and is black
-                                {
-                                    dirChosen = true; // We have found the direction in which we want to go, end the while loop after the next bit of code which finds the # of squares free in this direction
-
-                                    /* Set up for counting black squares */
-                                    c_curX = c-2; // Start 2 cols to the left (we already checked the column just to our left)
-                                    c_curY = r; // Start at this y pos
-                                    nFSqs = 1; // Start w/ a count of 1 (the square to the left is known to be free)
-
-                                    while (errorCheck(c_curX, c_curY) == -2) // Loop while the square to the left exists and is black
-                                    {
-                                        nFSqs++; // Increment # of free cells
-                                        c_curX--; // Check the cell to the left on the next loop
-                                    }
-
-                                    nToFill = randIntInRange(1, nFSqs/2); // Choose between 1 and the # of free squares in this direction to fill.
-                                    c_curX = c-1; // Move 1 step to the left
-
-                                    while (nToFill > 0) // Keep filling squares until we have filled all of the ones which we wanted to fill
-                                    {
-                                        c_board->at(c_curY)[c_curX] = randColInd; // Set the square to the randomly-chosen colour
-                                        c_cBlocks.enqueue(pair<int, int>(c_curX, c_curY)); // Add changed block to queue
-                                     //   qDebug() << "Set (" << c_curX << ", " << c_curY << ") to " << c_board->at(c_curY).at(c_curX);
-                                        c_curX--; // Move left for next loop
-                                        nToFill--; // Count this square to stop loop eventually
-                                    }
-                                }
-
-                                break;
-                            }
-
-                            case RIGHT: // Checking the right
-                            {
-                                //qDebug() << "Checking right" << endl << "errorCheck(" << c+1 << ", " << r << ") = " << errorCheck(c+1, r);
-
-                                /* Use errorCheck to determine if square exists and is black. errorCheck returns -2 in this case */
-                                if (errorCheck(c+1, r) == -2) // Square to right exists and is black
-                                {
-                                    dirChosen = true; // We have found the direction in which we want to go, end the while loop after the next bit of code which finds the # of squares free in this direction
-
-                                    /* Set up for counting black squares */
-                                    c_curX = c+2; // Start 2 cols to the right
-                                    c_curY = r; // Start at this y pos
-                                    nFSqs = 1; // Start w/ a count of 1 (we've already checked the square just to our right)
-
-                                    while (errorCheck(c_curX, c_curY) == -2) // Loop while the square to the right exists and is black
-                                    {
-                                        nFSqs++; // Increment # of free cells
-                                        c_curX++; // Check the cell to the right on the next loop
-                                    }
-
-                                    nToFill = randIntInRange(1, nFSqs); // Choose between 1 and the # of free squares in this direction to fill.
-                                    c_curX = c+1; // Move 1 step to the right
-
-                                    while (nToFill > 0) // Keep filling squares until we have filled all of the ones which we wanted to fill
-                                    {
-                                        c_board->at(c_curY)[c_curX] = randColInd; // Set the square to the randomly-chosen colour
-                                        c_cBlocks.enqueue(pair<int, int>(c_curX, c_curY)); // Add changed block to queue
-                                  //      qDebug() << "Set (" << c_curX << ", " << c_curY << ") to " << c_board->at(c_curY).at(c_curX);
-                                        c_curX++; // Move right for next loop
-                                        nToFill--; // Count this square to stop loop eventually
-                                    }
-                                }
-
-                                break;
-                            }
-
-                            case TOP: // Checking the top
-                            {
-                                //qDebug() << "Checking top" << endl << "errorCheck(" << c << ", " << r-1 << ") = " << errorCheck(c, r-1);
-
-                                /* Use errorCheck to determine if square exists and is black. errorCheck returns -2 in this case */
-                                if (errorCheck(c, r-1) == -2) // Square above exists and is black
-                                {
-                                    dirChosen = true; // We have found the direction in which we want to go, end the while loop after the next bit of code which finds the # of squares free in this direction
-
-                                    /* Set up for counting black squares */
-                                    c_curX = c; // Stay in this column
-                                    c_curY = r-2; // Start 2 rows above (we've already checked the row just above us)
-                                    nFSqs = 1; // Start w/ a count of 1 (we've already checked the row just above us)
-
-                                    while (errorCheck(c_curX, c_curY) == -2) // Loop while the square above exists and is black
-                                    {
-                                        nFSqs++; // Increment # of free cells
-                                        c_curY--; // Check the cell above on the next loop
-                                    }
-
-                                    nToFill = randIntInRange(1, nFSqs); // Choose between 1 and the # of free squares in this direction to fill.
-                                    c_curY = r-1; // Move 1 step up
-
-                                    while (nToFill > 0) // Keep filling squares until we have filled all of the ones which we wanted to fill
-                                    {
-                                        c_board->at(c_curY)[c_curX] = randColInd; // Set the square to the randomly-chosen colour
-                                        c_cBlocks.enqueue(pair<int, int>(c_curX, c_curY)); // Add changed block to queue
-                                  //      qDebug() << "Set (" << c_curX << ", " << c_curY << ") to " << c_board->at(c_curY).at(c_curX);
-                                        c_curY--; // Move up for next loop
-                                        nToFill--; // Count this square to stop loop eventually
-                                    }
-                                }
-
-                                break;
-                            }
-
-                            case BOTTOM: // Checking the bottom
-                            {
-                                //qDebug() << "Checking bottom" << endl << "errorCheck(" << c << ", " << r+1 << ") = " << errorCheck(c, r+1);
-
-                                /* Use errorCheck to determine if square exists and is black. errorCheck returns -2 in this case */
-                                if (errorCheck(c, r+1) == -2) // Square below exists and is black
-                                {
-                                    dirChosen = true; // We have found the direction in which we want to go, end the while loop after the next bit of code which finds the # of squares free in this direction
-
-                                    /* Set up for counting black squares */
-                                    c_curX = c; // Stay in this column
-                                    c_curY = r+2; // Start 2 rows below (we've already checked the row just below us)
-                                    nFSqs = 1; // Start w/ a count of 1 (we've already checked the row just below us)
-
-                                    while (errorCheck(c_curX, c_curY) == -2) // Loop while the square above exists and is black
-                                    {
-                                        nFSqs++; // Increment # of free cells
-                                        c_curY++; // Check the cell below on the next loop
-                                    }
-
-                                    nToFill = randIntInRange(1, nFSqs); // Choose between 1 and the # of free squares in this direction to fill.
-                                    c_curY = r+1; // Move 1 step down
-
-                                    while (nToFill > 0) // Keep filling squares until we have filled all of the ones which we wanted to fill
-                                    {
-                                        c_board->at(c_curY)[c_curX] = randColInd; // Set the square to the randomly-chosen colour
-                                        c_cBlocks.enqueue(pair<int, int>(c_curX, c_curY)); // Add changed block to queue
-                                 //       qDebug() << "Set (" << c_curX << ", " << c_curY << ") to " << c_board->at(c_curY).at(c_curX);
-                                        c_curY++; // Move down for next loop
-                                        nToFill--; // Count this square to stop loop eventually
-                                    }
-                                }
-
-                                break;
-                            }
-                        }
-
-                        usedDirs.push_back(randDir); // Remember that we used this direction
-                    }
-                }
-
-                /* At this point, we have chosen a direction to move in */
-            }
-        }
-    }
+    BoardGenerator::fill(c_rng, m_nColours, c_board.data() + c_board.index(0, 0), m_maxRow, m_maxCol, c_board.getStride()); // Same layout as bulk-generated boards
+    c_cBlocks.markAll(); // Every block is new
 }
 
 /**
- * @brief randIntInRange Generates a random integer in the range [lBound, uBound].
+ * @brief randIntInRange Generates a random integer in the range [lBound, uBound], from the game's own generator.
  * @param lBound The lower bound of the range to generate a random integer from.
  * @param uBound The upper bound of the range to generate a random integer from.
  * @return A random integer in the range [lBound, uBound].
  */
 int Game::randIntInRange(int lBound, int uBound)
 {
-    //qsrand(QDateTime::currentMSecsSinceEpoch()); // Seed RNG with current milliseconds since epoch initial value
-    qsrand(qrand());
-    //srand(time(NULL)); // Seed RNG
-    return qrand() % ((uBound + 1) - lBound) + lBound;
-    //return qrand() % (uBound - lBound) + lBound + 1;
-    //srand(rand());
-    //return rand() % (uBound - lBound) + lBound + 1;
-    //return rand() % ((uBound+1) - lBound) + 1;
+    return c_rng.inRange(lBound, uBound); // Unbiased, unlike qrand() % n
 }
 
 /**
@@ -562,33 +550,8 @@ int Game::randIntInRange(int lBound, int uBound)
  */
 bool Game::noMovesLeft()
 {
-    // We only need to check if there are no squares w/ at least 1 adjacent square of the same colour
-    int r; // Row counter
-    int c; // Column counter
-
-    for (r = 0; r < m_maxRow; r++) // Loop through the rows
-    {
-        for (c = 0; c < m_maxCol; c++) // Loop through the columns
-        {
-            qDebug() << "Game::noMovesLeft: checking (" << c << ", " << r << ") (" << c_board->at(r).at(c) << ")";
-
-            if (c_board->at(r).at(c) != BLACK) // Found coloured square - we don't care about black ones
-            {
-                qDebug() << "Game::noMovesLeft: (" << c << ", " << r << ") isn't black, it's (" << c_board->at(r).at(c) << ")";
-
-                if (hasAdjBlockOfSameColour(r, c) == 1) // Found an adjacent block of the same colour
-                {
-                    qDebug() << "Game::noMovesLeft: this square has an adjacent block of the same colour. Returning false." << endl;
-                    return false; // This block can be deleted - at least 1 block adjacent to it has the same colour
-                }
-            }
-        }
-    }
-
-    qDebug() << "Game::noMovesLeft: returning true" << endl;
-    return true; // If we got here, there are no more moves left
+    return c_groups.getMovableCount() == 0; // The group index counts the groups which can be removed
 }
-
 /**
  * @brief errorCheck Checks the given location for errors.
  * @param m_x The x coord of the block to check.
@@ -597,11 +560,9 @@ bool Game::noMovesLeft()
  */
 int Game::errorCheck(int m_x, int m_y)
 {
-    if ((0 <= m_x && m_x < m_maxCol)
-        &&
-        (0 <= m_y && m_y < m_maxRow)) // x and y are within bounds
+    if (c_board.inBounds(m_x, m_y)) // x and y are within bounds
     {
-        if (c_board->at(m_y).at(m_x) != BLACK) // Not trying to delete a background block
+        if (c_board.at(m_x, m_y) != BLACK) // Not trying to delete a background block
         {
             return 0; // All error checks were successful.
         }
@@ -619,147 +580,65 @@ int Game::errorCheck(int m_x, int m_y)
 }
 
 /**
- * @brief Game::removeBlocks Recursively removes this block and all adjacent ones of the same colour.
- * @param x The x coord of the block to remove on this invocation.
- * @param y The y coord of the block to remove on this invocation.
- * @param col The colour of the blocks to remove. An index to the array of colours.
+ * @brief Game::removeBlocks Removes this block and all connected blocks of the same colour, using the board's iterative
+ * flood fill, or the fixed-size one on boards of a standard size. The removed blocks are marked as REMOVED until compactBoard() runs, and the range of columns they cover is
+ * stored for it.
+ * @param x The x coord of the block to start at.
+ * @param y The y coord of the block to start at.
  * @return The number of blocks removed, >= 0.
  */
-int Game::removeBlocks(int m_x, int m_y, int m_col)
+int Game::removeBlocks(int m_x, int m_y)
 {
     int nDeleted = 0; // # of blocks deleted by this call
+    int x; // Column of a deleted block
+
+    TRACE_SCOPE("Game::removeBlocks");
 
     if (errorCheck(m_x, m_y) == 0) // We can delete a block at this location
     {
-        qDebug() << "Game::removeBlocks: passed error check";
-
-        /*if (hasAdjBlockOfSameColour(m_y, m_x) == 1) // Can only delete a block if it has adjacent blocks of the same colour
-        {*/
-            qDebug() << "Game::removeBlocks: passed adjacency check";
-
-            c_board->at(m_y)[m_x] = BLACK; // Delete the piece at this location (set square to black)
-            nDeleted = 1; // Deleted 1 block
-            c_cBlocks.enqueue(pair<int, int>(m_x, m_y)); // Add the coords of the deleted block to the queue of changed blocks
+        m_removedColour = c_board.at(m_x, m_y); // Remember the group's colour for compactBoard()
+        nDeleted = m_fixedSize ? c_kernels.floodRemove(c_board.data(), c_board.index(m_x, m_y), c_removed, BoardGrid::REMOVED)
+                               : c_board.floodRemove(c_board.index(m_x, m_y), c_fillStack, c_removed, BoardGrid::REMOVED); // Clear the whole group in one pass
 
-            /** TODO: Add error checks around colour checks, to ensure that the square exists **/
-
-            if (errorCheck(m_x-1, m_y) == 0) // Block must exist and not be black
-            {
-                qDebug() << "Game::removeBlocks(): error check of (" << m_x-1 << ", " << m_y << ") passed.";
-
-                /* If there are any adjacent blocks of the same colour, remove them and check their neighbours as well */
-                if (c_board->at(m_y).at(m_x-1) == m_col) // Block of same colour to left
-                {
-                  nDeleted += removeBlocks(m_x-1, m_y, m_col); // Recursively remove that block and its neighbours, and count the # of deletions
-                }
-            }
-
-            if (errorCheck(m_x+1, m_y) == 0) // Block must exist and not be black
-            {
-                qDebug() << "Game::removeBlocks(): error check of (" << m_x+1 << ", " << m_y << ") passed.";
-
-                if (c_board->at(m_y).at(m_x+1) == m_col) // Same colour block to right
-                {
-                    nDeleted += removeBlocks(m_x+1, m_y, m_col); // Delete it and any neighbours of the same colour, and count the # of blocks deleted by that call
-                }
-            }
-
-            if (errorCheck(m_x, m_y-1) == 0) // Block must exist and not be black
-            {
-                qDebug() << "Game::removeBlocks(): error check of (" << m_x << ", " << m_y-1 << ") passed.";
-
-                if (c_board->at(m_y-1).at(m_x) == m_col) // Same colour block above
-                {
-                    nDeleted += removeBlocks(m_x, m_y-1, m_col); // Delete it and its neighbours, and include # of deletions in return value
-                }
-            }
-
-            if (errorCheck(m_x, m_y+1) == 0) // Block must exist and not be black
-            {
-                qDebug() << "Game::removeBlocks(): error check of (" << m_x << ", " << m_y+1 << ") passed.";
-
-                if (c_board->at(m_y+1).at(m_x) == m_col) // Same colour block below
-                {
-                    nDeleted += removeBlocks(m_x, m_y+1, m_col); // Delete block and its neighbours, and include count in total
-                }
-            }
-        }
-
-       /* else // DEBUGGING
+        for (vector<int>::const_iterator it = c_removed.begin(); it != c_removed.end(); it++) // Find the columns which lost blocks
         {
-            qDebug() << "Game::removeBlocks: hasAdjBlockOfSameColour(" << m_y << ", " << m_x << ") failed (returned " << hasAdjBlockOfSameColour(m_y, m_x) << ")";
-        }*/
+            x = c_board.xOf(*it);
+            m_dirtyLo = min(m_dirtyLo, x);
+            m_dirtyHi = max(m_dirtyHi, x);
+        }
+    }
 
-    return nDeleted; // Return the # of blocks deleted on this call
+    return nDeleted; // Return the # of blocks deleted
 }
 
 /**
- * @brief Game::compactBoard Compacts the board after a deletion by shifting blocks left and down as far as possible.
+ * @brief Game::compactBoard Compacts the board after a deletion. Blocks fall down within the columns which lost blocks, then
+ * empty columns are dropped and the columns to their right slide left. Every block whose colour changed is added to the set
+ * of changed blocks. Boards of a standard size are compacted by the fixed-size kernel, which makes the same changes.
  */
 void Game::compactBoard()
 {
-    int c_newX; // X value to move block to when moving left
-    int c_newY; // Y value to move block to when moving down
-    int r; // Row counter
-    int c; // Column counter
-
-    /* Phase 1: move coloured blocks left */
-    for (c = 0; c < m_maxCol; c++) // Go from left to right, pushing things left
+    int lastChanged; // Rightmost column which changed
+#ifdef SAMEGAME_TRACE
+    int nMoved = 0; // # of blocks which fell or slid into a new cell
+#endif
+
+    TRACE_SCOPE("Game::compactBoard");
+    lastChanged = m_fixedSize ? c_kernels.compact(c_board.data(), m_dirtyLo, m_dirtyHi, m_removedColour, c_changes)
+                              : c_board.compact(m_dirtyLo, m_dirtyHi, m_removedColour, c_changes, c_column);
+    m_dirtyHi = max(m_dirtyHi, lastChanged); // Columns right of the removal change if one was dropped
+    m_hash = zobristUpdate(m_hash, c_changes); // Only the changed blocks' keys change
+
+    for (vector<CellChange>::const_iterator it = c_changes.begin(); it != c_changes.end(); it++) // Loop through the changed blocks
     {
-        for (r = 0; r < m_maxRow; r++) // Loop through the rows from left to right
-        {
-            //qDebug() << "Game::compactBoard: phase 1: checking (" << c << ", " << r << ")" << endl;
-
-            if (c_board->at(r).at(c) != BLACK) // This cell isn't empty
-            {
-                c_newX = c; // Start at this column
-                //qDebug() << "Game::compactBoard: phase 1: c_newX = " << c_newX << " before while" << endl;
-
-                while (c_newX > 0 && c_board->at(r).at(c_newX-1) == BLACK) // While we see empty cells to the left
-                {
-                    c_newX--; // Move further left
-                  //  qDebug() << "Game::comapctboard: phase 1: while: c_newX = " << c_newX << " after decrement" << endl;
-                }
-
-                if (c_newX != c) // c_newX changed, therefore block was moved
-                {
-                    c_board->at(r)[c_newX] = c_board->at(r).at(c); // Copy colour from block's old location to its new location
-                    c_cBlocks.enqueue(pair<int, int>(c_newX, r)); // Add the coords of the changed block to the queue
-                    c_board->at(r)[c] = BLACK; // Delete block from old location
-                    c_cBlocks.enqueue(pair<int, int>(c, r)); // Add coords of changed block to queue
-                }
-            }
-        }
+        markChanged(it->index); // Add the block to the set of changed blocks
+#ifdef SAMEGAME_TRACE
+        nMoved += (it->after != BoardGrid::EMPTY); // A block landed here
+#endif
     }
 
-    /* Phase 2: moving down */
-    for (c = 0; c < m_maxCol; c++) // For each column, from left to right
-    {
-        for (r = m_maxRow-1; r >= 0; r--) // For each row from bottom to top
-        {
-            if (c_board->at(r).at(c) != BLACK) // This cell isn't empty
-            {
-                c_newY = r; // While loop looks down, start 1 above it
-                //qDebug() << "Game::compactBoard: phase 2: c_newY = " << c_newY << " before while" << endl;
-
-                while (c_newY < (m_maxRow-1) && c_board->at(c_newY+1).at(c) == BLACK) // While we see empty cells below us and we're not yet at the last row
-                {
-                    c_newY++; // Move further down
-                    qDebug() << "Game::comapctboard: phase 2: while: c_newY = " << c_newY << " after inrement" << endl;
-                }
-
-                if (c_newY != r) // c_newY changed, therefore the block was moved
-                {
-                    c_board->at(c_newY)[c] = c_board->at(r).at(c); // Copy the old block's colour to the new location
-                    c_cBlocks.enqueue(pair<int, int>(c, c_newY)); // Add coords of changed block to queue
-                    c_board->at(r)[c] = BLACK; // Remove tile from old location
-                    c_cBlocks.enqueue(pair<int, int>(c, r)); // Add coords of changed block to queue
-                }
-            }
-        }
-    }
+    TRACE_COUNTER("Game::cells_moved", nMoved);
 }
-
 /**
  * @brief Game::getNumCols Fetches the # of colours in the game.
  * @return The number of colours in this game.
@@ -780,6 +659,82 @@ bool Game::isCellEmpty(int m_x, int m_y)
     return errorCheck(m_x, m_y) == -2; // Errorcheck returns -2 if square exists but is black
 }
 
+/**
+ * @brief Game::getGroupSize Fetches the # of blocks in the group containing the block at the given (x, y) position.
+ * @param m_x The x coord of the block.
+ * @param m_y The y coord of the block.
+ * @return The size of the block's group, 0 if the cell is empty or doesn't exist.
+ */
+int Game::getGroupSize(int m_x, int m_y)
+{
+    if (errorCheck(m_x, m_y) == 0) // Cell exists and isn't empty
+    {
+        return c_groups.getGroupSize(c_board.index(m_x, m_y)); // Look it up in the group index
+    }
+
+    else
+    {
+        return 0;
+    }
+}
+
+/**
+ * @brief Game::getLegalMoveCount Fetches the # of groups which can be removed, which is how big a buffer getLegalMoves() needs.
+ * @return The # of legal moves.
+ */
+int Game::getLegalMoveCount() const
+{
+    return c_groups.getMovableCount();
+}
+
+/**
+ * @brief Game::getLegalMoves Lists every group of 2 or more blocks, with a block to click to remove it, its size, its colour
+ * and the points it is worth. The group index is already up to date, so this is a single pass over its labels, which stops as
+ * soon as every group has been found; no flood fills are needed and nothing is allocated.
+ * @param m_moves The caller's buffer.
+ * @param m_max The # of moves the buffer can hold.
+ * @return The # of legal moves. If it is more than max, only the first max were written.
+ */
+int Game::getLegalMoves(LegalMove* m_moves, int m_max)
+{
+    return c_groups.listMovable(c_board, m_moves, m_max);
+}
+
+/**
+ * @brief Game::getGroupCells Lists the blocks in the group containing the block at the given (x, y) position, by their label
+ * in the group index.
+ * @param m_x The x coord of the block.
+ * @param m_y The y coord of the block.
+ * @param m_cells Receives the board indices of the group's blocks. Its previous contents are discarded.
+ * @return The # of blocks in the group, 0 if the cell is empty or doesn't exist.
+ */
+int Game::getGroupCells(int m_x, int m_y, vector<int>& m_cells)
+{
+    int label; // Label of the group
+    int x; // Column counter
+    int y; // Row counter
+
+    m_cells.clear();
+
+    if (errorCheck(m_x, m_y) == 0) // Cell exists and isn't empty
+    {
+        label = c_groups.getLabel(c_board.index(m_x, m_y));
+
+        for (y = 0; y < m_maxRow; y++) // Loop through rows
+        {
+            for (x = 0; x < m_maxCol; x++) // Loop through columns
+            {
+                if (c_groups.getLabel(c_board.index(x, y)) == label) // Same group
+                {
+                    m_cells.push_back(c_board.index(x, y));
+                }
+            }
+        }
+    }
+
+    return m_cells.size();
+}
+
 /**
  * @brief Game::getPoints Fetches the user's score.
  * @return  The user's score.
@@ -788,3 +743,37 @@ int Game::getPoints()
 {
     return c_points; // Return the user's score
 }
+
+/**
+ * @brief Game::applyStep Brings everything derived from the board up to date after an undo or redo rewrote a move's blocks.
+ * The hash changes by the same XOR in both directions, and the group index is only relabelled over the columns which changed.
+ * @param m_step The move which was undone or redone.
+ */
+void Game::applyStep(const UndoStep& m_step)
+{
+    const CellChange* changes = c_undo.getChanges(m_step); // Blocks which the move changed
+    size_t i; // Change counter
+
+    m_dirtyLo = m_maxCol; // No columns have changed yet
+    m_dirtyHi = -1;
+
+    for (i = 0; i < m_step.count; i++) // Let the controller know, and find the changed columns
+    {
+        markChanged(changes[i].index);
+    }
+
+    m_hash ^= m_step.hashDelta;
+    c_groups.update(c_board, m_dirtyLo, m_dirtyHi);
+}
+
+/**
+ * @brief Game::markChanged Adds a block to the set of changed blocks, and widens the range of columns changed by the current
+ * move to include it.
+ * @param m_i The board index of the changed block.
+ */
+void Game::markChanged(int m_i)
+{
+    c_cBlocks.mark(m_i); // Let the controller know
+    m_dirtyLo = min(m_dirtyLo, c_board.xOf(m_i)); // Widen the dirty range
+    m_dirtyHi = max(m_dirtyHi, c_board.xOf(m_i));
+}
\ No newline at end of file
@@ -3,12 +3,22 @@
 
 /* QT headers */
 #include <QColor> // Qt colour class for the board
-#include <QQueue> // Qt queue class
 
 /* C++ Headers */
 #include <array> // STL Arrays
+#include <string> // STL strings
 #include <vector> // STL vectors
 
+/* My headers */
+#include "boardgrid.hpp" // Flat board storage
+#include "boardt.hpp" // Fixed-size move operations
+#include "groupindex.hpp" // Labels of the groups on the board
+#include "changeset.hpp" // Set of changed cells
+#include "corpus.hpp" // Boards from corpora
+#include "replay.hpp" // Move logs
+#include "rng.hpp" // Random numbers for setting up the board
+#include "undostack.hpp" // Undo and redo history
+
 using namespace std;
 
 /**
@@ -19,43 +29,79 @@ class Game
 {
     public:
         /* Constructors/destructors */
-        Game(int rows, int cols, int nColours);
-        Game(string fname); // Constructor. Creates a new game object containing data loaded from a file with the name fname.
+        Game(int rows, int cols, int nColours, uint64_t m_seed); // Constructor. Creates a new game, with its colours and board generated from the given seed.
+        Game(const Corpus& m_corpus, size_t m_entry); // Constructor. Creates a new game on a board from a corpus. Throws runtime_error if the entry can't be read.
+        Game(string fname); // Constructor. Creates a new game object containing data loaded from a file with the name fname. Throws runtime_error if it can't.
         ~Game(); // Destructor. Deletes the new-ed variables and performs other cleanup as necessary.
+        bool save(string fname); // Saves the game to a file with the name fname, which the string constructor can load. Returns false if it can't.
         int getBlockColour(int m_x, int m_y); // Fetches the colour index of the block at the given index
         QColor getColourFromIndex(int ind); // Fetches the colour associated with a given index
+        const vector<QColor>& getColours() const; // Fetches the whole list of colours, indexed by cell value
         bool isGameOver(); // Determines if the game is over and returns true if it is, false otherwise
         int removeBlock(int x, int y); // Removes the block at a given (x, y) position on the board, and returns the # of blocks deleted
+        bool undo(); // Takes back the last move. Returns false if there is none.
+        bool redo(); // Plays the last move taken back again. Returns false if there is none.
+        bool canUndo() const; // Returns true if a move can be taken back
+        bool canRedo() const; // Returns true if a move which was taken back can be played again
         bool isBoardEmpty(); // Determines if the board is empty
         int getMaxRow(); // Fetches the # of rows in this game
         int getMaxCol(); // Fetches the # of columns in this game
-        QQueue<pair<int, int>> getChangedBlocks(); // Returns the queue of recently-changed blocks
-        void clearChangedBlocks(); // Empties the queue of changed blocks
+        const ChangeSet& getChangedBlocks() const; // Returns the set of recently-changed blocks
+        void clearChangedBlocks(); // Empties the set of changed blocks
+        CellSpan getCells() const; // Returns a read-only view of the board's cells
+        const BoardGrid& getBoard() const; // Returns the board, so that it can be copied for searching
         int getNumCols(); // Returns the number of colours
         bool isCellEmpty(int m_x, int m_y); // Returns true if the cell at the given (x, y) pos exists and is empty, false otherwise
         int getPoints(); // Fetches the user's score
+        int getGroupSize(int m_x, int m_y); // Fetches the # of blocks in the group containing the block at (x, y)
+        int getGroupCells(int m_x, int m_y, vector<int>& m_cells); // Lists the board indices of the blocks in the group containing (x, y)
+        int getLegalMoveCount() const; // Fetches the # of groups which can be removed
+        int getLegalMoves(LegalMove* m_moves, int m_max); // Lists every group which can be removed into the caller's buffer, and returns how many there are
+        uint64_t getHash() const; // Fetches the Zobrist hash of the board
+        uint64_t getSeed() const; // Fetches the seed the game was generated from
+        bool getReplay(Replay& m_replay) const; // Fetches the game's seed, moves and score. Returns false if the board wasn't generated from the seed.
 
     private:
         /** Game methods **/
+        void initColours(); // Picks the colours for a new game
         void initBoard(); // Sets up the board for a new game
         int hasAdjBlockOfSameColour(int m_row, int m_col); // Determines if a given cell has any neighbour of the same colour.
-        vector<pair<int, int>> adjBlocks(int m_row, int m_col); // Returns a vector containing the coordinates of all squares adjacent to the given one
         bool noMovesLeft(); // Returns true if no legal moves can be made, false otherwise
         int errorCheck(int m_x, int m_y); // Checks the given location for errors
-        int removeBlocks(int m_x, int m_y, int m_col); // Removes all adjacent blocks of a given colour. Starts at the given (x, y) pos, and recurses on neighbouring blocks.
-        void compactBoard(); // Compacts board after a deletion by shifting blocks left and down
+        int removeBlocks(int m_x, int m_y); // Removes the block at the given (x, y) pos and all connected blocks of the same colour
+        void compactBoard(); // Compacts board after a deletion by letting blocks fall down and dropping empty columns
+        void applyStep(const UndoStep& m_step); // Brings the change set, hash and group index up to date after a move was undone or redone
+        void markChanged(int m_i); // Marks the block at the given board index as changed, and adds its column to the range changed by the current move
 
         /* Helper functions */
         int randIntInRange(int lBound, int uBound); // Returns a random integer in the range [lBound, uBound]
 
         /* Game Data */
-        vector<vector<int>> *c_board; // Vector of vectors which represents the board. Each int is an index to the array of colours. Initialized to contain 10 rows
+        BoardGrid c_board; // The board. Each cell is an index to the array of colours.
+        BoardKernels c_kernels; // Fixed-size move operations for the board's size, if m_fixedSize
+        bool m_fixedSize; // True if the board is a standard size, so its moves run on c_kernels instead of BoardGrid's
         vector<QColor> *c_colours; // Vector of colours to pick cell colours from. A vector is used for extensibility - we can add more colours as we please.
         int m_maxCol; // Number of columns
         int m_maxRow; // Number of rows
         int c_points; // Number of points
         int m_nColours; // Number of colours
-        QQueue<pair<int, int>> c_cBlocks; // Queue which holds coords of changed blocks for controller to query
+        ChangeSet c_cBlocks; // Set of changed blocks for controller to query
+        GroupIndex c_groups; // Group label of every cell, and the size of every group
+        int m_dirtyLo; // Leftmost column changed by the current move
+        int m_dirtyHi; // Rightmost column changed by the current move
+        Cell m_removedColour; // Colour of the group removed by the current move
+        uint64_t m_hash; // Zobrist hash of the board, updated from the blocks changed by each move
+        uint64_t m_seed; // Seed the colours and board were generated from
+        Rng c_rng; // This game's random numbers
+        vector<Move> c_moves; // Every move which removed blocks, in order
+        UndoStack c_undo; // Cells changed by each move, for undo and redo
+        bool m_fromSeed; // True if the board was generated from m_seed, so the moves can be replayed from it
+
+        /* Scratch buffers. Kept between moves so that their memory is reused. */
+        vector<int> c_fillStack; // Work stack for the flood fill in removeBlocks
+        vector<int> c_removed; // Indices of the blocks removed by the last flood fill
+        vector<CellChange> c_changes; // Blocks changed by the last compaction
+        vector<Cell> c_column; // Scratch column for compactBoard
 };
 
 #endif // GAME_HPP
@@ -0,0 +1,340 @@
+#include "groupindex.hpp"
+
+/* STL Headers */
+#include <algorithm> // min(), max(), fill()
+
+using namespace std; // To save some typing
+
+/*** Constructor ***/
+
+/**
+ * @brief GroupIndex::GroupIndex Constructor. Creates an index with no groups. Call rebuild() before using it.
+ */
+GroupIndex::GroupIndex() :
+    c_sizes(1, 0), // Label 0 ("no group") always has size 0
+    m_stamp(0), // Nothing listed yet
+    m_nMovable(0) // No groups yet
+{
+}
+
+/*** Building ***/
+
+/**
+ * @brief GroupIndex::rebuild Labels every group on the board from scratch, using a two-pass union-find labelling. The first
+ * pass gives each cell a provisional label, merging the labels of its left and upper neighbours when they have the same
+ * colour. The second pass replaces each provisional label with the final label of its root and counts the group sizes.
+ * @param m_board The board to index.
+ */
+void GroupIndex::rebuild(const BoardGrid& m_board)
+{
+    int stride = m_board.getStride(); // Distance to the cell below
+    int x; // Column counter
+    int y; // Row counter
+    int i; // Index of the current cell
+    Cell colour; // Colour of the current cell
+    int up; // Provisional label of the cell above, or 0 if it's a different colour
+    int left; // Provisional label of the cell to the left, or 0 if it's a different colour
+    int rootUp; // Root of up's label
+    int rootLeft; // Root of left's label
+
+    c_labels.assign((m_board.getRows()+2) * stride, 0); // Everything starts with no group
+    c_parent.assign(1, 0); // Provisional label 0 is "no group"
+
+    /* Pass 1: provisional labels */
+    for (y = 0; y < m_board.getRows(); y++) // Loop through the rows
+    {
+        for (x = 0; x < m_board.getCols(); x++) // Loop through the columns
+        {
+            i = m_board.index(x, y);
+            colour = m_board.cell(i);
+
+            if (colour == BoardGrid::EMPTY) // Empty cells have no group
+            {
+                continue;
+            }
+
+            up = (m_board.cell(i - stride) == colour) ? c_labels[i - stride] : 0; // The border never matches a colour
+            left = (m_board.cell(i - 1) == colour) ? c_labels[i - 1] : 0;
+
+            if (up == 0 && left == 0) // Start a new provisional group
+            {
+                c_labels[i] = c_parent.size();
+                c_parent.push_back(c_labels[i]); // It is its own root
+            }
+
+            else if (up != 0 && left != 0) // Joins two groups, which may not have been merged yet
+            {
+                rootUp = findRoot(up);
+                rootLeft = findRoot(left);
+                c_labels[i] = min(rootUp, rootLeft);
+                c_parent[max(rootUp, rootLeft)] = c_labels[i]; // Merge the larger root into the smaller one
+            }
+
+            else // Continues the group above or to the left
+            {
+                c_labels[i] = (up != 0) ? up : left;
+            }
+        }
+    }
+
+    /* Pass 2: final labels and sizes */
+    c_sizes.assign(1, 0); // Forget all previous groups
+    m_nMovable = 0;
+    c_work.assign(c_parent.size(), 0); // Final label for each root, 0 until the root is first seen
+
+    for (y = 0; y < m_board.getRows(); y++) // Loop through the rows
+    {
+        for (x = 0; x < m_board.getCols(); x++) // Loop through the columns
+        {
+            i = m_board.index(x, y);
+
+            if (c_labels[i] != 0) // Cell belongs to a group
+            {
+                rootUp = findRoot(c_labels[i]); // Find the group's root
+
+                if (c_work[rootUp] == 0) // First cell of this group
+                {
+                    c_work[rootUp] = newLabel();
+                }
+
+                c_labels[i] = c_work[rootUp]; // Use the final label
+                grow(c_labels[i], 1); // Count the cell
+            }
+        }
+    }
+
+    c_work.clear(); // Done with the root map
+}
+
+/**
+ * @brief GroupIndex::update Brings the index up to date after a move changed the cells in columns [lo, hi]. Only the groups
+ * which touch those columns, or the columns next to them, are relabelled: each one is flood-filled with a fresh label, which
+ * also reaches any of its cells outside of the changed columns. The labels of all other groups are left alone.
+ * @param m_board The board, after the move.
+ * @param m_loCol The leftmost column which changed.
+ * @param m_hiCol The rightmost column which changed.
+ */
+void GroupIndex::update(const BoardGrid& m_board, int m_loCol, int m_hiCol)
+{
+    int stride = m_board.getStride(); // Distance to the cell below
+    int first; // First label created by this update. Cells with labels >= first have already been relabelled.
+    int x; // Column counter
+    int y; // Row counter
+    int i; // Index of the current cell
+    int j; // Index of the cell being labelled by the flood fill
+    int k; // Neighbour counter
+    int nb; // Index of a neighbour
+    int label; // Label being assigned by the flood fill
+    int n; // # of cells in the group being labelled
+    Cell colour; // Colour of the group being labelled
+    int offsets[4] = { -1, 1, -stride, stride }; // Offsets to the left, right, upper and lower neighbours
+
+    if (c_sizes.size() > c_labels.size() + 16) // Too many retired labels, start again with a compact set
+    {
+        rebuild(m_board);
+        return;
+    }
+
+    /* A group which lost cells may have been split: its cells on either side are found through the neighbouring columns */
+    m_loCol = max(m_loCol - 1, 0);
+    m_hiCol = min(m_hiCol + 1, m_board.getCols() - 1);
+    first = c_sizes.size();
+
+    for (x = m_loCol; x <= m_hiCol; x++) // Loop through the changed columns
+    {
+        for (y = 0; y < m_board.getRows(); y++) // Loop through the rows
+        {
+            i = m_board.index(x, y);
+
+            if (c_labels[i] >= first) // Already reached by an earlier flood fill
+            {
+                continue;
+            }
+
+            retire(c_labels[i]); // The group which held this cell is out of date
+            colour = m_board.cell(i);
+
+            if (colour == BoardGrid::EMPTY) // Empty cells have no group
+            {
+                c_labels[i] = 0;
+                continue;
+            }
+
+            /* Flood-fill the group with a new label */
+            label = newLabel();
+            c_labels[i] = label;
+            c_work.push_back(i);
+            n = 0;
+
+            while (!c_work.empty()) // Loop until the whole group has been labelled
+            {
+                j = c_work.back();
+                c_work.pop_back();
+                n++; // Count this cell
+
+                for (k = 0; k < 4; k++) // Check each neighbour. The border never matches, so no bounds checks are needed.
+                {
+                    nb = j + offsets[k];
+
+                    if (m_board.cell(nb) == colour && c_labels[nb] < first) // Same group, not relabelled yet
+                    {
+                        retire(c_labels[nb]); // Its old group is out of date
+                        c_labels[nb] = label;
+                        c_work.push_back(nb);
+                    }
+                }
+            }
+
+            grow(label, n); // Record the group's size
+        }
+    }
+}
+
+/*** Queries ***/
+
+/**
+ * @brief GroupIndex::listMovable Lists every group of 2 or more blocks, in one pass over the labels. Each group is listed once,
+ * at the first of its blocks met when scanning the rows from the bottom up, left to right. Blocks always rest on the bottom row
+ * and on the left, so the scan only covers the columns which are occupied on the bottom row, stops at the first empty row, and
+ * stops as soon as every movable group has been found. Groups are marked as listed with a stamp per label, so nothing has to
+ * be cleared between calls, and nothing is allocated unless the # of labels has grown.
+ * @param m_board The board the index was built for.
+ * @param m_moves The caller's buffer. Receives the first max groups found.
+ * @param m_max The # of moves the buffer can hold. getMovableCount() is always enough.
+ * @return The # of groups which can be removed. If it is more than max, only max of them were written.
+ */
+int GroupIndex::listMovable(const BoardGrid& m_board, LegalMove* m_moves, int m_max)
+{
+    const Cell* cells = m_board.data(); // Cells of the board, for quicker access
+    int width = 0; // # of occupied columns
+    int n = 0; // # of groups found
+    int x; // Column counter
+    int y; // Row counter
+    int i; // Index of the current cell
+    int label; // Label of the current cell
+    bool rowEmpty; // True while no block has been found on the current row
+    LegalMove* move; // Move being written
+
+    if (m_nMovable == 0) // Nothing to list
+    {
+        return 0;
+    }
+
+    if (c_listed.size() < c_sizes.size()) // New labels since the last call
+    {
+        c_listed.resize(c_sizes.size(), 0);
+    }
+
+    if (++m_stamp == 0) // Stamps wrapped around, so old stamps could be mistaken for new ones
+    {
+        fill(c_listed.begin(), c_listed.end(), 0);
+        m_stamp = 1;
+    }
+
+    for (i = m_board.index(0, m_board.getRows()-1); cells[i] != BoardGrid::EMPTY && cells[i] != BoardGrid::BORDER; i++) // Count the occupied columns. The border stops the loop.
+    {
+        width++;
+    }
+
+    for (y = m_board.getRows()-1; y >= 0 && n < m_nMovable; y--) // Loop through the rows, from the bottom up, until every group is found
+    {
+        rowEmpty = true;
+        i = m_board.index(0, y);
+
+        for (x = 0; x < width; x++, i++) // Loop through the occupied columns
+        {
+            label = c_labels[i];
+
+            if (label == 0) // Empty
+            {
+                continue;
+            }
+
+            rowEmpty = false;
+
+            if (c_sizes[label] < 2 || c_listed[label] == m_stamp) // Can't be removed, or already listed
+            {
+                continue;
+            }
+
+            c_listed[label] = m_stamp;
+
+            if (n < m_max) // Room in the buffer
+            {
+                move = &m_moves[n];
+                move->x = x;
+                move->y = y;
+                move->size = c_sizes[label];
+                move->colour = cells[i];
+                move->gain = (move->size*(move->size+1))/2; // Same scoring as Game
+            }
+
+            n++;
+        }
+
+        if (rowEmpty) // Nothing above an empty row
+        {
+            break;
+        }
+    }
+
+    return n;
+}
+
+/*** Helpers ***/
+
+/**
+ * @brief GroupIndex::newLabel Creates a new, empty group.
+ * @return The new group's label.
+ */
+int GroupIndex::newLabel()
+{
+    c_sizes.push_back(0); // No cells yet
+    return c_sizes.size() - 1;
+}
+
+/**
+ * @brief GroupIndex::retire Forgets a group, so that it no longer counts as movable. Does nothing for label 0, or for a group
+ * which has already been retired.
+ * @param m_label The label of the group to forget.
+ */
+void GroupIndex::retire(int m_label)
+{
+    if (c_sizes[m_label] >= 2) // It was movable
+    {
+        m_nMovable--;
+    }
+
+    c_sizes[m_label] = 0;
+}
+
+/**
+ * @brief GroupIndex::grow Adds cells to a group, and updates the count of movable groups.
+ * @param m_label The label of the group.
+ * @param m_n The # of cells to add.
+ */
+void GroupIndex::grow(int m_label, int m_n)
+{
+    if (c_sizes[m_label] < 2 && c_sizes[m_label] + m_n >= 2) // Group just became movable
+    {
+        m_nMovable++;
+    }
+
+    c_sizes[m_label] += m_n;
+}
+
+/**
+ * @brief GroupIndex::findRoot Finds the root of a provisional label, halving the path to it along the way.
+ * @param m_label The provisional label.
+ * @return The root of the label's tree.
+ */
+int GroupIndex::findRoot(int m_label)
+{
+    while (c_parent[m_label] != m_label) // Walk up to the root
+    {
+        c_parent[m_label] = c_parent[c_parent[m_label]]; // Path halving
+        m_label = c_parent[m_label];
+    }
+
+    return m_label;
+}
@@ -0,0 +1,67 @@
+#ifndef GROUPINDEX_HPP
+#define GROUPINDEX_HPP
+
+/* C++ Headers */
+#include <vector> // STL vectors
+
+/* My headers */
+#include "boardgrid.hpp" // Board being indexed
+
+using namespace std;
+
+/**
+ * @brief The LegalMove struct. A group which can be removed: one of its blocks, which can be clicked to remove it, and what
+ * removing it is worth.
+ */
+struct LegalMove
+{
+    int x; // Column of the group's representative block
+    int y; // Row of the group's representative block
+    int size; // # of blocks in the group
+    Cell colour; // The group's colour
+    int gain; // Points for removing the group, n(n+1)/2 for n blocks
+};
+
+/**
+ * @brief The GroupIndex class. Keeps track of the groups of connected, same-coloured cells on a board. Every cell gets the
+ * label of its group, and every label has a size, so whether a cell can be removed, how big its group is, and whether any
+ * move is left can all be answered without scanning the board.
+ *
+ * Labels are stored in an array with the same layout as the board's cells (border included), so they are addressed with
+ * the board's indices. Label 0 means "no group" (an empty cell, or the border).
+ */
+class GroupIndex
+{
+    public:
+        /* Constructor */
+        GroupIndex(); // Creates an empty index
+
+        /* Building */
+        void rebuild(const BoardGrid& m_board); // Labels the whole board from scratch
+        void update(const BoardGrid& m_board, int m_loCol, int m_hiCol); // Relabels the board after the columns in [lo, hi] changed
+
+        /* Queries */
+        int getLabel(int m_i) const { return c_labels[m_i]; } // Fetches the label of the cell at the given index
+        int getGroupSize(int m_i) const { return c_sizes[c_labels[m_i]]; } // Fetches the size of the group containing the given cell
+        bool isMovable(int m_i) const { return getGroupSize(m_i) >= 2; } // True if the cell's group can be removed
+        int getMovableCount() const { return m_nMovable; } // Fetches the # of groups which can be removed
+        int listMovable(const BoardGrid& m_board, LegalMove* m_moves, int m_max); // Lists every group which can be removed, in one pass
+
+    private:
+        /* Helpers */
+        int newLabel(); // Creates a new, empty group and returns its label
+        void retire(int m_label); // Forgets the group with the given label
+        void grow(int m_label, int m_n); // Adds n cells to the group with the given label
+        int findRoot(int m_label); // Finds the representative of a provisional label during rebuild()
+
+        /* Data */
+        vector<int> c_labels; // Label of each cell, in the same layout as the board
+        vector<int> c_sizes; // Size of each group, indexed by label. Retired labels have size 0.
+        vector<int> c_parent; // Union-find forest of provisional labels. Only used by rebuild().
+        vector<int> c_work; // Work stack for relabelling. Kept so that its memory is reused.
+        vector<unsigned> c_listed; // Stamp of the last listMovable() call which listed each label
+        unsigned m_stamp; // Stamp of the current listMovable() call
+        int m_nMovable; // # of groups with at least 2 cells
+};
+
+#endif // GROUPINDEX_HPP
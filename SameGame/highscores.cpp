@@ -0,0 +1,297 @@
+#include "highscores.hpp"
+
+/* STL Headers */
+#include <algorithm> // min()
+#include <cstdio> // fopen(), fwrite()
+#include <cstring> // memcpy(), memcmp()
+
+using namespace std; // To save some typing
+
+/* Defines */
+#define HIGHSCORE_READ_BATCH 1024 // # of records read from the log at once
+
+static_assert(sizeof(HighScoreFileHeader) == 8, "HighScoreFileHeader must have no padding");
+static_assert(sizeof(HighScore) == 32, "HighScore must have no padding");
+
+/*** Constructor/destructor ***/
+
+/**
+ * @brief HighScores::HighScores Constructor. Starts reading the log on the background thread, so that the caller doesn't wait
+ * for it. A missing log is the same as an empty one.
+ * @param m_path The log's path.
+ */
+HighScores::HighScores(const string& m_path) :
+    m_path(m_path),
+    m_loaded(false),
+    m_writeFailed(false),
+    c_writer(1) // One thread, so the log is only ever touched by one writer
+{
+    c_writer.submit([this] () { load(); });
+}
+
+/**
+ * @brief HighScores::~HighScores Destructor. Waits for the log to be loaded and for the queued scores to be written.
+ */
+HighScores::~HighScores()
+{
+    c_writer.wait();
+}
+
+/*** Scores ***/
+
+/**
+ * @brief HighScores::add Records a finished game. The score shows up in queries straight away, and is appended to the log on
+ * the background thread.
+ * @param m_score The game.
+ */
+void HighScores::add(const HighScore& m_score)
+{
+    {
+        lock_guard<mutex> lock(c_lock); // Guards the index and the queue
+
+        c_pending.push_back(m_score);
+
+        if (m_loaded) // Otherwise load() indexes it along with the queue
+        {
+            insert(m_score);
+        }
+    }
+
+    c_writer.submit([this] () { writePending(); });
+}
+
+/**
+ * @brief HighScores::top Fetches the best scores of a configuration. Waits for the log to finish loading, if it hasn't yet.
+ * @param m_rows The # of rows.
+ * @param m_cols The # of columns.
+ * @param m_nColours The # of colours.
+ * @param m_n The most scores to fetch. At most HIGHSCORE_KEEP are kept.
+ * @param m_scores Receives the scores, best first. Its previous contents are discarded.
+ * @return The # of scores fetched.
+ */
+int HighScores::top(int m_rows, int m_cols, int m_nColours, size_t m_n, vector<HighScore>& m_scores)
+{
+    unique_lock<mutex> lock(c_lock); // Guards the index
+    map<uint64_t, vector<HighScore>>::const_iterator it; // The configuration's scores
+
+    c_loaded.wait(lock, [this] () { return m_loaded; });
+    m_scores.clear();
+    it = c_index.find(keyOf(m_rows, m_cols, m_nColours));
+
+    if (it != c_index.end()) // Someone has played this configuration
+    {
+        m_scores.assign(it->second.begin(), it->second.begin() + min(m_n, it->second.size()));
+    }
+
+    return m_scores.size();
+}
+
+/**
+ * @brief HighScores::rank Fetches the position a score has in its configuration's table: 1 plus the # of better scores.
+ * @param m_score The score.
+ * @return The position, from 1, or 0 if HIGHSCORE_KEEP or more scores are better.
+ */
+int HighScores::rank(const HighScore& m_score)
+{
+    unique_lock<mutex> lock(c_lock); // Guards the index
+    map<uint64_t, vector<HighScore>>::const_iterator it; // The configuration's scores
+    int better = 0; // # of better scores
+
+    c_loaded.wait(lock, [this] () { return m_loaded; });
+    it = c_index.find(keyOf(m_score.rows, m_score.cols, m_score.nColours));
+
+    if (it != c_index.end())
+    {
+        while (better < int(it->second.size()) && it->second[better].score > m_score.score) // Best first, so stop at the first which isn't better
+        {
+            better++;
+        }
+    }
+
+    return (better < HIGHSCORE_KEEP) ? better + 1 : 0;
+}
+
+/**
+ * @brief HighScores::flush Waits until the log has been loaded and every added score has been written.
+ */
+void HighScores::flush()
+{
+    c_writer.wait();
+}
+
+/**
+ * @brief HighScores::hasWriteFailed Determines if any score couldn't be written to the log. Such scores are still in the index
+ * until the program exits.
+ * @return True if a write has failed.
+ */
+bool HighScores::hasWriteFailed() const
+{
+    lock_guard<mutex> lock(c_lock); // Guards the flag
+
+    return m_writeFailed;
+}
+
+/*** Background work ***/
+
+/**
+ * @brief HighScores::load Reads every record in the log, then builds the index from them and from any scores added in the
+ * meantime which haven't been written yet, and writes those. Runs on the background thread, like writePending(), so the log can't
+ * change while it is read. The file is read without holding the lock, so adding scores doesn't wait for it.
+ */
+void HighScores::load()
+{
+    FILE* file = fopen(m_path.c_str(), "rb"); // The log
+    HighScoreFileHeader header; // Its header
+    vector<HighScore> records; // Its records
+    size_t n; // # of records read by the last batch
+    size_t i; // Record counter
+
+    if (file != 0)
+    {
+        if (fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.magic, HIGHSCORE_MAGIC, sizeof(header.magic)) == 0
+                && header.version == HIGHSCORE_VERSION) // A log we understand
+        {
+            do // Read whole records until the end of the file. A torn last record is left out.
+            {
+                records.resize(records.size() + HIGHSCORE_READ_BATCH);
+                n = fread(&records[records.size() - HIGHSCORE_READ_BATCH], sizeof(HighScore), HIGHSCORE_READ_BATCH, file);
+                records.resize(records.size() - HIGHSCORE_READ_BATCH + n);
+            }
+            while (n == HIGHSCORE_READ_BATCH);
+        }
+
+        fclose(file);
+    }
+
+    {
+        lock_guard<mutex> lock(c_lock); // Guards the index
+
+        for (i = 0; i < records.size(); i++)
+        {
+            insert(records[i]);
+        }
+
+        for (i = 0; i < c_pending.size(); i++) // Added before the index was ready
+        {
+            insert(c_pending[i]);
+        }
+
+        m_loaded = true;
+    }
+
+    c_loaded.notify_all();
+    writePending(); // Any writes queued before this one left their scores for it
+}
+
+/**
+ * @brief HighScores::writePending Appends every queued score to the log, creating it if needed. Appends start after the last
+ * whole record, so a record torn by a crash is overwritten. A file which isn't a high score log is never written to. Does nothing
+ * until load() has run, so that no score is taken off the queue before it is indexed.
+ */
+void HighScores::writePending()
+{
+    vector<HighScore> batch; // Scores to write
+    HighScoreFileHeader header; // The log's header
+    FILE* file; // The log
+    long size; // Its size
+    long end = 0; // Offset just past its last whole record
+    bool ok; // True if the scores were written
+
+    {
+        lock_guard<mutex> lock(c_lock); // Guards the queue
+
+        if (!m_loaded) // The pool runs the newest task first, so this can beat load(). It indexes the queue, then writes it.
+        {
+            return;
+        }
+
+        batch.swap(c_pending);
+    }
+
+    if (batch.empty()) // An earlier call wrote them
+    {
+        return;
+    }
+
+    file = fopen(m_path.c_str(), "r+b");
+
+    if (file == 0) // No log yet
+    {
+        file = fopen(m_path.c_str(), "w+b");
+    }
+
+    ok = (file != 0 && fseek(file, 0, SEEK_END) == 0);
+    size = ok ? ftell(file) : -1;
+    ok = ok && size >= 0;
+
+    if (ok && size < long(sizeof(header))) // New, or torn before its header was written
+    {
+        memcpy(header.magic, HIGHSCORE_MAGIC, sizeof(header.magic));
+        header.version = HIGHSCORE_VERSION;
+        ok = fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+        end = sizeof(header);
+    }
+
+    else if (ok) // Check that it's ours, and find its last whole record
+    {
+        ok = fseek(file, 0, SEEK_SET) == 0 && fread(&header, sizeof(header), 1, file) == 1
+                && memcmp(header.magic, HIGHSCORE_MAGIC, sizeof(header.magic)) == 0 && header.version == HIGHSCORE_VERSION;
+        end = sizeof(header) + (size - long(sizeof(header))) / long(sizeof(HighScore)) * long(sizeof(HighScore));
+    }
+
+    ok = ok && fseek(file, end, SEEK_SET) == 0 && fwrite(batch.data(), sizeof(HighScore), batch.size(), file) == batch.size();
+
+    if (file != 0)
+    {
+        ok = (fclose(file) == 0) && ok;
+    }
+
+    if (!ok)
+    {
+        lock_guard<mutex> lock(c_lock); // Guards the flag
+
+        m_writeFailed = true;
+    }
+}
+
+/*** Helpers ***/
+
+/**
+ * @brief HighScores::keyOf Fetches the index key of a configuration.
+ * @param m_rows The # of rows.
+ * @param m_cols The # of columns.
+ * @param m_nColours The # of colours.
+ * @return The key.
+ */
+uint64_t HighScores::keyOf(uint32_t m_rows, uint32_t m_cols, uint32_t m_nColours)
+{
+    return (uint64_t(m_rows) << 40) | (uint64_t(m_cols) << 16) | m_nColours; // Sides fit in 24 bits, colours in 16
+}
+
+/**
+ * @brief HighScores::insert Adds a score to its configuration's table, after any equal scores so that older games keep their
+ * place, and drops the worst score if the table is full. c_lock must be held.
+ * @param m_score The score.
+ */
+void HighScores::insert(const HighScore& m_score)
+{
+    vector<HighScore>& table = c_index[keyOf(m_score.rows, m_score.cols, m_score.nColours)]; // The configuration's scores
+    size_t pos = table.size(); // Where the score goes
+
+    while (pos > 0 && table[pos-1].score < m_score.score) // Best first. Tables are small, so a linear search is fine.
+    {
+        pos--;
+    }
+
+    if (pos >= HIGHSCORE_KEEP) // Not good enough to keep
+    {
+        return;
+    }
+
+    table.insert(table.begin() + pos, m_score);
+
+    if (table.size() > HIGHSCORE_KEEP)
+    {
+        table.pop_back();
+    }
+}
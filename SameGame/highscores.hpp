@@ -0,0 +1,100 @@
+#ifndef HIGHSCORES_HPP
+#define HIGHSCORES_HPP
+
+/* C++ Headers */
+#include <condition_variable> // Waiting for the index
+#include <cstddef> // size_t
+#include <cstdint> // Fixed-size fields
+#include <map> // Index by configuration
+#include <mutex> // Guards the index
+#include <string> // STL strings
+#include <vector> // STL vectors
+
+/* My headers */
+#include "threadpool.hpp" // Background writer
+
+using namespace std;
+
+/*
+ * High score log. Every finished game appends one fixed-size record, and nothing is ever rewritten:
+ *
+ *   HighScoreFileHeader             8 bytes
+ *   HighScore records               32 bytes each, in the order the games finished
+ *
+ * A record torn by a crash is ignored when the log is read, and overwritten by the next append.
+ */
+
+#define HIGHSCORE_MAGIC "SGHS" // First 4 bytes of a high score log
+#define HIGHSCORE_VERSION 1 // Current version of the format
+#define HIGHSCORE_KEEP 100 // # of best scores kept in memory for each configuration
+
+/**
+ * @brief The HighScoreFileHeader struct. The start of a high score log.
+ */
+struct HighScoreFileHeader
+{
+    char magic[4]; // HIGHSCORE_MAGIC
+    uint32_t version; // HIGHSCORE_VERSION
+};
+
+/**
+ * @brief The HighScore struct. One finished game, as stored in the log.
+ */
+struct HighScore
+{
+    uint32_t rows; // # of rows
+    uint32_t cols; // # of columns
+    uint32_t nColours; // # of colours, excluding black
+    int32_t score; // Final score
+    uint64_t seed; // Seed the game was generated from
+    int64_t time; // When the game finished, in seconds since the epoch
+};
+
+/**
+ * @brief The HighScores class. A local high score table, kept in an append-only log. Doesn't depend on Qt.
+ *
+ * The log is read once, on a background thread, as soon as the table is created, into an index which keeps the best
+ * HIGHSCORE_KEEP scores of each configuration (board size and # of colours), best first. Scores are added to the index straight
+ * away, and appended to the log by the same background thread, so adding a score never waits on the disk. Queries only wait if
+ * the log hasn't finished loading yet. Can be used from any thread.
+ */
+class HighScores
+{
+    public:
+        /* Constructor/destructor */
+        explicit HighScores(const string& m_path); // Opens the log with the given path, creating it when the first score is added
+        ~HighScores(); // Waits for the queued writes to finish
+
+        /* Scores */
+        void add(const HighScore& m_score); // Records a finished game. Returns without waiting for the disk.
+        int top(int m_rows, int m_cols, int m_nColours, size_t m_n, vector<HighScore>& m_scores); // Fetches the n best scores of a configuration, best first
+        int rank(const HighScore& m_score); // Fetches a score's position in its configuration's table, from 1, or 0 if it isn't in the best HIGHSCORE_KEEP
+        void flush(); // Waits until every added score has been written
+
+        /* Status */
+        bool hasWriteFailed() const; // True if a score couldn't be written to the log
+
+    private:
+        HighScores(const HighScores&); // Not copyable
+        HighScores& operator=(const HighScores&);
+
+        /* Background work */
+        void load(); // Reads the log and builds the index
+        void writePending(); // Appends the queued scores to the log
+
+        /* Helpers */
+        static uint64_t keyOf(uint32_t m_rows, uint32_t m_cols, uint32_t m_nColours); // Fetches the index key of a configuration
+        void insert(const HighScore& m_score); // Adds a score to the index. c_lock must be held.
+
+        /* Data */
+        string m_path; // Path of the log
+        mutable mutex c_lock; // Guards everything below
+        condition_variable c_loaded; // Signalled once the index is built
+        bool m_loaded; // True once the index is built
+        bool m_writeFailed; // True once a write has failed
+        map<uint64_t, vector<HighScore>> c_index; // Best scores of each configuration, best first
+        vector<HighScore> c_pending; // Scores waiting to be written, oldest first
+        ThreadPool c_writer; // The background thread. Declared last, so that it stops before the rest is destroyed.
+};
+
+#endif // HIGHSCORES_HPP
@@ -0,0 +1,140 @@
+#include "mappedfile.hpp"
+
+/* OS headers */
+#ifdef _WIN32
+#include <windows.h> // CreateFileMapping(), MapViewOfFile()
+#else
+#include <fcntl.h> // open()
+#include <sys/mman.h> // mmap()
+#include <sys/stat.h> // fstat()
+#include <unistd.h> // close()
+#endif
+
+using namespace std; // To save some typing
+
+/*** Constructor/destructor ***/
+
+/**
+ * @brief MappedFile::MappedFile Constructor. Creates an object with no file mapped.
+ */
+MappedFile::MappedFile() :
+    m_data(0),
+    m_size(0),
+    m_open(false)
+{
+}
+
+/**
+ * @brief MappedFile::~MappedFile Destructor. Unmaps the file.
+ */
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+/*** Mapping ***/
+
+/**
+ * @brief MappedFile::open Maps a whole file read-only. The file's handle is closed straight away; the mapping keeps the file
+ * open until close().
+ * @param m_path The file's path.
+ * @return True if the file was mapped, false if it couldn't be opened or mapped.
+ */
+bool MappedFile::open(const string& m_path)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(m_path.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0); // The file
+    HANDLE mapping; // Its mapping
+    LARGE_INTEGER size; // Its size
+
+    if (file == INVALID_HANDLE_VALUE) // Couldn't open it
+    {
+        return false;
+    }
+
+    if (!GetFileSizeEx(file, &size) || uint64_t(size.QuadPart) > size_t(-1)) // Too big to map
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    m_size = size_t(size.QuadPart);
+
+    if (m_size > 0) // Empty files can't be mapped
+    {
+        mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+
+        if (mapping != 0)
+        {
+            m_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping); // The view keeps the mapping alive
+        }
+
+        if (m_data == 0) // Couldn't map it
+        {
+            CloseHandle(file);
+            m_size = 0;
+            return false;
+        }
+    }
+
+    CloseHandle(file); // The view keeps the file open
+#else
+    int fd = ::open(m_path.c_str(), O_RDONLY); // The file
+    struct stat st; // Its size
+    void* p; // Its mapping
+
+    if (fd < 0) // Couldn't open it
+    {
+        return false;
+    }
+
+    if (fstat(fd, &st) != 0 || uint64_t(st.st_size) > size_t(-1)) // Too big to map
+    {
+        ::close(fd);
+        return false;
+    }
+
+    m_size = size_t(st.st_size);
+
+    if (m_size > 0) // Empty files can't be mapped
+    {
+        p = mmap(0, m_size, PROT_READ, MAP_SHARED, fd, 0);
+
+        if (p == MAP_FAILED) // Couldn't map it
+        {
+            ::close(fd);
+            m_size = 0;
+            return false;
+        }
+
+        m_data = static_cast<const uint8_t*>(p);
+    }
+
+    ::close(fd); // The mapping keeps the file open
+#endif
+
+    m_open = true;
+    return true;
+}
+
+/**
+ * @brief MappedFile::close Unmaps the file, if one is mapped. Pointers into it become invalid.
+ */
+void MappedFile::close()
+{
+    if (m_data != 0)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+#else
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+    }
+
+    m_data = 0;
+    m_size = 0;
+    m_open = false;
+}
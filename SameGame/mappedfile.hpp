@@ -0,0 +1,41 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+/* C++ Headers */
+#include <cstddef> // size_t
+#include <cstdint> // uint8_t
+#include <string> // STL strings
+
+using namespace std;
+
+/**
+ * @brief The MappedFile class. A whole file mapped read-only into memory, with mmap() on POSIX systems and a file mapping on
+ * Windows. The pages are shared with the OS's file cache, so any number of threads can read the file without copying it and
+ * without locks. Doesn't depend on Qt, so that command-line tools can use it.
+ */
+class MappedFile
+{
+    public:
+        /* Constructor/destructor */
+        MappedFile(); // Creates an object with no file mapped
+        ~MappedFile(); // Unmaps the file, if one is mapped
+
+        /* Mapping */
+        bool open(const string& m_path); // Maps a file, replacing any mapped before. Returns false if it can't.
+        void close(); // Unmaps the file
+
+        /* Access */
+        bool isOpen() const { return m_open; } // True if a file is mapped
+        const uint8_t* data() const { return m_data; } // Fetches the file's first byte. 0 for an empty file.
+        size_t size() const { return m_size; } // Fetches the file's size in bytes
+
+    private:
+        MappedFile(const MappedFile&); // Not copyable
+        MappedFile& operator=(const MappedFile&);
+
+        const uint8_t* m_data; // The mapped bytes
+        size_t m_size; // # of bytes mapped
+        bool m_open; // True if a file is mapped
+};
+
+#endif // MAPPEDFILE_HPP
@@ -0,0 +1,9 @@
+# Game model: the headless engine plus Game. Game uses QColor, so this needs QtGui, but not QtWidgets.
+
+include(engine.pri)
+
+SOURCES += \
+    $$PWD/game.cpp
+
+HEADERS += \
+    $$PWD/game.hpp
@@ -0,0 +1,185 @@
+#include "movescan.hpp"
+
+/* Vector kernels are only built for x86 with GCC-compatible compilers, which let us enable AVX2 on a per-function basis */
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define MOVESCAN_X86
+#include <immintrin.h> // SSE2 and AVX2 intrinsics
+#endif
+
+/*** Scalar kernel ***/
+
+/**
+ * @brief scanForMoveScalar Scans for a legal move one cell at a time.
+ * @param m_cells The flat array of cells.
+ * @param m_begin Index of the first cell to check.
+ * @param m_end Index one past the last cell to check.
+ * @param m_stride Distance between a cell and the one below it.
+ * @return True if a cell in [begin, end) matches its right or lower neighbour, false otherwise.
+ */
+bool scanForMoveScalar(const Cell* m_cells, int m_begin, int m_end, int m_stride)
+{
+    int i; // Cell counter
+    Cell c; // Colour of the current cell
+
+    for (i = m_begin; i < m_end; i++) // Loop through the cells
+    {
+        c = m_cells[i];
+
+        if (c != BoardGrid::EMPTY && c != BoardGrid::BORDER && (c == m_cells[i+1] || c == m_cells[i+m_stride])) // Found a pair
+        {
+            return true;
+        }
+    }
+
+    return false; // No pairs
+}
+
+#ifdef MOVESCAN_X86
+
+/*** SSE2 kernel ***/
+
+/**
+ * @brief scanForMoveSSE2Impl Scans for a legal move 16 cells at a time. Each block of cells is compared with the same block
+ * shifted by one cell and by one row, and the matches are masked with the cells which are neither empty nor border.
+ */
+__attribute__((target("sse2")))
+static bool scanForMoveSSE2Impl(const Cell* m_cells, int m_begin, int m_end, int m_stride)
+{
+    const __m128i empty = _mm_set1_epi8((char)BoardGrid::EMPTY); // Empty cells, for masking
+    const __m128i border = _mm_set1_epi8((char)BoardGrid::BORDER); // Border cells, for masking
+    __m128i cur; // Current block of cells
+    __m128i pairs; // Cells which match their right or lower neighbour
+    __m128i ignored; // Cells which are empty or border
+    int i; // Cell counter
+
+    for (i = m_begin; i + 16 <= m_end; i += 16) // Loop through whole blocks
+    {
+        cur = _mm_loadu_si128((const __m128i*)(m_cells + i));
+        pairs = _mm_or_si128(_mm_cmpeq_epi8(cur, _mm_loadu_si128((const __m128i*)(m_cells + i + 1))), // Same as the cell to the right
+                             _mm_cmpeq_epi8(cur, _mm_loadu_si128((const __m128i*)(m_cells + i + m_stride)))); // Same as the cell below
+        ignored = _mm_or_si128(_mm_cmpeq_epi8(cur, empty), _mm_cmpeq_epi8(cur, border));
+
+        if (_mm_movemask_epi8(_mm_andnot_si128(ignored, pairs)) != 0) // Found a pair
+        {
+            return true;
+        }
+    }
+
+    return scanForMoveScalar(m_cells, i, m_end, m_stride); // Finish off the last partial block
+}
+
+/*** AVX2 kernel ***/
+
+/**
+ * @brief scanForMoveAVX2Impl Scans for a legal move 32 cells at a time. Same as the SSE2 kernel, with wider blocks.
+ */
+__attribute__((target("avx2")))
+static bool scanForMoveAVX2Impl(const Cell* m_cells, int m_begin, int m_end, int m_stride)
+{
+    const __m256i empty = _mm256_set1_epi8((char)BoardGrid::EMPTY); // Empty cells, for masking
+    const __m256i border = _mm256_set1_epi8((char)BoardGrid::BORDER); // Border cells, for masking
+    __m256i cur; // Current block of cells
+    __m256i pairs; // Cells which match their right or lower neighbour
+    __m256i ignored; // Cells which are empty or border
+    int i; // Cell counter
+
+    for (i = m_begin; i + 32 <= m_end; i += 32) // Loop through whole blocks
+    {
+        cur = _mm256_loadu_si256((const __m256i*)(m_cells + i));
+        pairs = _mm256_or_si256(_mm256_cmpeq_epi8(cur, _mm256_loadu_si256((const __m256i*)(m_cells + i + 1))), // Same as the cell to the right
+                                _mm256_cmpeq_epi8(cur, _mm256_loadu_si256((const __m256i*)(m_cells + i + m_stride)))); // Same as the cell below
+        ignored = _mm256_or_si256(_mm256_cmpeq_epi8(cur, empty), _mm256_cmpeq_epi8(cur, border));
+
+        if (_mm256_movemask_epi8(_mm256_andnot_si256(ignored, pairs)) != 0) // Found a pair
+        {
+            return true;
+        }
+    }
+
+    return scanForMoveScalar(m_cells, i, m_end, m_stride); // Finish off the last partial block. Calling the SSE2 kernel here would mix AVX and SSE code.
+}
+
+#endif // MOVESCAN_X86
+
+/*** Public kernels ***/
+
+/**
+ * @brief scanForMoveSSE2 Scans for a legal move 16 cells at a time, if the CPU supports SSE2.
+ * @return True if a cell in [begin, end) matches its right or lower neighbour, false otherwise.
+ */
+bool scanForMoveSSE2(const Cell* m_cells, int m_begin, int m_end, int m_stride)
+{
+#ifdef MOVESCAN_X86
+    if (__builtin_cpu_supports("sse2")) // Always true on x86-64, not on older 32-bit CPUs
+    {
+        return scanForMoveSSE2Impl(m_cells, m_begin, m_end, m_stride);
+    }
+#endif
+
+    return scanForMoveScalar(m_cells, m_begin, m_end, m_stride); // No SSE2
+}
+
+/**
+ * @brief scanForMoveAVX2 Scans for a legal move 32 cells at a time, if the CPU supports AVX2.
+ * @return True if a cell in [begin, end) matches its right or lower neighbour, false otherwise.
+ */
+bool scanForMoveAVX2(const Cell* m_cells, int m_begin, int m_end, int m_stride)
+{
+#ifdef MOVESCAN_X86
+    if (__builtin_cpu_supports("avx2")) // Only on newer CPUs
+    {
+        return scanForMoveAVX2Impl(m_cells, m_begin, m_end, m_stride);
+    }
+#endif
+
+    return scanForMoveSSE2(m_cells, m_begin, m_end, m_stride); // No AVX2
+}
+
+/**
+ * @brief scanForMove Scans for a legal move with the widest kernel which this CPU supports. The kernel is chosen once, on the
+ * first call.
+ * @return True if a cell in [begin, end) matches its right or lower neighbour, false otherwise.
+ */
+bool scanForMove(const Cell* m_cells, int m_begin, int m_end, int m_stride)
+{
+    typedef bool (*Kernel)(const Cell*, int, int, int); // A scan kernel
+    static const Kernel kernel = [] () -> Kernel // Pick the kernel (thread-safe, since C++11)
+    {
+#ifdef MOVESCAN_X86
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return scanForMoveAVX2Impl;
+        }
+
+        if (__builtin_cpu_supports("sse2"))
+        {
+            return scanForMoveSSE2Impl;
+        }
+#endif
+
+        return scanForMoveScalar;
+    }();
+
+    return kernel(m_cells, m_begin, m_end, m_stride);
+}
+
+/**
+ * @brief scanForMoveKernelName Fetches the name of the kernel which scanForMove() runs on this CPU.
+ * @return "avx2", "sse2" or "scalar".
+ */
+const char* scanForMoveKernelName()
+{
+#ifdef MOVESCAN_X86
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return "avx2";
+    }
+
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return "sse2";
+    }
+#endif
+
+    return "scalar";
+}
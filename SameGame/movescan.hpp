@@ -0,0 +1,20 @@
+#ifndef MOVESCAN_HPP
+#define MOVESCAN_HPP
+
+/* My headers */
+#include "boardgrid.hpp" // Cell type
+
+/*
+ * Kernels which scan a flat board for a legal move: a cell which has the same colour as its right or lower neighbour.
+ * Cells in [begin, end) are compared with the cell after them and with the cell a stride below them, so the array must be
+ * readable up to end + stride. Empty and border cells never count as a match, so the scan can run straight across the
+ * border cells at the ends of each row. Every kernel stops at the first match.
+ */
+
+bool scanForMove(const Cell* m_cells, int m_begin, int m_end, int m_stride); // Runs the fastest kernel supported by this CPU
+bool scanForMoveScalar(const Cell* m_cells, int m_begin, int m_end, int m_stride); // Portable kernel, one cell at a time
+bool scanForMoveSSE2(const Cell* m_cells, int m_begin, int m_end, int m_stride); // 16 cells at a time. Falls back to scalar when unavailable.
+bool scanForMoveAVX2(const Cell* m_cells, int m_begin, int m_end, int m_stride); // 32 cells at a time. Falls back to SSE2 when unavailable.
+const char* scanForMoveKernelName(); // Fetches the name of the kernel used by scanForMove()
+
+#endif // MOVESCAN_HPP
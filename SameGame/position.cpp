@@ -0,0 +1,265 @@
+#include "position.hpp"
+
+/* My headers */
+#include "zobrist.hpp" // Board hashing
+
+/* STL Headers */
+#include <algorithm> // fill(), min(), max()
+
+using namespace std; // To save some typing
+
+/*** Constructors ***/
+
+/**
+ * @brief Position::Position Constructor. Creates a position on an empty 0x0 board, with no points.
+ */
+Position::Position() :
+    m_score(0),
+    m_hash(0), // Empty boards hash to 0
+    m_stamp(0)
+{
+}
+
+/**
+ * @brief Position::Position Constructor. Creates a position on a copy of the given board.
+ * @param m_board The board.
+ * @param m_score The points already scored.
+ */
+Position::Position(const BoardGrid& m_board, int m_score) :
+    c_board(m_board),
+    m_score(m_score),
+    m_hash(zobristHash(m_board)),
+    m_stamp(0)
+{
+}
+
+/*** Copying ***/
+
+/**
+ * @brief Position::assign Copies another position's board and score. The scratch buffers aren't copied, and once both
+ * positions have the same board size, no memory is allocated.
+ * @param m_other The position to copy.
+ */
+void Position::assign(const Position& m_other)
+{
+    c_board = m_other.c_board; // Reuses our cell array if it is big enough
+    m_score = m_other.m_score;
+    m_hash = m_other.m_hash;
+}
+
+/*** Moves ***/
+
+/**
+ * @brief Position::play Plays a move. Uses the same rules and scoring as Game::removeBlock(). The board's hash is updated from
+ * the cells which the move changed.
+ * @param m_move The move.
+ * @return The # of blocks removed, or 0 if the move isn't on the board, is on an empty cell, or is on a single block.
+ */
+int Position::play(const Move& m_move)
+{
+    int start; // Index of the clicked block
+    Cell colour; // Colour of the clicked group
+    int n; // # of blocks removed
+    int lo = c_board.getCols(); // Leftmost column which lost blocks
+    int hi = -1; // Rightmost column which lost blocks
+    int x; // Column of a removed block
+
+    if (!c_board.inBounds(m_move.x, m_move.y)) // Not on the board
+    {
+        return 0;
+    }
+
+    start = c_board.index(m_move.x, m_move.y);
+    colour = c_board.cell(start);
+
+    if (colour == BoardGrid::EMPTY // Nothing to remove
+        || (c_board.cell(start-1) != colour && c_board.cell(start+1) != colour // Single block. The border never matches.
+            && c_board.cell(start-c_board.getStride()) != colour && c_board.cell(start+c_board.getStride()) != colour))
+    {
+        return 0;
+    }
+
+    n = c_board.floodRemove(start, c_work, c_removed, BoardGrid::REMOVED); // Mark the group for compact()
+
+    for (vector<int>::const_iterator it = c_removed.begin(); it != c_removed.end(); it++) // Find the columns which lost blocks
+    {
+        x = c_board.xOf(*it);
+        lo = min(lo, x);
+        hi = max(hi, x);
+    }
+
+    c_board.compact(lo, hi, colour, c_changes, c_column); // Let the blocks fall and drop empty columns
+    m_hash = zobristUpdate(m_hash, c_changes);
+    m_score += (n*(n+1))/2; // Same scoring as Game
+    return n;
+}
+
+/**
+ * @brief Position::play Plays a move and records the cells it changed on an undo stack, so that it can be unmade with undo()
+ * instead of copying the position before it.
+ * @param m_move The move.
+ * @param m_undo The stack. Nothing is recorded if the move isn't legal.
+ * @return The # of blocks removed, or 0 if the move wasn't legal.
+ */
+int Position::play(const Move& m_move, UndoStack& m_undo)
+{
+    int n = play(m_move); // # of blocks removed
+
+    if (n > 0) // c_changes holds the move's changes
+    {
+        m_undo.push(c_changes, (n*(n+1))/2, c_board.index(m_move.x, m_move.y));
+    }
+
+    return n;
+}
+
+/**
+ * @brief Position::undo Unmakes the last move recorded on an undo stack, restoring the board, the score and the hash.
+ * @param m_undo The stack, which must only hold moves played on this position.
+ * @return False if there was no move to undo.
+ */
+bool Position::undo(UndoStack& m_undo)
+{
+    const UndoStep* step = m_undo.undo(c_board); // The move
+
+    if (step == 0) // Nothing to undo
+    {
+        return false;
+    }
+
+    m_score -= step->points;
+    m_hash ^= step->hashDelta;
+    return true;
+}
+
+/**
+ * @brief Position::redo Remakes the last move undone on an undo stack.
+ * @param m_undo The stack, which must only hold moves played on this position.
+ * @return False if there was no move to redo.
+ */
+bool Position::redo(UndoStack& m_undo)
+{
+    const UndoStep* step = m_undo.redo(c_board); // The move
+
+    if (step == 0) // Nothing to redo
+    {
+        return false;
+    }
+
+    m_score += step->points;
+    m_hash ^= step->hashDelta;
+    return true;
+}
+
+/**
+ * @brief Position::legalMoves Lists every legal move, as the first block of each group with at least 2 blocks, scanning rows
+ * from the bottom up. Blocks always rest on the bottom row and on the left, so the scan only covers the columns which are
+ * occupied on the bottom row, and stops at the first empty row. Every occupied cell is visited once: cells are stamped as they
+ * are reached, so no flag array has to be cleared between calls.
+ * @param m_moves Receives the moves. Its previous contents are discarded.
+ * @return The # of legal moves.
+ */
+int Position::legalMoves(vector<Move>& m_moves)
+{
+    const Cell* cells = c_board.data(); // Cells of the board, for quicker access
+    int stride = c_board.getStride(); // Distance to the cell below
+    int offsets[4] = { -1, 1, -stride, stride }; // Offsets to the left, right, upper and lower neighbours
+    int width = 0; // # of occupied columns
+    int x; // Column counter
+    int y; // Row counter
+    int i; // Index of the current cell
+    int j; // Index of a cell popped off the work stack
+    int nb; // Index of a neighbour
+    int k; // Neighbour counter
+    bool rowEmpty; // True while no block has been found on the current row
+    Cell colour; // Colour of the current group
+    unsigned* seen; // Stamps, for quicker access
+    Move move; // Move being recorded
+
+    m_moves.clear();
+
+    if (c_seen.size() != size_t((c_board.getRows()+2) * stride)) // Board size changed
+    {
+        c_seen.assign((c_board.getRows()+2) * stride, 0);
+        m_stamp = 0;
+    }
+
+    if (++m_stamp == 0) // Stamps wrapped around, so old stamps could be mistaken for new ones
+    {
+        fill(c_seen.begin(), c_seen.end(), 0);
+        m_stamp = 1;
+    }
+
+    seen = c_seen.data();
+
+    if (c_board.getRows() > 0) // Count the occupied columns. The border stops the loop.
+    {
+        for (i = c_board.index(0, c_board.getRows()-1); cells[i] != BoardGrid::EMPTY && cells[i] != BoardGrid::BORDER; i++)
+        {
+            width++;
+        }
+    }
+
+    for (y = c_board.getRows()-1; y >= 0; y--) // Loop through the rows, from the bottom up
+    {
+        rowEmpty = true;
+        i = c_board.index(0, y);
+
+        for (x = 0; x < width; x++, i++) // Loop through the occupied columns
+        {
+            colour = cells[i];
+
+            if (colour == BoardGrid::EMPTY) // Nothing here
+            {
+                continue;
+            }
+
+            rowEmpty = false;
+
+            if (seen[i] == m_stamp) // Part of a group which was already found
+            {
+                continue;
+            }
+
+            seen[i] = m_stamp;
+
+            /* The cells to the left and below have been visited, so only the right and upper neighbours can start a group */
+            if (cells[i+1] != colour && cells[i-stride] != colour) // Single block. The border never matches.
+            {
+                continue;
+            }
+
+            move.x = x;
+            move.y = y;
+            m_moves.push_back(move);
+
+            /* Stamp the rest of the group so that it isn't listed again */
+            c_work.clear();
+            c_work.push_back(i);
+
+            while (!c_work.empty())
+            {
+                j = c_work.back();
+                c_work.pop_back();
+
+                for (k = 0; k < 4; k++) // Check each neighbour. The border never matches.
+                {
+                    nb = j + offsets[k];
+
+                    if (cells[nb] == colour && seen[nb] != m_stamp) // Same group, not visited yet
+                    {
+                        seen[nb] = m_stamp;
+                        c_work.push_back(nb);
+                    }
+                }
+            }
+        }
+
+        if (rowEmpty) // Blocks rest on the ones below, so every row above is empty too
+        {
+            break;
+        }
+    }
+
+    return m_moves.size();
+}
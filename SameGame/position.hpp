@@ -0,0 +1,66 @@
+#ifndef POSITION_HPP
+#define POSITION_HPP
+
+/* C++ Headers */
+#include <cstdint> // uint64_t
+#include <vector> // STL vectors
+
+/* My headers */
+#include "boardgrid.hpp" // Board
+#include "undostack.hpp" // Unmaking moves
+
+using namespace std;
+
+/**
+ * @brief The Move struct. A move: a click on the block at (x, y), which removes that block's group.
+ */
+struct Move
+{
+    int x; // Column of the clicked block
+    int y; // Row of the clicked block
+};
+
+/**
+ * @brief The Position class. A board and the score reached on it, with the same rules as Game: clicking a group of 2 or more
+ * blocks removes it and scores n(n+1)/2 points for n blocks, then the blocks fall down and empty columns are dropped. Unlike
+ * Game, it doesn't depend on Qt and keeps no change set or group index, so it is cheap to copy and play out in search code.
+ */
+class Position
+{
+    public:
+        /* Constructors */
+        Position(); // Creates a position on an empty 0x0 board
+        explicit Position(const BoardGrid& m_board, int m_score = 0); // Creates a position on a copy of the given board
+
+        /* Copying */
+        void assign(const Position& m_other); // Copies another position's board and score, but not its scratch buffers
+
+        /* Queries */
+        const BoardGrid& getBoard() const { return c_board; } // Fetches the board
+        int getScore() const { return m_score; } // Fetches the points scored so far
+        uint64_t getHash() const { return m_hash; } // Fetches the Zobrist hash of the board
+        bool isOver() const { return !c_board.hasMoves(); } // True if no legal move is left
+
+        /* Moves */
+        int play(const Move& m_move); // Plays a move and returns the # of blocks removed, or 0 if the move wasn't legal
+        int play(const Move& m_move, UndoStack& m_undo); // Plays a move and records it on an undo stack
+        bool undo(UndoStack& m_undo); // Unmakes the last move recorded on an undo stack. Returns false if there is none.
+        bool redo(UndoStack& m_undo); // Remakes the last move undone on an undo stack. Returns false if there is none.
+        int legalMoves(vector<Move>& m_moves); // Lists one block of each group which can be removed, and returns how many there are
+
+    private:
+        /* Data */
+        BoardGrid c_board; // The board
+        int m_score; // Points scored so far
+        uint64_t m_hash; // Zobrist hash of the board, kept up to date by play()
+
+        /* Scratch buffers. Kept between moves so that their memory is reused. */
+        vector<int> c_work; // Work stack for flood fills
+        vector<int> c_removed; // Cells removed by the last move
+        vector<CellChange> c_changes; // Cells changed by the last compaction. Used to update the hash.
+        vector<Cell> c_column; // Column buffer for compaction
+        vector<unsigned> c_seen; // Stamp of the last legalMoves() call which visited each cell
+        unsigned m_stamp; // Stamp of the current legalMoves() call
+};
+
+#endif // POSITION_HPP
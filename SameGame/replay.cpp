@@ -0,0 +1,331 @@
+#include "replay.hpp"
+
+/* My headers */
+#include "boardgenerator.hpp" // Starting boards
+#include "rng.hpp" // Seeded generators
+#include "threadpool.hpp" // Workers
+
+/* STL Headers */
+#include <algorithm> // min()
+#include <cstdio> // fopen()
+
+using namespace std; // To save some typing
+
+/* Defines */
+#define REPLAY_MAX_SIDE 99 // Largest # of rows or columns a replay may claim: the most the New Game dialog allows
+#define REPLAY_MAX_COLOURS 253 // Largest # of colours which fit in a cell, below BoardGrid::REMOVED
+#define REPLAY_CHUNK 256 // # of replays verified by one task
+
+/*** Varints ***/
+
+/**
+ * @brief putVarint Appends an unsigned LEB128 varint: 7 bits per byte, lowest first, with the top bit set on every byte but the
+ * last.
+ * @param m_value The value.
+ * @param m_out The buffer.
+ */
+static void putVarint(uint64_t m_value, vector<uint8_t>& m_out)
+{
+    while (m_value >= 0x80)
+    {
+        m_out.push_back(uint8_t(m_value) | 0x80);
+        m_value >>= 7;
+    }
+
+    m_out.push_back(uint8_t(m_value));
+}
+
+/**
+ * @brief getVarint Reads an unsigned LEB128 varint.
+ * @param m_in The next byte to read. Advanced past the varint.
+ * @param m_end One past the last byte which may be read.
+ * @param m_value Receives the value.
+ * @return False if the varint runs past the end, or is longer than 64 bits.
+ */
+static bool getVarint(const uint8_t*& m_in, const uint8_t* m_end, uint64_t& m_value)
+{
+    int shift; // Position of the next 7 bits
+
+    m_value = 0;
+
+    for (shift = 0; shift < 64 && m_in < m_end; shift += 7)
+    {
+        m_value |= uint64_t(*m_in & 0x7F) << shift;
+
+        if ((*m_in++ & 0x80) == 0) // Last byte
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*** Logs ***/
+
+/**
+ * @brief replayEncode Appends a replay's log to a buffer. Moves are stored as cell numbers y * cols + x, so they must be on the
+ * board.
+ * @param m_replay The replay.
+ * @param m_out The buffer.
+ */
+void replayEncode(const Replay& m_replay, vector<uint8_t>& m_out)
+{
+    size_t i; // Move counter
+
+    putVarint(REPLAY_VERSION, m_out);
+    putVarint(uint64_t(m_replay.rows), m_out);
+    putVarint(uint64_t(m_replay.cols), m_out);
+    putVarint(uint64_t(m_replay.nColours), m_out);
+    putVarint(m_replay.seed, m_out);
+    putVarint(uint64_t(m_replay.score), m_out);
+    putVarint(m_replay.moves.size(), m_out);
+
+    for (i = 0; i < m_replay.moves.size(); i++)
+    {
+        putVarint(uint64_t(m_replay.moves[i].y) * m_replay.cols + m_replay.moves[i].x, m_out);
+    }
+}
+
+/**
+ * @brief replayDecode Reads a replay's log. The size, # of colours and # of moves are checked before anything is allocated. The
+ * moves can't outnumber the log's bytes, and the board is no bigger than a game can be, so a corrupt or hostile log costs at most
+ * a 99x99 board to verify, however short it is.
+ * @param m_in The log's first byte.
+ * @param m_size The # of bytes available. The log may be followed by other data.
+ * @param m_replay Receives the replay.
+ * @return The # of bytes the log took, or 0 if it is truncated, from another version, or describes an impossible game.
+ */
+size_t replayDecode(const uint8_t* m_in, size_t m_size, Replay& m_replay)
+{
+    const uint8_t* p = m_in; // Next byte to read
+    const uint8_t* end = m_in + m_size; // One past the last byte
+    uint64_t version, rows, cols, nColours, seed, score, nMoves; // Header fields
+    uint64_t cell; // A move's cell number
+    uint64_t i; // Move counter
+
+    if (!getVarint(p, end, version) || version != REPLAY_VERSION
+            || !getVarint(p, end, rows) || !getVarint(p, end, cols) || !getVarint(p, end, nColours)
+            || !getVarint(p, end, seed) || !getVarint(p, end, score) || !getVarint(p, end, nMoves)) // Bad header
+    {
+        return 0;
+    }
+
+    if (rows < 1 || rows > REPLAY_MAX_SIDE || cols < 1 || cols > REPLAY_MAX_SIDE || nColours < 1 || nColours > REPLAY_MAX_COLOURS
+            || score > uint64_t(INT32_MAX) || nMoves > rows * cols / 2 || nMoves > uint64_t(end - p)) // Every move removes 2 or more blocks, and takes 1 or more bytes
+    {
+        return 0;
+    }
+
+    m_replay.rows = int(rows);
+    m_replay.cols = int(cols);
+    m_replay.nColours = int(nColours);
+    m_replay.seed = seed;
+    m_replay.score = int(score);
+    m_replay.moves.resize(nMoves);
+
+    for (i = 0; i < nMoves; i++)
+    {
+        if (!getVarint(p, end, cell) || cell >= rows * cols) // Truncated, or off the board
+        {
+            return 0;
+        }
+
+        m_replay.moves[i].x = int(cell % cols);
+        m_replay.moves[i].y = int(cell / cols);
+    }
+
+    return p - m_in;
+}
+
+/*** Verification ***/
+
+/**
+ * @brief verifyOn Verifies a replay, reusing a board for its starting position.
+ * @param m_replay The replay.
+ * @param m_board Scratch board.
+ * @return The outcome.
+ */
+static ReplayCheck verifyOn(const Replay& m_replay, BoardGrid& m_board)
+{
+    ReplayCheck check; // Result
+    Rng rng(m_replay.seed); // Same generator as the game's
+    Position position; // Replayed game. Same rules and scoring as Game.
+    size_t i; // Move counter
+    int n; // # of blocks removed by a move
+
+    check.status = ReplayCheck::BAD_REPLAY;
+    check.score = 0;
+    check.movesPlayed = 0;
+    check.finished = false;
+
+    if (m_replay.rows < 1 || m_replay.rows > REPLAY_MAX_SIDE || m_replay.cols < 1 || m_replay.cols > REPLAY_MAX_SIDE
+            || m_replay.nColours < 1 || m_replay.nColours > REPLAY_MAX_COLOURS) // No such game
+    {
+        return check;
+    }
+
+    m_board.resize(m_replay.rows, m_replay.cols);
+    BoardGenerator::skipColours(rng, m_replay.nColours);
+    BoardGenerator::fill(rng, m_replay.nColours, m_board.data() + m_board.index(0, 0), m_replay.rows, m_replay.cols, m_board.getStride());
+
+    position = Position(m_board);
+
+    for (i = 0; i < m_replay.moves.size(); i++)
+    {
+        n = position.play(m_replay.moves[i]);
+
+        if (n == 0) // Game would have ignored the click, so the replay wasn't played on this board
+        {
+            check.status = ReplayCheck::ILLEGAL_MOVE;
+            check.score = position.getScore();
+            return check;
+        }
+
+        check.movesPlayed++;
+    }
+
+    check.score = position.getScore();
+    check.finished = position.isOver();
+    check.status = (check.score == m_replay.score) ? ReplayCheck::VALID : ReplayCheck::WRONG_SCORE;
+    return check;
+}
+
+/**
+ * @brief replayVerify Rebuilds a replay's starting board from its seed, exactly as Game generates it, then plays its moves with
+ * Game's rules and checks that they are all legal and reach the claimed score.
+ * @param m_replay The replay.
+ * @return The outcome.
+ */
+ReplayCheck replayVerify(const Replay& m_replay)
+{
+    BoardGrid board; // Starting board
+
+    return verifyOn(m_replay, board);
+}
+
+/**
+ * @brief replayVerifyAll Verifies many replays on a ThreadPool. Replays are verified in chunks, and each task reuses one board
+ * for its whole chunk, so small games don't spend their time allocating.
+ * @param m_replays The replays.
+ * @param m_checks Receives the outcome of each replay, in the same order.
+ * @param m_nThreads The # of threads to verify on, or 0 for one per core.
+ */
+void replayVerifyAll(const vector<Replay>& m_replays, vector<ReplayCheck>& m_checks, int m_nThreads)
+{
+    ThreadPool pool(m_nThreads); // Workers
+    size_t lo; // First replay of a chunk
+
+    m_checks.resize(m_replays.size());
+
+    for (lo = 0; lo < m_replays.size(); lo += REPLAY_CHUNK) // Queue the chunks
+    {
+        size_t hi = min(m_replays.size(), lo + REPLAY_CHUNK); // One past the last replay of the chunk
+
+        pool.submit([&m_replays, &m_checks, lo, hi] ()
+        {
+            BoardGrid board; // Reused for the whole chunk
+            size_t i; // Replay counter
+
+            for (i = lo; i < hi; i++)
+            {
+                m_checks[i] = verifyOn(m_replays[i], board);
+            }
+        });
+    }
+
+    pool.wait();
+}
+
+/*** Replay files ***/
+
+/**
+ * @brief ReplayFile::ReplayFile Constructor. Nothing is read or written until the first replay is added.
+ * @param m_path The file's path, in the encoding which the C library's file functions expect.
+ */
+ReplayFile::ReplayFile(const string& m_path) :
+    m_path(m_path),
+    m_writeFailed(false),
+    c_writer(1) // One thread, so the file is only ever touched by one writer
+{
+}
+
+/**
+ * @brief ReplayFile::~ReplayFile Destructor. Waits for the queued replays to be written.
+ */
+ReplayFile::~ReplayFile()
+{
+    c_writer.wait();
+}
+
+/**
+ * @brief ReplayFile::add Queues a replay to be appended to the file on the background thread. It is encoded here, so the
+ * caller's replay can change as soon as this returns.
+ * @param m_replay The replay.
+ */
+void ReplayFile::add(const Replay& m_replay)
+{
+    {
+        lock_guard<mutex> lock(c_lock); // Guards the queue
+
+        replayEncode(m_replay, c_pending);
+    }
+
+    c_writer.submit([this] () { writePending(); });
+}
+
+/**
+ * @brief ReplayFile::flush Waits until every added replay has been written.
+ */
+void ReplayFile::flush()
+{
+    c_writer.wait();
+}
+
+/**
+ * @brief ReplayFile::hasWriteFailed Determines if any replay couldn't be written to the file.
+ * @return True if a write has failed.
+ */
+bool ReplayFile::hasWriteFailed() const
+{
+    lock_guard<mutex> lock(c_lock); // Guards the flag
+
+    return m_writeFailed;
+}
+
+/**
+ * @brief ReplayFile::writePending Appends every queued replay to the file, creating it if needed, with one write. Logs need no
+ * framing, so appending is all there is to it.
+ */
+void ReplayFile::writePending()
+{
+    vector<uint8_t> batch; // Logs to write
+    FILE* file; // The file
+    bool ok; // True if the logs were written
+
+    {
+        lock_guard<mutex> lock(c_lock); // Guards the queue
+
+        batch.swap(c_pending);
+    }
+
+    if (batch.empty()) // An earlier call wrote them
+    {
+        return;
+    }
+
+    file = fopen(m_path.c_str(), "ab");
+    ok = file != 0 && fwrite(batch.data(), 1, batch.size(), file) == batch.size();
+
+    if (file != 0)
+    {
+        ok = (fclose(file) == 0) && ok;
+    }
+
+    if (!ok)
+    {
+        lock_guard<mutex> lock(c_lock); // Guards the flag
+
+        m_writeFailed = true;
+    }
+}
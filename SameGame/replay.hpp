@@ -0,0 +1,106 @@
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+/* C++ Headers */
+#include <cstddef> // size_t
+#include <cstdint> // uint8_t, uint64_t
+#include <mutex> // Guards the write queue
+#include <string> // File paths
+#include <vector> // STL vectors
+
+/* My headers */
+#include "position.hpp" // Moves and rules
+#include "threadpool.hpp" // Background writer
+
+using namespace std;
+
+/*
+ * Replays. A game is fully described by its size, # of colours and seed, which rebuild the starting board, and the moves played
+ * on it. A replay log stores exactly that, plus the score it claims, as a string of unsigned LEB128 varints:
+ *
+ *   version, rows, cols, nColours, seed, score, # of moves, then each move as y * cols + x
+ *
+ * Moves on boards up to 128 cells take 1 byte each, and up to 16384 cells 2 bytes each, so a whole game usually fits in a few
+ * hundred bytes. A replay file is any number of logs back to back: each log's fields give its length, so they need no framing.
+ */
+
+#define REPLAY_VERSION 1 // Current version of the log format
+
+/**
+ * @brief The Replay struct. A game's seed and moves, and the score claimed for them.
+ */
+struct Replay
+{
+    int rows; // # of rows
+    int cols; // # of columns
+    int nColours; // # of colours, excluding black
+    uint64_t seed; // Seed the starting board was generated from
+    int score; // Score claimed for the moves
+    vector<Move> moves; // The moves, in the order they were played
+};
+
+/**
+ * @brief The ReplayCheck struct. The outcome of verifying a replay.
+ */
+struct ReplayCheck
+{
+    /**
+     * @brief The Status enum. Whether the replay was valid, or why not.
+     */
+    enum Status
+    {
+        VALID, // Every move was legal and the claimed score was reached
+        ILLEGAL_MOVE, // A move was off the board, on an empty cell or on a single block
+        WRONG_SCORE, // The moves are legal, but score something else
+        BAD_REPLAY // The replay's size or # of colours is invalid
+    };
+
+    Status status; // The outcome
+    int score; // Score actually reached, up to the first illegal move
+    int movesPlayed; // # of legal moves played before stopping
+    bool finished; // True if no legal move was left after the last move
+};
+
+/* Logs */
+void replayEncode(const Replay& m_replay, vector<uint8_t>& m_out); // Appends a replay's log to a buffer
+size_t replayDecode(const uint8_t* m_in, size_t m_size, Replay& m_replay); // Reads a replay's log. Returns the # of bytes read, or 0 if the log is invalid.
+
+/* Verification */
+ReplayCheck replayVerify(const Replay& m_replay); // Rebuilds a replay's board from its seed and replays its moves
+void replayVerifyAll(const vector<Replay>& m_replays, vector<ReplayCheck>& m_checks, int m_nThreads = 0); // Verifies many replays, on the given # of threads, or one per core if 0
+
+/**
+ * @brief The ReplayFile class. A replay file which finished games are appended to. Replays are encoded straight away, and
+ * written by a background thread, like HighScores does with scores, so adding one never waits on the disk. Can be used from
+ * any thread.
+ */
+class ReplayFile
+{
+    public:
+        /* Constructor/destructor */
+        explicit ReplayFile(const string& m_path); // Opens the file with the given path, creating it when the first replay is added
+        ~ReplayFile(); // Waits for the queued writes to finish
+
+        /* Replays */
+        void add(const Replay& m_replay); // Queues a replay to be appended. Returns without waiting for the disk.
+        void flush(); // Waits until every added replay has been written
+
+        /* Status */
+        bool hasWriteFailed() const; // True if a replay couldn't be written to the file
+
+    private:
+        ReplayFile(const ReplayFile&); // Not copyable
+        ReplayFile& operator=(const ReplayFile&);
+
+        /* Background work */
+        void writePending(); // Appends the queued replays to the file
+
+        /* Data */
+        string m_path; // Path of the file
+        mutable mutex c_lock; // Guards everything below
+        bool m_writeFailed; // True once a write has failed
+        vector<uint8_t> c_pending; // Logs of the replays waiting to be written, oldest first
+        ThreadPool c_writer; // The background thread. Declared last, so that it stops before the rest is destroyed.
+};
+
+#endif // REPLAY_HPP
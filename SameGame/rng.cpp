@@ -0,0 +1,23 @@
+#include "rng.hpp"
+
+using namespace std; // To save some typing
+
+/**
+ * @brief Rng::seed Restarts the generator. The four state words are the first four outputs of splitmix64 started at the seed,
+ * which spreads even small or similar seeds over the whole state, and is never all 0.
+ * @param m_seed The seed. Any value, including 0, is fine.
+ */
+void Rng::seed(uint64_t m_seed)
+{
+    uint64_t z; // splitmix64 output
+    int i; // State word counter
+
+    for (i = 0; i < 4; i++)
+    {
+        m_seed += 0x9E3779B97F4A7C15ULL;
+        z = m_seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        c_state[i] = z ^ (z >> 31);
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef RNG_HPP
+#define RNG_HPP
+
+/* C++ Headers */
+#include <cstdint> // uint64_t, uint32_t
+
+using namespace std;
+
+/**
+ * @brief The Rng class. A small, fast pseudo-random number generator (xoshiro256**), seeded from a single 64-bit number with
+ * splitmix64. The same seed always gives the same numbers, on every platform. Each object has its own state, so generators on
+ * different threads never share anything.
+ *
+ * Bounded numbers come from Lemire's multiply-and-reject method, which is unbiased and needs a division only in the rare case
+ * that a number is rejected.
+ */
+class Rng
+{
+    public:
+        /* Constructor */
+        explicit Rng(uint64_t m_seed = 0) { seed(m_seed); } // Creates a generator from a seed
+
+        /* Seeding */
+        void seed(uint64_t m_seed); // Restarts the generator from a seed
+
+        /* Numbers */
+        uint64_t next(); // Fetches the next 64-bit number
+        uint32_t below(uint32_t m_bound); // Fetches a number in [0, bound)
+        int inRange(int m_lo, int m_hi); // Fetches a number in [lo, hi]
+
+    private:
+        static uint64_t rotl(uint64_t m_x, int m_k) { return (m_x << m_k) | (m_x >> (64 - m_k)); } // Rotates left by k bits
+
+        uint64_t c_state[4]; // Generator state. Never all 0.
+};
+
+/**
+ * @brief Rng::next Fetches the next number.
+ * @return A uniformly-distributed 64-bit number.
+ */
+inline uint64_t Rng::next()
+{
+    uint64_t result = rotl(c_state[1] * 5, 7) * 9; // Scrambled output
+    uint64_t t = c_state[1] << 17; // Part of the state update
+
+    c_state[2] ^= c_state[0];
+    c_state[3] ^= c_state[1];
+    c_state[1] ^= c_state[2];
+    c_state[0] ^= c_state[3];
+    c_state[2] ^= t;
+    c_state[3] = rotl(c_state[3], 45);
+    return result;
+}
+
+/**
+ * @brief Rng::below Fetches a uniformly-distributed number below a bound. The top 32 bits of a number are multiplied by the
+ * bound, and the high half of the product is the result; products whose low half falls in the biased zone are rejected.
+ * @param m_bound The bound. Must be at least 1.
+ * @return A number in [0, bound).
+ */
+inline uint32_t Rng::below(uint32_t m_bound)
+{
+    uint64_t m = uint64_t(uint32_t(next() >> 32)) * m_bound; // Scaled number
+    uint32_t low = uint32_t(m); // Fraction left over by the scaling
+    uint32_t threshold; // Smallest fraction which isn't biased
+
+    if (low < m_bound) // Might be in the biased zone
+    {
+        threshold = uint32_t(-m_bound) % m_bound; // 2^32 mod bound
+
+        while (low < threshold) // Biased, try again
+        {
+            m = uint64_t(uint32_t(next() >> 32)) * m_bound;
+            low = uint32_t(m);
+        }
+    }
+
+    return uint32_t(m >> 32);
+}
+
+/**
+ * @brief Rng::inRange Fetches a uniformly-distributed number in a range.
+ * @param m_lo The smallest number to return.
+ * @param m_hi The largest number to return. If it is below lo, lo is returned.
+ * @return A number in [lo, hi].
+ */
+inline int Rng::inRange(int m_lo, int m_hi)
+{
+    return (m_hi <= m_lo) ? m_lo : m_lo + int(below(uint32_t(m_hi - m_lo) + 1));
+}
+
+#endif // RNG_HPP
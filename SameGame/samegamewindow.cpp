@@ -8,13 +8,44 @@
 #include <QMessageBox> // Message box
 #include <QEvent> // For events
 #include <QMouseEvent> // For mouse events
+#include <QtConcurrent> // QtConcurrent::run()
+#include <QThread> // idealThreadCount()
+#include <QDateTime> // Seeds for new games
+#include <QFileDialog> // Choosing files to save and load
+#include <QStandardPaths> // Where to keep the high scores
+#include <QDir> // Creating the high score folder
+#include <QFile> // File name encoding
 
 /* STL includes */
 #include <utility> // pair
+#include <vector> // vector
+#include <algorithm> // max()
+#include <exception> // Load errors
+#include <string> // High score path
 
 /* Debugging */
 #include <QDebug> // qDebug()
 
+/* Defines */
+#define HINT_TIME_MS 1500 // How long a hint search may run for
+#define SAVE_FILTER "SameGame saves (*.sgs);;All files (*)" // File types shown when saving and loading
+#define HIGHSCORE_FILE "highscores.sgh" // Name of the high score log, in the user's data folder
+#define REPLAY_FILE "replays.sgr" // Name of the replay file, in the user's data folder
+#define HIGHSCORE_SHOWN 10 // # of high scores shown for a configuration
+
+/**
+ * @brief dataPath Finds the path of a file in the user's data folder, and creates the folder if it doesn't exist.
+ * @param m_name The file's name.
+ * @return The path, in the encoding which the C library's file functions expect.
+ */
+static string dataPath(const char* m_name)
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation); // Per-user data folder
+
+    QDir().mkpath(dir);
+    return QFile::encodeName(QDir(dir).filePath(m_name)).toStdString();
+}
+
 /**
  * @brief SameGameWindow::SameGameWindow Constructor. Sets up BoardView and game.
  * @param parent The parent of this widget (none, because it's a main window)
@@ -27,10 +58,14 @@ SameGameWindow::SameGameWindow(QWidget *parent) :
     e_curStat(WSTART), // Start in start state
     m_uMaxRow(5), // Start with x rows
     m_uMaxCol(5), // Start with x columns
-    m_nColours(4) // Start with 4 colours
+    m_nColours(4), // Start with 4 colours
+    m_hintHash(0), // No hint requested yet
+    c_scores(dataPath(HIGHSCORE_FILE)), // Starts loading the high scores in the background
+    c_replays(dataPath(REPLAY_FILE))
 {
     c_view->setupUi(this); // Setup UI
     c_view->centralWidget->installEventFilter(this); // We will catch and handle the board's events
+    connect(&c_hintWatcher, SIGNAL(finished()), this, SLOT(hintReady())); // Show hints when their searches finish
 }
 
 /**
@@ -38,6 +73,9 @@ SameGameWindow::SameGameWindow(QWidget *parent) :
  */
 SameGameWindow::~SameGameWindow()
 {
+    cancelHint(); // Stop the hint search
+    c_hintWatcher.waitForFinished(); // It reads nothing of ours, but shouldn't outlive the application
+
     /* Delete our objects */
     if (c_model != 0) // Check if model is allocated (MAKE SURE TO SET IT TO NULL AFTER DELETION)
     {
@@ -60,6 +98,7 @@ void SameGameWindow::on_actionNew_Game_triggered()
     /* Determine what to do based on current state */
     if (e_curStat == IGAM || e_curStat == GEND) // Click during or at the end of a game requires same handling
     {
+        cancelHint(); // The hint is for the old game
         c_view->centralWidget->reset(); // Reset the board view to display only black
 
         /* Delete model if necessary */
@@ -81,13 +120,125 @@ void SameGameWindow::on_actionNew_Game_triggered()
         m_uMaxCol = c_ngdiag->getNumCols(); // Store the # of columns chosen by the user
         m_nColours = c_ngdiag->getNumColours(); // Store the # of colours chosen by the user
 
-        c_view->centralWidget->setBoardSize(m_uMaxRow, m_uMaxCol); // Tell view to resize itself to m_uMaxRow x m_uMaxCol
-        c_model = new Game(m_uMaxRow, m_uMaxCol, m_nColours); // Create a new game with the current size, and the current # of colours
+        c_view->centralWidget->setBoardSize(m_uMaxCol, m_uMaxRow); // Tell view to resize itself to m_uMaxCol wide x m_uMaxRow high
+        c_model = new Game(m_uMaxRow, m_uMaxCol, m_nColours, QDateTime::currentMSecsSinceEpoch()); // Create a new game with the current size, and the current # of colours, seeded from the clock
+        c_view->centralWidget->setPalette(c_model->getColours()); // Give the view the new game's colours
+        statusBar()->showMessage(tr("Game seed: %1").arg(qulonglong(c_model->getSeed())), 5000); // So that the game can be played again
         updateView(); // Update the view with the new changes in the model
         e_curStat = IGAM; // Change to "in game" state
     }
 }
 
+/**
+ * @brief SameGameWindow::on_actionSave_Game_triggered Handles a click on the "Save Game" menu item, by asking for a file name
+ * and saving the game in progress to it.
+ */
+void SameGameWindow::on_actionSave_Game_triggered()
+{
+    QString fname; // File chosen by the user
+    QMessageBox mb; // Error message
+
+    if (e_curStat != IGAM || c_model == 0) // Nothing to save
+    {
+        return;
+    }
+
+    fname = QFileDialog::getSaveFileName(this, tr("Save Game"), QString(), tr(SAVE_FILTER));
+
+    if (fname.isEmpty()) // User cancelled
+    {
+        return;
+    }
+
+    if (!c_model->save(fname.toStdString())) // Couldn't write the file
+    {
+        mb.setText(tr("The game couldn't be saved to %1.").arg(fname));
+        mb.exec();
+    }
+}
+
+/**
+ * @brief SameGameWindow::on_actionLoad_Game_triggered Handles a click on the "Load Game" menu item, by asking for a file name
+ * and replacing the current game, if any, with the game saved in it. If the file can't be loaded, the current game carries on.
+ */
+void SameGameWindow::on_actionLoad_Game_triggered()
+{
+    QString fname; // File chosen by the user
+    QMessageBox mb; // Error message
+    Game* loaded; // The loaded game
+
+    fname = QFileDialog::getOpenFileName(this, tr("Load Game"), QString(), tr(SAVE_FILTER));
+
+    if (fname.isEmpty()) // User cancelled
+    {
+        return;
+    }
+
+    try
+    {
+        loaded = new Game(fname.toStdString()); // Load the game
+    }
+
+    catch (exception& e) // Not a saved game, or unreadable
+    {
+        mb.setText(tr("The game couldn't be loaded:\n%1").arg(QString::fromStdString(e.what())));
+        mb.exec();
+        return;
+    }
+
+    cancelHint(); // The hint is for the old game
+    delete c_model; // Replace the old game, if there was one
+    c_model = loaded;
+    m_uMaxRow = c_model->getMaxRow(); // Use the loaded game's settings
+    m_uMaxCol = c_model->getMaxCol();
+    m_nColours = c_model->getNumCols();
+
+    c_view->centralWidget->setBoardSize(m_uMaxCol, m_uMaxRow); // Tell view to resize itself to the loaded board
+    c_view->centralWidget->setPalette(c_model->getColours()); // Give the view the loaded game's colours
+    updateView(); // Show the whole loaded board
+    e_curStat = IGAM; // Change to "in game" state
+}
+
+/*** Edit menu actions ***/
+
+/**
+ * @brief SameGameWindow::on_actionUndo_triggered Handles a click on Edit->Undo, which takes back the last move. Only the blocks
+ * it changed are redrawn.
+ */
+void SameGameWindow::on_actionUndo_triggered()
+{
+    if (e_curStat != IGAM || c_model == 0) // Only during a game
+    {
+        return;
+    }
+
+    cancelHint(); // The hint is for the current board
+
+    if (c_model->undo()) // A move was taken back
+    {
+        updateView();
+    }
+}
+
+/**
+ * @brief SameGameWindow::on_actionRedo_triggered Handles a click on Edit->Redo, which plays the last move taken back again.
+ */
+void SameGameWindow::on_actionRedo_triggered()
+{
+    if (e_curStat != IGAM || c_model == 0) // Only during a game
+    {
+        return;
+    }
+
+    cancelHint(); // The hint is for the current board
+
+    if (c_model->redo()) // A move was played again
+    {
+        updateView();
+        endGameIfOver(); // It may have been the last move
+    }
+}
+
 /*** About menu actions ***/
 
 /**
@@ -100,6 +251,116 @@ void SameGameWindow::on_actionGame_triggered()
     msgBox.exec(); // Show the dialog while blocking the rest of the application
 }
 
+/**
+ * @brief SameGameWindow::on_actionHint_triggered Handles a click on Help->Hint, which searches for a good move on a worker
+ * thread. The search works on a copy of the board, so the player can keep playing; the hint is shown by hintReady() when the
+ * search finishes, and the search is cancelled if the player moves first.
+ */
+void SameGameWindow::on_actionHint_triggered()
+{
+    BoardGrid board; // Copy of the board for the search
+    int score; // Current score
+    shared_ptr<atomic<bool>> cancel; // Cancellation flag for the search
+    int nThreads = max(1, QThread::idealThreadCount() - 1); // Leave a core for the GUI
+
+    if (e_curStat != IGAM || c_model == 0) // Only during a game
+    {
+        return;
+    }
+
+    if (c_hintWatcher.isRunning() && !c_hintCancel->load()) // Already looking for this board's hint
+    {
+        return;
+    }
+
+    cancelHint(); // Remove any old hint
+    board = c_model->getBoard();
+    score = c_model->getPoints();
+    cancel = make_shared<atomic<bool>>(false);
+    c_hintCancel = cancel;
+    m_hintHash = c_model->getHash(); // To recognise a stale hint
+    c_hintTimer.start();
+    statusBar()->showMessage(tr("Looking for a hint..."));
+
+    c_hintWatcher.setFuture(QtConcurrent::run([board, score, cancel, nThreads] () -> SolverResult
+    {
+        SolverSettings settings; // Quick search
+        settings.level = 1;
+        settings.threads = nThreads;
+        settings.timeLimitMs = HINT_TIME_MS;
+        return Solver(settings).solve(board, score, cancel.get());
+    }));
+}
+
+/**
+ * @brief SameGameWindow::on_actionHigh_Scores_triggered Handles a click on Help->High Scores, which shows the best scores for
+ * the current board size and # of colours.
+ */
+void SameGameWindow::on_actionHigh_Scores_triggered()
+{
+    QMessageBox msgBox; // Shows the table
+    vector<HighScore> scores; // Best scores, best first
+    QString text; // The table
+    size_t i; // Score counter
+
+    c_scores.top(m_uMaxRow, m_uMaxCol, m_nColours, HIGHSCORE_SHOWN, scores);
+    text = tr("High scores for %1 x %2 boards with %3 colours:\n").arg(m_uMaxCol).arg(m_uMaxRow).arg(m_nColours);
+
+    if (scores.empty()) // Nobody has finished a game like this
+    {
+        text += tr("\nNo games finished yet.");
+    }
+
+    for (i = 0; i < scores.size(); i++) // One line per score
+    {
+        text += tr("\n%1. %2  (%3)").arg(i + 1).arg(scores[i].score)
+                .arg(QDateTime::fromMSecsSinceEpoch(scores[i].time * 1000).toString(Qt::DefaultLocaleShortDate));
+    }
+
+    msgBox.setText(text);
+    msgBox.exec();
+}
+
+/*** Hints ***/
+
+/**
+ * @brief SameGameWindow::hintReady Shows the hint found by the search, by outlining the group which the best line removes
+ * first. The result is thrown away if the search was cancelled or the board has changed since it was requested.
+ */
+void SameGameWindow::hintReady()
+{
+    SolverResult result; // What the search found
+    vector<int> group; // Board indices of the hinted group
+    vector<pair<int, int>> squares; // (x, y) coords of the hinted group
+    CellSpan cells; // View of the model's cells, to convert indices to coords
+    qint64 latency = c_hintTimer.elapsed(); // Time from request to result
+
+    if (!c_hintCancel || c_hintCancel->load() || c_model == 0 || e_curStat != IGAM || c_model->getHash() != m_hintHash) // Stale
+    {
+        return;
+    }
+
+    result = c_hintWatcher.result();
+
+    if (result.moves.empty()) // Nothing to suggest
+    {
+        statusBar()->showMessage(tr("No moves left."));
+        return;
+    }
+
+    cells = c_model->getCells();
+    c_model->getGroupCells(result.moves[0].x, result.moves[0].y, group);
+
+    for (vector<int>::const_iterator it = group.begin(); it != group.end(); it++) // Convert to coords for the view
+    {
+        squares.push_back(pair<int, int>(cells.xOf(*it), cells.yOf(*it)));
+    }
+
+    c_view->centralWidget->setHint(squares);
+    statusBar()->showMessage(tr("Hint: remove the outlined group. Best line found scores %1 (%2 ms, %3 playouts).")
+                             .arg(result.score).arg(latency).arg(result.playouts));
+}
+
 /*** Board actions ***/
 
 /**
@@ -111,9 +372,6 @@ void SameGameWindow::on_actionGame_triggered()
 bool SameGameWindow::eventFilter(QObject *object, QEvent *event)
 {
     QMouseEvent* mouseEv; // Holds cast event
-    QMessageBox mb; // DEBUGGING
-    QString msgUnformatted = "Detected click on board at view coords (%1, %2).\nEquivalent model coords: (%3, %4)."; // Message to show user. Initialized to constant values plus parameters.
-    QString msgFormatted; // Holds the formatted message
     pair<int, int> modelCoords; // Pair which holds model coords (converted by view)
 
     if (object == c_view->centralWidget && event->type() == QEvent::MouseButtonPress) // We will handle "clicks" on the board (a mouse button press)
@@ -125,39 +383,15 @@ bool SameGameWindow::eventFilter(QObject *object, QEvent *event)
             /* DEBUGGING: Show message w/ click coords */
             //qDebug() << "Click coords: (" << mouseEv->x() << ", " << mouseEv->y() << ")"; // Log click point to see if we're fetching that
 
+            cancelHint(); // The player moved first, so the hint is no longer wanted
             modelCoords = c_view->centralWidget->toModelCoords(mouseEv->x(), mouseEv->y()); // Get view to convert click coords to model coords, and store them
 
-            msgFormatted = msgUnformatted.arg(mouseEv->x()).arg(mouseEv->y()).arg(get<0>(modelCoords)).arg(get<1>(modelCoords)); // Replace params w/ x and y coords, and store result
-            mb.setText(msgFormatted); // Set message box text to coords text
-            mb.exec(); // Show the message
-
             /* Check if it's a black square. We don't care about clicks on them. */
             if (!c_model->isCellEmpty(get<0>(modelCoords), get<1>(modelCoords))) // This cell isn't empty, so we can delete blocks
             {
                 c_model->removeBlock(get<0>(modelCoords), get<1>(modelCoords)); // Tell model to remove a block at this position
                 updateView(); // Update the view to display the changed board
-
-                /* Check if the game is over */
-                if (c_model->isGameOver()) // The game has ended, for some reason
-                {
-                    e_curStat = GEND; // Go to "end" state
-
-                    /* Check if the user lost or won */
-                    if (c_model->isBoardEmpty()) // Board is empty, so user won
-                    {
-                        mb.setText("Congratulations, you cleared the board and won!\nHip-hip-hurray!"); // Display a congratulatory message
-                        mb.exec(); // Show the message while blocking
-                    }
-
-                    else // Board isn't empty and game is over, so user must have lost (no moves left)
-                    {
-                        mb.setText("Unfortunately, you don't have any moves left.\nBetter luck next time!");
-                        mb.exec();
-                    }
-
-                    delete c_model; // Delete the model, now that the game has finished
-                    c_model = 0;
-                }
+                endGameIfOver(); // Check if the game is over
             }
 
             return true; // We don't want the boardView to handle this event
@@ -178,21 +412,112 @@ bool SameGameWindow::eventFilter(QObject *object, QEvent *event)
 /** Private methods **/
 
 /**
- * @brief updateView Updates the view by sending it updates for each changed block in the model's queue, then clears the model's queue.
+ * @brief updateView Updates the view by sending it one batch with every changed block in the model's set of changed blocks,
+ * then clears the model's set. If most of the board changed, the whole board is uploaded instead.
  */
 void SameGameWindow::updateView()
 {
      /* Variables */
-     QQueue<pair<int, int>> m_changedBlocks; // Holds blocks which were changed in model
-     pair<int, int> c_curBlock; // Holds the coords of the current block to change
+     const ChangeSet& m_changedBlocks = c_model->getChangedBlocks(); // Holds blocks which were changed in model
+     CellSpan m_cells = c_model->getCells(); // Read-only view of the model's cells
+     int i; // Board index of the current block to change
+     CellUpdate change; // Change to the current block
 
-     m_changedBlocks = c_model->getChangedBlocks(); // Get the queue of changed blocks from the model
+     if (m_changedBlocks.getCount() * 2 >= m_cells.rows * m_cells.cols) // Most blocks changed (always true for a new game)
+     {
+         c_view->centralWidget->uploadFrame(m_cells); // Send the whole board at once
+     }
 
-     while (!m_changedBlocks.isEmpty()) // Loop through all changes in queue
+     else
      {
-         c_curBlock = m_changedBlocks.dequeue(); // Fetch the coords of the next block to change
-         c_view->centralWidget->setSquareColour(get<0>(c_curBlock), get<1>(c_curBlock), c_model->getColourFromIndex(c_model->getBlockColour(get<0>(c_curBlock), get<1>(c_curBlock)))); // Update the view's colour at this location with the new colour in the model
+         c_updates.clear(); // Reuse the batch's memory
+
+         for (i = m_changedBlocks.first(); i != -1; i = m_changedBlocks.next(i)) // Loop through all changed blocks
+         {
+             change.x = m_cells.xOf(i);
+             change.y = m_cells.yOf(i);
+             change.colour = m_cells.cell(i); // The view looks the colour up in its palette
+             c_updates.push_back(change);
+         }
+
+         c_view->centralWidget->applyUpdates(c_updates.data(), c_updates.size()); // Send the batch, which is repainted once
      }
 
-     c_model->clearChangedBlocks(); // Tell the model to clear its queue
+     c_model->clearChangedBlocks(); // Tell the model to clear its set
+}
+
+/**
+ * @brief SameGameWindow::endGameIfOver Ends the game if no moves are left, telling the user whether they won or lost. The score
+ * goes into the high scores, and the moves of a game started from a seed are appended to the replay file.
+ */
+void SameGameWindow::endGameIfOver()
+{
+    QMessageBox mb; // End of game messages
+    HighScore score; // The finished game
+    Replay replay; // Its moves
+    QString result; // The score, and its place in the high scores
+    int place; // Its place in the high scores
+
+    if (c_model->isGameOver()) // The game has ended, for some reason
+    {
+        e_curStat = GEND; // Go to "end" state
+
+        /* Record the score. It's written to disk in the background. */
+        score.rows = c_model->getMaxRow();
+        score.cols = c_model->getMaxCol();
+        score.nColours = c_model->getNumCols();
+        score.score = c_model->getPoints();
+        score.seed = c_model->getSeed();
+        score.time = QDateTime::currentMSecsSinceEpoch() / 1000;
+        c_scores.add(score);
+        place = c_scores.rank(score);
+
+        if (c_model->getReplay(replay)) // Keep the moves too, so the score can be checked. Also written in the background.
+        {
+            c_replays.add(replay);
+        }
+
+        result = tr("\n\nYour score: %1.").arg(score.score);
+
+        if (place > 0) // Made it into the table
+        {
+            result += tr(" That's #%1 for this board size and number of colours.").arg(place);
+        }
+
+        if (c_scores.hasWriteFailed() || c_replays.hasWriteFailed()) // An earlier write failed. This game's may still be in progress.
+        {
+            result += tr("\n\nSome scores or replays couldn't be saved.");
+        }
+
+        /* Check if the user lost or won */
+        if (c_model->isBoardEmpty()) // Board is empty, so user won
+        {
+            mb.setText(tr("Congratulations, you cleared the board and won!\nHip-hip-hurray!") + result); // Display a congratulatory message
+            mb.exec(); // Show the message while blocking
+        }
+
+        else // Board isn't empty and game is over, so user must have lost (no moves left)
+        {
+            mb.setText(tr("Unfortunately, you don't have any moves left.\nBetter luck next time!") + result);
+            mb.exec();
+        }
+
+        delete c_model; // Delete the model, now that the game has finished
+        c_model = 0;
+    }
+}
+
+/**
+ * @brief SameGameWindow::cancelHint Stops the current hint search, if there is one, without waiting for it, and removes any
+ * hint from the board.
+ */
+void SameGameWindow::cancelHint()
+{
+    if (c_hintCancel) // A search was started
+    {
+        c_hintCancel->store(true); // The search checks this between playouts
+    }
+
+    c_view->centralWidget->clearHint();
+    statusBar()->clearMessage();
 }
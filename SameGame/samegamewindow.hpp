@@ -3,7 +3,12 @@
 
 /* Qt classes */
 #include <QMainWindow> // Base class
-#include <QQueue> // For queue of changed blocks
+#include <QFutureWatcher> // Watches the hint search
+#include <QElapsedTimer> // Hint latency
+
+/* STL classes */
+#include <atomic> // Hint cancellation flag
+#include <memory> // shared_ptr
 
 /* My classes */
 
@@ -13,6 +18,8 @@
 
 /* Model */
 #include "game.hpp" // Model
+#include "solver.hpp" // Hint search
+#include "highscores.hpp" // High score table
 
 namespace Ui {
 class SameGameWindow;
@@ -51,20 +58,34 @@ class SameGameWindow : public QMainWindow
     private slots:
         /* File menu actions */
         void on_actionNew_Game_triggered(); // Handles a click on the File->"New Game" menu item.
+        void on_actionSave_Game_triggered(); // Handles a click on the File->"Save Game" menu item.
+        void on_actionLoad_Game_triggered(); // Handles a click on the File->"Load Game" menu item.
+
+        /* Edit menu actions */
+        void on_actionUndo_triggered(); // Handles a click on the Edit->"Undo" menu item.
+        void on_actionRedo_triggered(); // Handles a click on the Edit->"Redo" menu item.
 
         /* Help menu actions */
         void on_actionGame_triggered(); // Handles a click on the Help->"How to play" menu item.
+        void on_actionHint_triggered(); // Handles a click on the Help->"Hint" menu item.
+        void on_actionHigh_Scores_triggered(); // Handles a click on the Help->"High Scores" menu item.
+
+        /* Hints */
+        void hintReady(); // Shows the hint once the search has finished
 
         /* Other */
         bool eventFilter(QObject *object, QEvent *event); // Filters events for the board view and handles clicks
 
     private:
             /* Helper methods */
-            void updateView(); // Updates the view using the model's queue of changed blocks, and also clears the model's queue
+            void updateView(); // Updates the view using the model's set of changed blocks, and also clears the model's set
+            void endGameIfOver(); // Shows the end of game message and ends the game, if no moves are left
+            void cancelHint(); // Stops the hint search, if one is running, and removes the hint from the board
 
             /* View vars */
             Ui::SameGameWindow *c_view; // Game window
             NewGameDialog *c_ngdiag; // New game dialog
+            vector<CellUpdate> c_updates; // Batch of changes sent to the board view. Kept between moves so that its memory is reused.
 
             /* Model vars */
             Game *c_model; // Pointer to object which holds the current game
@@ -74,6 +95,16 @@ class SameGameWindow : public QMainWindow
             int m_uMaxRow; // Contains # of rows set by user. Used to create a Game object.
             int m_uMaxCol; // Contains # of columns set by user. Used to create a new Game object.
             int m_nColours; // # of colours to use for the game.
+
+            /* Hint vars */
+            QFutureWatcher<SolverResult> c_hintWatcher; // Tells us when the hint search has finished
+            shared_ptr<atomic<bool>> c_hintCancel; // Set to stop the current hint search. Shared with the search, which may outlive its request.
+            uint64_t m_hintHash; // Hash of the board which the current hint search started from
+            QElapsedTimer c_hintTimer; // Time since the current hint was requested
+
+            /* High scores */
+            HighScores c_scores; // Best scores of every configuration, loaded in the background
+            ReplayFile c_replays; // Moves of every finished game, written in the background
             QEvent* event;
 };
 
@@ -0,0 +1,253 @@
+#include "snapshot.hpp"
+
+/* STL Headers */
+#include <cstring> // memcpy(), memcmp()
+
+using namespace std; // To save some typing
+
+/* Defines */
+#define SNAPSHOT_MAX_SIDE 16384 // Largest # of rows or columns a snapshot may claim, so that the board size fits in an int
+
+static_assert(sizeof(SnapshotHeader) == 48, "SnapshotHeader must have no padding");
+
+/*** Helpers ***/
+
+/**
+ * @brief bitsPerCell Fetches the # of bits each cell is stored in.
+ * @param m_nColours The # of colours.
+ * @return 4 if every colour index fits in 4 bits, 8 otherwise.
+ */
+static int bitsPerCell(int m_nColours)
+{
+    return (m_nColours <= 15) ? 4 : 8;
+}
+
+/**
+ * @brief rowBytes Fetches the # of bytes each row is stored in.
+ * @param m_cols The # of columns.
+ * @param m_bits The # of bits per cell.
+ * @return The # of bytes per row.
+ */
+static size_t rowBytes(int m_cols, int m_bits)
+{
+    return (m_bits == 4) ? (size_t(m_cols) + 1) / 2 : size_t(m_cols);
+}
+
+/*** Writing ***/
+
+/**
+ * @brief snapshotBytes Fetches the size of a snapshot.
+ * @param m_rows The # of rows.
+ * @param m_cols The # of columns.
+ * @param m_nColours The # of colours, excluding black.
+ * @return The size in bytes.
+ */
+size_t snapshotBytes(int m_rows, int m_cols, int m_nColours)
+{
+    return sizeof(SnapshotHeader) + (m_nColours + 1) * sizeof(uint32_t) + snapshotCellBytes(m_rows, m_cols, bitsPerCell(m_nColours));
+}
+
+/**
+ * @brief snapshotWrite Writes a snapshot of a board.
+ * @param m_out The buffer to write to. Must hold snapshotBytes() bytes.
+ * @param m_board The board. Every cell must be empty or hold a colour index up to nColours.
+ * @param m_nColours The # of colours, excluding black.
+ * @param m_palette The nColours + 1 colours, as 0xAARRGGBB, black first.
+ * @param m_points The score.
+ * @param m_seed The seed the game was generated from.
+ * @param m_hash The board's Zobrist hash.
+ */
+void snapshotWrite(uint8_t* m_out, const BoardGrid& m_board, int m_nColours, const uint32_t* m_palette, int m_points, uint64_t m_seed, uint64_t m_hash)
+{
+    SnapshotHeader header; // Header being written
+    int bits = bitsPerCell(m_nColours); // Bits per cell
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.headerBytes = sizeof(header);
+    header.rows = m_board.getRows();
+    header.cols = m_board.getCols();
+    header.nColours = m_nColours;
+    header.bitsPerCell = bits;
+    header.points = m_points;
+    header.seed = m_seed;
+    header.hash = m_hash;
+
+    memcpy(m_out, &header, sizeof(header));
+    m_out += sizeof(header);
+    memcpy(m_out, m_palette, (m_nColours + 1) * sizeof(uint32_t));
+    m_out += (m_nColours + 1) * sizeof(uint32_t);
+
+    snapshotPackCells(m_board, bits, m_out);
+}
+
+/*** Reading ***/
+
+/**
+ * @brief snapshotRead Reads a snapshot into a board. Nothing is parsed: the header and palette are copied out, and the cells are
+ * copied (or unpacked, 2 to a byte) a row at a time into the board. Every field is checked against the size of the buffer, so a
+ * truncated or corrupt file can't cause a read outside it.
+ * @param m_in The snapshot.
+ * @param m_size The size of the snapshot in bytes.
+ * @param m_header Receives the header.
+ * @param m_palette Receives the colours.
+ * @param m_board Receives the board. Resized to fit.
+ * @return 0 on success, or a description of what is wrong with the snapshot.
+ */
+const char* snapshotRead(const uint8_t* m_in, size_t m_size, SnapshotHeader& m_header, vector<uint32_t>& m_palette, BoardGrid& m_board)
+{
+    size_t stride; // Bytes per row
+
+    if (m_size < sizeof(SnapshotHeader)) // Too small for the header
+    {
+        return "file is too small to be a saved game";
+    }
+
+    memcpy(&m_header, m_in, sizeof(m_header));
+
+    if (memcmp(m_header.magic, SNAPSHOT_MAGIC, sizeof(m_header.magic)) != 0) // Not a snapshot
+    {
+        return "not a saved game";
+    }
+
+    if (m_header.version != SNAPSHOT_VERSION || m_header.headerBytes < sizeof(SnapshotHeader)) // From another version
+    {
+        return "saved by an unsupported version";
+    }
+
+    if (m_header.rows == 0 || m_header.cols == 0 || m_header.rows > SNAPSHOT_MAX_SIDE || m_header.cols > SNAPSHOT_MAX_SIDE
+            || m_header.nColours == 0 || m_header.nColours >= BoardGrid::REMOVED
+            || m_header.bitsPerCell != uint32_t(bitsPerCell(m_header.nColours))) // Nonsense sizes
+    {
+        return "saved game has an invalid size or # of colours";
+    }
+
+    stride = rowBytes(m_header.cols, m_header.bitsPerCell);
+
+    if (m_header.headerBytes > m_size || m_size < m_header.headerBytes + (m_header.nColours + 1) * sizeof(uint32_t) + m_header.rows * stride) // Truncated
+    {
+        return "saved game is truncated";
+    }
+
+    m_in += m_header.headerBytes;
+    m_palette.resize(m_header.nColours + 1);
+    memcpy(m_palette.data(), m_in, m_palette.size() * sizeof(uint32_t));
+    m_in += m_palette.size() * sizeof(uint32_t);
+    m_board.resize(m_header.rows, m_header.cols);
+
+    if (!snapshotUnpackCells(m_in, m_header.bitsPerCell, m_header.nColours, m_board)) // A cell holds a colour which doesn't exist
+    {
+        return "saved game has invalid cells";
+    }
+
+    return 0;
+}
+
+/*** Cells ***/
+
+/**
+ * @brief snapshotCellBytes Fetches the # of bytes a board's cells are packed into.
+ * @param m_rows The # of rows.
+ * @param m_cols The # of columns.
+ * @param m_bits The # of bits per cell, 4 or 8.
+ * @return The # of bytes.
+ */
+size_t snapshotCellBytes(int m_rows, int m_cols, int m_bits)
+{
+    return m_rows * rowBytes(m_cols, m_bits);
+}
+
+/**
+ * @brief snapshotPackCells Packs a board's cells, row by row from the top, with each row starting on a new byte.
+ * @param m_board The board. Every cell must fit in the given # of bits.
+ * @param m_bits The # of bits per cell: 4, for 2 cells to a byte with the left cell in the low bits, or 8.
+ * @param m_out The buffer to write to. Must hold snapshotCellBytes() bytes.
+ */
+void snapshotPackCells(const BoardGrid& m_board, int m_bits, uint8_t* m_out)
+{
+    size_t stride = rowBytes(m_board.getCols(), m_bits); // Bytes per row
+    int cols = m_board.getCols(); // # of columns
+    const Cell* src; // Row being packed
+    uint8_t* dst; // Where it goes
+    int x; // Column counter
+    int y; // Row counter
+
+    for (y = 0; y < m_board.getRows(); y++) // Pack row by row
+    {
+        src = m_board.data() + m_board.index(0, y);
+        dst = m_out + y * stride;
+
+        if (m_bits == 8) // Stored as is
+        {
+            memcpy(dst, src, stride);
+        }
+
+        else
+        {
+            for (x = 0; x + 1 < cols; x += 2) // Two cells to a byte
+            {
+                dst[x/2] = uint8_t(src[x] | src[x+1] << 4);
+            }
+
+            if (x < cols) // Odd # of columns: the last byte has one cell
+            {
+                dst[x/2] = src[x];
+            }
+        }
+    }
+}
+
+/**
+ * @brief snapshotUnpackCells Unpacks cells packed by snapshotPackCells() into a board, and checks that each one is empty or a
+ * colour index.
+ * @param m_in The packed cells. Must hold snapshotCellBytes() bytes for the board's size.
+ * @param m_bits The # of bits per cell, 4 or 8.
+ * @param m_nColours The # of colours, excluding black.
+ * @param m_board The board to unpack into. Must already have the right size.
+ * @return True if every cell was valid.
+ */
+bool snapshotUnpackCells(const uint8_t* m_in, int m_bits, int m_nColours, BoardGrid& m_board)
+{
+    size_t stride = rowBytes(m_board.getCols(), m_bits); // Bytes per row
+    int cols = m_board.getCols(); // # of columns
+    const uint8_t* src; // Row being unpacked
+    Cell* dst; // Where it goes
+    uint8_t bad = 0; // Set if any cell holds more than a colour index
+    int x; // Column counter
+    int y; // Row counter
+
+    for (y = 0; y < m_board.getRows(); y++) // Unpack row by row
+    {
+        src = m_in + y * stride;
+        dst = m_board.data() + m_board.index(0, y);
+
+        if (m_bits == 8) // Stored as is
+        {
+            memcpy(dst, src, stride);
+
+            for (x = 0; x < cols; x++) // Look for cells beyond the last colour
+            {
+                bad |= (dst[x] > m_nColours);
+            }
+        }
+
+        else
+        {
+            for (x = 0; x + 1 < cols; x += 2) // Two cells to a byte
+            {
+                dst[x] = src[x/2] & 0x0F;
+                dst[x+1] = src[x/2] >> 4;
+                bad |= (dst[x] > m_nColours) | (dst[x+1] > m_nColours);
+            }
+
+            if (x < cols) // Odd # of columns
+            {
+                dst[x] = src[x/2] & 0x0F;
+                bad |= (dst[x] > m_nColours);
+            }
+        }
+    }
+
+    return bad == 0;
+}
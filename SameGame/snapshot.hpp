@@ -0,0 +1,59 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+/* C++ Headers */
+#include <cstddef> // size_t
+#include <cstdint> // Fixed-size fields
+#include <vector> // STL vectors
+
+/* My headers */
+#include "boardgrid.hpp" // Board being saved or loaded
+
+using namespace std;
+
+/*
+ * Saved games. A snapshot is one block of bytes, laid out so that it can be read straight out of a memory-mapped file:
+ *
+ *   SnapshotHeader                  48 bytes, little-endian
+ *   palette                         (nColours + 1) 32-bit 0xAARRGGBB colours, black first
+ *   cells                           rows x ceil(cols * bitsPerCell / 8) bytes, row by row from the top
+ *
+ * Cells are packed 2 to a byte, the left cell in the low 4 bits, when every colour index fits in 4 bits (15 colours or fewer).
+ * Otherwise each cell is one byte, and each row can be copied into the board as it is. Each row starts on a new byte.
+ *
+ * The header holds the board's Zobrist hash, which the loader has to compute anyway, so corrupt cells are caught for free.
+ */
+
+#define SNAPSHOT_MAGIC "SGSV" // First 4 bytes of every snapshot
+#define SNAPSHOT_VERSION 1 // Current version of the format
+
+/**
+ * @brief The SnapshotHeader struct. The fixed-size start of a snapshot. All fields are naturally aligned, so it has no padding.
+ */
+struct SnapshotHeader
+{
+    char magic[4]; // SNAPSHOT_MAGIC
+    uint32_t version; // SNAPSHOT_VERSION
+    uint32_t headerBytes; // Size of the header. Later versions may add fields at the end.
+    uint32_t rows; // # of rows
+    uint32_t cols; // # of columns
+    uint32_t nColours; // # of colours, excluding black
+    uint32_t bitsPerCell; // 4 or 8
+    int32_t points; // Score so far
+    uint64_t seed; // Seed the game was generated from
+    uint64_t hash; // Zobrist hash of the board
+};
+
+/* Writing */
+size_t snapshotBytes(int m_rows, int m_cols, int m_nColours); // Fetches the size of a snapshot of a board
+void snapshotWrite(uint8_t* m_out, const BoardGrid& m_board, int m_nColours, const uint32_t* m_palette, int m_points, uint64_t m_seed, uint64_t m_hash); // Writes a snapshot into a buffer of snapshotBytes() bytes
+
+/* Reading */
+const char* snapshotRead(const uint8_t* m_in, size_t m_size, SnapshotHeader& m_header, vector<uint32_t>& m_palette, BoardGrid& m_board); // Reads a snapshot. Returns 0, or a description of what is wrong with it.
+
+/* Cells. Also used by the corpus format. */
+size_t snapshotCellBytes(int m_rows, int m_cols, int m_bits); // Fetches the # of bytes a board's cells are packed into
+void snapshotPackCells(const BoardGrid& m_board, int m_bits, uint8_t* m_out); // Packs a board's cells at 4 or 8 bits each
+bool snapshotUnpackCells(const uint8_t* m_in, int m_bits, int m_nColours, BoardGrid& m_board); // Unpacks cells into a board of the right size. Returns false if any cell isn't a colour index.
+
+#endif // SNAPSHOT_HPP
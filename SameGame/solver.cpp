@@ -0,0 +1,456 @@
+#include "solver.hpp"
+
+/* My headers */
+#include "bitposition.hpp" // Bitboard positions
+#include "rng.hpp" // Random playouts
+#include "threadpool.hpp" // Work-stealing workers
+#include "trace.hpp" // Hot-path tracing
+#include "transpositiontable.hpp" // Lines already found from a position
+
+/* STL Headers */
+#include <atomic> // Shared counters
+#include <chrono> // Time budget
+#include <memory> // unique_ptr
+#include <mutex> // Best line
+
+using namespace std; // To save some typing
+
+namespace
+{
+    typedef chrono::steady_clock Clock; // Clock for the time budget
+
+    /**
+     * @brief The SearchState struct. State shared by every search task of one solve() call. Pos is Position or BitPosition.
+     */
+    template<class Pos>
+    struct SearchState
+    {
+        Pos root; // Starting position
+        vector<Move> rootMoves; // Legal first moves
+        SolverSettings settings; // Budget and search level
+        Clock::time_point deadline; // When to stop, if there is a time limit
+        atomic<long long> playouts; // # of playouts run so far
+        atomic<bool> stop; // Set once the budget has run out
+        const atomic<bool>* cancel; // Set by the caller to stop early, or 0 if the search can't be cancelled
+        TranspositionTable* table; // Table shared by all workers, or 0 if there is none
+
+        mutex bestLock; // Guards the best line
+        int bestScore; // Score of the best line found so far
+        vector<Move> bestMoves; // The best line found so far
+
+        /**
+         * @brief exhausted Checks whether the budget has run out, or the caller cancelled the search. Once it has, it stays that
+         * way.
+         * @return True if the search should stop.
+         */
+        bool exhausted()
+        {
+            if (stop.load(memory_order_relaxed)) // Already known
+            {
+                return true;
+            }
+
+            if ((cancel != 0 && cancel->load(memory_order_relaxed)) // Cancelled
+                || (settings.maxPlayouts > 0 && playouts.load(memory_order_relaxed) >= settings.maxPlayouts) // Out of playouts
+                || (settings.timeLimitMs > 0 && Clock::now() >= deadline)) // Out of time
+            {
+                stop = true;
+                return true;
+            }
+
+            return false;
+        }
+
+        /**
+         * @brief hasLine Checks whether any complete line has been found yet.
+         * @return True if there is a best line.
+         */
+        bool hasLine()
+        {
+            lock_guard<mutex> lock(bestLock);
+
+            return bestScore >= 0;
+        }
+
+        /**
+         * @brief offer Records a line as the best one, if it beats the best line found so far.
+         * @param m_score The line's final score.
+         * @param m_first The line's first move.
+         * @param m_rest The rest of the line.
+         */
+        void offer(int m_score, const Move& m_first, const vector<Move>& m_rest)
+        {
+            lock_guard<mutex> lock(bestLock);
+
+            if (m_score > bestScore) // New best line
+            {
+                bestScore = m_score;
+                bestMoves.assign(1, m_first);
+                bestMoves.insert(bestMoves.end(), m_rest.begin(), m_rest.end());
+            }
+        }
+    };
+
+    /**
+     * @brief The NestedSearch class. One worker's nested Monte Carlo search. Every level of the search has its own positions and
+     * move lists, which are kept between searches, so a search allocates nothing once it has warmed up.
+     */
+    template<class Pos>
+    class NestedSearch
+    {
+        public:
+            /**
+             * @brief NestedSearch Constructor.
+             * @param m_state The shared search state.
+             * @param m_seed Seed for this worker's random numbers.
+             */
+            NestedSearch(SearchState<Pos>& m_state, uint64_t m_seed) :
+                c_state(m_state),
+                c_rng(m_seed),
+                c_levels(m_state.settings.level + 1)
+            {
+            }
+
+            /**
+             * @brief search Runs a search of the configured level from a position.
+             * @param m_start The position.
+             * @param m_line Receives the best line found from the position.
+             * @return The final score of the best line.
+             */
+            int search(const Pos& m_start, vector<Move>& m_line)
+            {
+                int level = c_state.settings.level; // Level to search at
+
+                if (level <= 0) // Plain random playout
+                {
+                    c_levels[0].cur.assign(m_start);
+                    return playout(c_levels[0].cur, m_line);
+                }
+
+                return nested(m_start, level, m_line);
+            }
+
+        private:
+            /**
+             * @brief The Level struct. Buffers used by one level of the search.
+             */
+            struct Level
+            {
+                Pos cur; // Position reached by the moves played so far
+                Pos child; // Position after trying one more move
+                Pos follow; // Position used while following or recording a line in the table
+                vector<Move> moves; // Legal moves from cur
+                vector<Move> played; // Moves played so far at this level
+                vector<Move> best; // Best line found so far, from the level's starting position
+                vector<Move> sub; // Line returned by the level below
+            };
+
+            /**
+             * @brief playout Plays random legal moves until none are left.
+             * @param m_pos The position to play out. Changed in place.
+             * @param m_line Receives the moves played.
+             * @return The final score.
+             */
+            int playout(Pos& m_pos, vector<Move>& m_line)
+            {
+                vector<Move>& moves = c_levels[0].moves; // Legal moves from the current position
+                int n; // # of legal moves
+
+                m_line.clear();
+
+                while ((n = m_pos.legalMoves(moves)) > 0) // Loop until the game is over
+                {
+                    m_line.push_back(moves[c_rng.below(n)]);
+                    m_pos.play(m_line.back());
+                }
+
+                c_state.playouts.fetch_add(1, memory_order_relaxed);
+                return m_pos.getScore();
+            }
+
+            /**
+             * @brief nested Runs a nested search: tries every legal move followed by a search one level down, plays the first move
+             * of the best line found so far, and repeats until no moves are left. When the budget runs out, the best line found so
+             * far is returned.
+             * @param m_start The position to search from.
+             * @param m_level The level, at least 1.
+             * @param m_line Receives the best line found.
+             * @return The final score of the best line.
+             */
+            int nested(const Pos& m_start, int m_level, vector<Move>& m_line)
+            {
+                Level& lv = c_levels[m_level]; // This level's buffers
+                int bestScore = -1; // Score of the best line found so far
+                int score; // Score of the line being tried
+                size_t i; // Move counter
+
+                lv.cur.assign(m_start);
+                lv.played.clear();
+                lv.best.clear();
+
+                while (lv.cur.legalMoves(lv.moves) > 0) // Loop until the game is over
+                {
+                    for (i = 0; i < lv.moves.size(); i++) // Try each move
+                    {
+                        if (bestScore >= 0 && c_state.exhausted()) // Out of budget, and we already have a complete line
+                        {
+                            m_line = lv.best;
+                            return bestScore;
+                        }
+
+                        lv.child.assign(lv.cur);
+                        lv.child.play(lv.moves[i]);
+
+                        if (m_level >= 2 && followTable(lv.child, m_level - 1, lv.follow, lv.sub)) // Already searched
+                        {
+                            score = lv.follow.getScore();
+                        }
+
+                        else if (m_level == 1) // The level below is a playout
+                        {
+                            score = playout(lv.child, lv.sub);
+                        }
+
+                        else
+                        {
+                            score = nested(lv.child, m_level - 1, lv.sub);
+                        }
+
+                        if (score > bestScore) // The best line now starts with the moves played so far, then this move
+                        {
+                            bestScore = score;
+                            lv.best = lv.played;
+                            lv.best.push_back(lv.moves[i]);
+                            lv.best.insert(lv.best.end(), lv.sub.begin(), lv.sub.end());
+                        }
+                    }
+
+                    lv.played.push_back(lv.best[lv.played.size()]); // Follow the best line one more move
+                    lv.cur.play(lv.played.back());
+                }
+
+                if (bestScore < 0) // No moves at all from the start
+                {
+                    bestScore = lv.cur.getScore();
+                }
+
+                recordLine(m_start, m_level, lv.best, bestScore, lv.follow);
+                m_line = lv.best;
+                return bestScore;
+            }
+
+            /**
+             * @brief followTable Follows the table's best moves from a position to the end of the game.
+             * @param m_start The position.
+             * @param m_level The shallowest level of entry to trust.
+             * @param m_pos Receives the position at the end of the line.
+             * @param m_line Receives the line.
+             * @return True if every position on the way had a trusted entry whose move was legal, false otherwise.
+             */
+            bool followTable(const Pos& m_start, int m_level, Pos& m_pos, vector<Move>& m_line)
+            {
+                TTEntry entry; // Entry for the current position
+
+                if (c_state.table == 0) // No table
+                {
+                    return false;
+                }
+
+                m_pos.assign(m_start);
+                m_line.clear();
+
+                while (!m_pos.isOver()) // Loop until the game is over
+                {
+                    if (!c_state.table->probe(m_pos.getHash(), entry) // Nothing known
+                        || entry.level < m_level // Not searched hard enough
+                        || m_pos.play(entry.move) == 0) // Not a legal move here, so the entry belongs to another board with the same hash
+                    {
+                        return false;
+                    }
+
+                    m_line.push_back(entry.move);
+                }
+
+                return true;
+            }
+
+            /**
+             * @brief recordLine Records the best line found by a nested search in the table, as one entry for each position along
+             * it.
+             * @param m_start The position the search started from.
+             * @param m_level The search's level.
+             * @param m_line The best line found.
+             * @param m_score The line's final score.
+             * @param m_pos Scratch position for walking along the line.
+             */
+            void recordLine(const Pos& m_start, int m_level, const vector<Move>& m_line, int m_score, Pos& m_pos)
+            {
+                TTEntry entry; // Entry for the current position
+                size_t i; // Move counter
+
+                if (c_state.table == 0) // No table
+                {
+                    return;
+                }
+
+                m_pos.assign(m_start);
+                entry.level = m_level;
+
+                for (i = 0; i < m_line.size(); i++) // Walk along the line
+                {
+                    entry.gain = m_score - m_pos.getScore();
+                    entry.move = m_line[i];
+                    c_state.table->store(m_pos.getHash(), entry);
+                    m_pos.play(m_line[i]);
+                }
+            }
+
+            /* Data */
+            SearchState<Pos>& c_state; // Shared state
+            Rng c_rng; // This worker's random numbers
+            vector<Level> c_levels; // Buffers for each level
+    };
+
+    /**
+     * @brief searchFirstMove Searches the line starting with one first move, and queues another search of the same move if the
+     * budget hasn't run out. Runs as a ThreadPool task. Once the budget has run out, queued tasks are dropped, unless no line has
+     * been found at all yet. Then the search runs anyway, but stops as soon as it has a complete line, so the result always holds
+     * a line.
+     * @param m_pool The pool running the task.
+     * @param m_state The shared search state.
+     * @param m_searches Each worker's search.
+     * @param m_move Index of the first move.
+     */
+    template<class Pos>
+    void searchFirstMove(ThreadPool& m_pool, SearchState<Pos>& m_state, vector<unique_ptr<NestedSearch<Pos>>>& m_searches, size_t m_move)
+    {
+        NestedSearch<Pos>& search = *m_searches[ThreadPool::currentWorker()]; // This worker's search
+        Pos start(m_state.root); // Position after the first move
+        vector<Move> line; // Best line after the first move
+        int score; // Its final score
+
+        if (m_state.exhausted() && m_state.hasLine()) // Out of budget, and there's already something to return
+        {
+            return;
+        }
+
+        TRACE_SCOPE("Solver::searchFirstMove");
+        start.play(m_state.rootMoves[m_move]);
+        score = search.search(start, line);
+        m_state.offer(score, m_state.rootMoves[m_move], line);
+
+        if ((m_state.settings.timeLimitMs > 0 || m_state.settings.maxPlayouts > 0) && !m_state.exhausted()) // Budget left, go again
+        {
+            m_pool.submit([&m_pool, &m_state, &m_searches, m_move] () { searchFirstMove<Pos>(m_pool, m_state, m_searches, m_move); });
+        }
+    }
+
+    /**
+     * @brief solveOn Runs Solver::solve() with a given position type.
+     * @param m_settings How hard to search.
+     * @param m_board The board.
+     * @param m_score Points already scored on the board.
+     * @param m_cancel A flag which another thread can set to stop the search early, or 0.
+     * @return The best line found, and statistics about the search.
+     */
+    template<class Pos>
+    SolverResult solveOn(const SolverSettings& m_settings, const BoardGrid& m_board, int m_score, const atomic<bool>* m_cancel)
+    {
+        SearchState<Pos> state; // Shared by all tasks
+        SolverResult result; // Best line and statistics
+        Clock::time_point start = Clock::now(); // When the search started
+        vector<unique_ptr<NestedSearch<Pos>>> searches; // One search per worker
+        unique_ptr<TranspositionTable> table; // Shared by all workers, if enabled
+        size_t i; // Counter
+
+        TRACE_SCOPE("Solver::solve");
+        state.root = Pos(m_board, m_score);
+        state.root.legalMoves(state.rootMoves);
+        state.settings = m_settings;
+        state.deadline = start + chrono::milliseconds(m_settings.timeLimitMs);
+        state.playouts = 0;
+        state.stop = false;
+        state.cancel = m_cancel;
+        state.bestScore = m_score; // With no moves, the score can't change
+        state.table = 0;
+        result.threads = 0;
+        result.tableProbes = 0;
+        result.tableHits = 0;
+
+        if (m_settings.tableBytes > 0 && m_settings.level >= 2) // Only nested searches two or more levels deep look lines up
+        {
+            table.reset(new TranspositionTable(m_settings.tableBytes));
+            state.table = table.get();
+        }
+
+        if (!state.rootMoves.empty()) // Something to search
+        {
+            ThreadPool pool(m_settings.threads); // Destroyed, and its threads joined, before the state goes away
+            result.threads = pool.getThreadCount();
+            state.bestScore = -1;
+
+            for (i = 0; i < size_t(pool.getThreadCount()); i++) // Each worker gets its own random numbers
+            {
+                searches.push_back(unique_ptr<NestedSearch<Pos>>(new NestedSearch<Pos>(state, m_settings.seed + 0x9E3779B97F4A7C15ULL * (i+1))));
+            }
+
+            for (i = 0; i < state.rootMoves.size(); i++) // Queue one search of each first move
+            {
+                pool.submit([&pool, &state, &searches, i] () { searchFirstMove<Pos>(pool, state, searches, i); });
+            }
+
+            pool.wait();
+        }
+
+        result.score = state.bestScore;
+        result.moves = state.bestMoves;
+        result.playouts = state.playouts;
+        result.seconds = chrono::duration<double>(Clock::now() - start).count();
+
+        if (table) // Report how useful the table was
+        {
+            result.tableProbes = table->getProbes();
+            result.tableHits = table->getHits();
+        }
+        return result;
+    }
+}
+
+/*** Constructor ***/
+
+/**
+ * @brief Solver::Solver Constructor.
+ * @param m_settings How hard to search.
+ */
+Solver::Solver(const SolverSettings& m_settings) :
+    c_settings(m_settings)
+{
+}
+
+/*** Searching ***/
+
+/**
+ * @brief Solver::solve Searches for the best line of play from the given board, until the budget runs out. Boards with at most
+ * BITPOSITION_MAX_ROWS rows are searched on bitboards, with BitPosition, and taller ones with Position. Both play the same moves
+ * in the same order, so the result only differs in speed. A negative level is searched as level 0.
+ * @param m_board The board.
+ * @param m_score Points already scored on the board. Included in the result's score.
+ * @param m_cancel A flag which another thread can set to stop the search early, or 0. A cancelled search still returns a line.
+ * @return The best line found, and statistics about the search.
+ */
+SolverResult Solver::solve(const BoardGrid& m_board, int m_score, const atomic<bool>* m_cancel)
+{
+    SolverSettings settings = c_settings; // The settings, with the level made valid
+
+    if (settings.level < 0) // No such level. The searches size their arrays by it, so treat it as plain playouts.
+    {
+        settings.level = 0;
+    }
+
+    if (m_board.getRows() <= BITPOSITION_MAX_ROWS) // Fits in the bitboards. Faster than either board of cells at every size measured.
+    {
+        return solveOn<BitPosition>(settings, m_board, m_score, m_cancel);
+    }
+
+    return solveOn<Position>(settings, m_board, m_score, m_cancel);
+}
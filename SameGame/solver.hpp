@@ -0,0 +1,79 @@
+#ifndef SOLVER_HPP
+#define SOLVER_HPP
+
+/* C++ Headers */
+#include <atomic> // Cancellation flag
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+#include <vector> // STL vectors
+
+/* My headers */
+#include "boardgrid.hpp" // Board to solve
+#include "position.hpp" // Moves and rules
+
+using namespace std;
+
+/**
+ * @brief The SolverSettings struct. How hard the solver searches. If neither limit is set, each first move is searched once.
+ */
+struct SolverSettings
+{
+    int level; // Nesting level of the search. 0 runs plain random playouts, 1 or more runs nested Monte Carlo search.
+    int threads; // # of worker threads, or 0 for one per core
+    int timeLimitMs; // Stop after this many milliseconds, or 0 for no time limit
+    long long maxPlayouts; // Stop after this many playouts, or 0 for no limit
+    uint64_t seed; // Seed for the random playouts. The same seed on one thread gives the same result.
+    size_t tableBytes; // Memory for the transposition table, or 0 for no table. Only used by searches of level 2 or more.
+
+    SolverSettings() : level(1), threads(0), timeLimitMs(1000), maxPlayouts(0), seed(1), tableBytes(0) {} // One second of level 1 search
+};
+
+/**
+ * @brief The SolverResult struct. The best line of play found, and how much work it took.
+ */
+struct SolverResult
+{
+    int score; // Final score of the best line
+    vector<Move> moves; // The best line, from the starting board to a board with no moves left
+    long long playouts; // # of random playouts run
+    double seconds; // Wall-clock time taken
+    int threads; // # of worker threads used
+    uint64_t tableProbes; // # of transposition table lookups
+    uint64_t tableHits; // # of lookups which found an entry
+
+    double playoutsPerSecondPerThread() const { return (seconds > 0 && threads > 0) ? playouts / seconds / threads : 0; } // Headline speed
+};
+
+/**
+ * @brief The Solver class. Searches for the highest-scoring line of play on a board, with nested Monte Carlo search (NMCS). A
+ * level 0 search is a random playout, in which random legal moves are played until none are left. A level n search tries each
+ * legal move followed by a level n-1 search, plays the first move of the best line found so far, and repeats until no moves
+ * are left.
+ *
+ * The search is root-parallel: each legal first move is searched by a separate task, on a work-stealing ThreadPool, and every
+ * task which finishes within the budget queues another search of the same first move with fresh random numbers. The best line
+ * of any task wins. Uses the same rules and scoring as Game, through Position, and doesn't depend on Qt. Boards with at most 64
+ * rows are played out on bitboards instead, with BitPosition.
+ *
+ * Different move orders often reach the same board, so searches of level 2 or more can share a TranspositionTable. Every
+ * completed nested search records its best line in the table, one position at a time. Before a sub-search, the table is
+ * followed from the position; if it leads, entry by entry, to the end of the game through lines found at the same level or
+ * deeper, that line is used instead of searching again.
+ */
+class Solver
+{
+    public:
+        /* Constructor */
+        explicit Solver(const SolverSettings& m_settings = SolverSettings()); // Creates a solver with the given settings
+
+        /* Searching */
+        SolverResult solve(const BoardGrid& m_board, int m_score = 0, const atomic<bool>* m_cancel = 0); // Searches for the best line of play from the given board
+
+        /* Settings */
+        const SolverSettings& getSettings() const { return c_settings; } // Fetches the settings
+
+    private:
+        SolverSettings c_settings; // How hard to search
+};
+
+#endif // SOLVER_HPP
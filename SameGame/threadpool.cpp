@@ -0,0 +1,201 @@
+#include "threadpool.hpp"
+
+using namespace std; // To save some typing
+
+/* Identity of the calling thread. Set once by each worker when it starts. */
+static thread_local const ThreadPool* t_pool = 0; // Pool which owns the calling thread, if any
+static thread_local int t_worker = -1; // Index of the calling thread in its pool
+
+/*** Constructor/destructor ***/
+
+/**
+ * @brief ThreadPool::ThreadPool Constructor. Starts the workers.
+ * @param m_nThreads The # of workers to start. If 0 or less, one worker is started per core.
+ */
+ThreadPool::ThreadPool(int m_nThreads) :
+    m_queued(0),
+    m_pending(0),
+    m_next(0),
+    m_stop(false)
+{
+    int i; // Worker counter
+
+    if (m_nThreads <= 0) // Use every core
+    {
+        m_nThreads = thread::hardware_concurrency();
+
+        if (m_nThreads <= 0) // Couldn't tell
+        {
+            m_nThreads = 1;
+        }
+    }
+
+    for (i = 0; i < m_nThreads; i++) // Create all of the queues before any worker can try to steal from them
+    {
+        c_workers.push_back(unique_ptr<Worker>(new Worker()));
+    }
+
+    for (i = 0; i < m_nThreads; i++) // Start the workers
+    {
+        c_threads.push_back(thread(&ThreadPool::run, this, i));
+    }
+}
+
+/**
+ * @brief ThreadPool::~ThreadPool Destructor. Waits for every queued task to finish, then stops and joins the workers.
+ */
+ThreadPool::~ThreadPool()
+{
+    wait(); // Let the queued work finish
+
+    {
+        lock_guard<mutex> lock(m_idleLock);
+        m_stop = true;
+    }
+
+    c_wake.notify_all(); // Wake the sleeping workers so that they can exit
+
+    for (vector<thread>::iterator it = c_threads.begin(); it != c_threads.end(); it++)
+    {
+        it->join();
+    }
+}
+
+/*** Tasks ***/
+
+/**
+ * @brief ThreadPool::submit Queues a task. A worker queues it onto its own queue. Other threads spread their tasks over the
+ * queues in turn.
+ * @param m_task The task.
+ */
+void ThreadPool::submit(Task m_task)
+{
+    int id; // Queue to put the task on
+
+    if (t_pool == this) // Called from one of our workers
+    {
+        id = t_worker;
+    }
+
+    else
+    {
+        id = m_next++ % c_workers.size();
+    }
+
+    m_pending++; // Count it before it can run, so that wait() can't miss it
+
+    {
+        lock_guard<mutex> lock(c_workers[id]->lock);
+        c_workers[id]->tasks.push_back(move(m_task));
+    }
+
+    m_queued++;
+
+    {
+        lock_guard<mutex> lock(m_idleLock); // A worker which just found nothing to do is either still holding this, or already asleep
+    }
+
+    c_wake.notify_one();
+}
+
+/**
+ * @brief ThreadPool::wait Blocks until every submitted task, including tasks submitted by other tasks, has finished.
+ */
+void ThreadPool::wait()
+{
+    unique_lock<mutex> lock(m_idleLock);
+
+    c_done.wait(lock, [this] () { return m_pending == 0; });
+}
+
+/*** Queries ***/
+
+/**
+ * @brief ThreadPool::currentWorker Fetches the index of the calling worker within its pool. Useful for indexing per-worker data.
+ * @return The index, in [0, getThreadCount()), or -1 if the caller isn't a worker.
+ */
+int ThreadPool::currentWorker()
+{
+    return t_worker;
+}
+
+/*** Private methods ***/
+
+/**
+ * @brief ThreadPool::run The main loop of a worker. Runs tasks until the pool stops, sleeping while there are none.
+ * @param m_id The worker's index.
+ */
+void ThreadPool::run(int m_id)
+{
+    Task task; // Task being run
+
+    t_pool = this;
+    t_worker = m_id;
+
+    for ( ; ; )
+    {
+        if (takeTask(m_id, task)) // Found work
+        {
+            task();
+            task = Task(); // Release whatever the task holds before sleeping
+
+            if (--m_pending == 0) // That was the last task
+            {
+                lock_guard<mutex> lock(m_idleLock);
+                c_done.notify_all();
+            }
+        }
+
+        else // Nothing to do, sleep until a task is queued
+        {
+            unique_lock<mutex> lock(m_idleLock);
+
+            c_wake.wait(lock, [this] () { return m_queued > 0 || m_stop; });
+
+            if (m_stop && m_queued == 0) // Shutting down, and nothing left to run
+            {
+                return;
+            }
+        }
+    }
+}
+
+/**
+ * @brief ThreadPool::takeTask Takes the newest task from the worker's own queue or, if that is empty, the oldest task from the
+ * first other worker which has any, starting with the next worker along.
+ * @param m_id The worker's index.
+ * @param m_task Receives the task.
+ * @return True if a task was found, false if every queue was empty.
+ */
+bool ThreadPool::takeTask(int m_id, Task& m_task)
+{
+    int n = c_workers.size(); // # of queues
+    int i; // Queue counter
+    Worker* w; // Queue being checked
+
+    for (i = 0; i < n; i++) // Own queue first, then the others
+    {
+        w = c_workers[(m_id + i) % n].get();
+        lock_guard<mutex> lock(w->lock);
+
+        if (!w->tasks.empty())
+        {
+            if (i == 0) // Our own queue: newest first
+            {
+                m_task = move(w->tasks.back());
+                w->tasks.pop_back();
+            }
+
+            else // Steal: oldest first
+            {
+                m_task = move(w->tasks.front());
+                w->tasks.pop_front();
+            }
+
+            m_queued--;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,67 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+/* C++ Headers */
+#include <atomic> // Task counters
+#include <condition_variable> // Sleeping workers
+#include <deque> // Task queues
+#include <functional> // Tasks
+#include <memory> // unique_ptr
+#include <mutex> // Queue locks
+#include <thread> // Worker threads
+#include <vector> // STL vectors
+
+using namespace std;
+
+/**
+ * @brief The ThreadPool class. A fixed set of worker threads which run tasks, balanced by work stealing. Each worker has its
+ * own queue: it takes its newest task first (which is usually still in its cache), and when its queue is empty it steals the
+ * oldest task from another worker. Tasks submitted by a worker go onto that worker's own queue, so tasks which split or
+ * resubmit themselves stay local until another worker runs out of work.
+ *
+ * Doesn't depend on Qt, so it can be used by headless tools.
+ */
+class ThreadPool
+{
+    public:
+        typedef function<void()> Task; // A unit of work
+
+        /* Constructor/destructor */
+        explicit ThreadPool(int m_nThreads = 0); // Starts the given # of workers, or one per core if 0
+        ~ThreadPool(); // Waits for the queued tasks to finish, then stops the workers
+
+        /* Tasks */
+        void submit(Task m_task); // Queues a task. May be called from inside a task.
+        void wait(); // Blocks until every submitted task has finished. Must not be called from inside a task.
+
+        /* Queries */
+        int getThreadCount() const { return c_threads.size(); } // Fetches the # of workers
+        static int currentWorker(); // Fetches the index of the calling worker, or -1 if not called from a worker of any pool
+
+    private:
+        /**
+         * @brief The Worker struct. A worker's task queue. Its owner uses the back, thieves use the front.
+         */
+        struct Worker
+        {
+            mutex lock; // Guards the queue
+            deque<Task> tasks; // Queued tasks
+        };
+
+        /* Helpers */
+        void run(int m_id); // Main loop of a worker thread
+        bool takeTask(int m_id, Task& m_task); // Takes a task from the worker's own queue, or steals one
+
+        /* Data */
+        vector<unique_ptr<Worker>> c_workers; // One queue per worker
+        vector<thread> c_threads; // The worker threads
+        mutex m_idleLock; // Guards sleeping and waiting
+        condition_variable c_wake; // Signalled when a task is queued, or when the pool is stopping
+        condition_variable c_done; // Signalled when the last pending task finishes
+        atomic<int> m_queued; // # of tasks sitting in queues
+        atomic<int> m_pending; // # of tasks queued or running
+        atomic<unsigned> m_next; // Queue which the next task from outside the pool goes onto
+        bool m_stop; // True once the pool is shutting down. Guarded by m_idleLock.
+};
+
+#endif // THREADPOOL_HPP
@@ -0,0 +1,196 @@
+#include "trace.hpp"
+
+/* STL Headers */
+#include <atomic> // Lock-free buffer list and event counts
+#include <chrono> // steady_clock
+#include <cstdio> // fopen(), fprintf()
+
+using namespace std; // To save some typing
+
+/* Defines */
+#define TRACE_BLOCK_EVENTS 4096 // Events per block of a thread's buffer
+
+/*** Types ***/
+
+/**
+ * @brief The TraceBlock struct. A fixed-size block of events. Only the owning thread writes to it; count tells readers how
+ * many events are complete.
+ */
+struct TraceBlock
+{
+    TraceEvent events[TRACE_BLOCK_EVENTS]; // The events
+    atomic<size_t> count; // # of events written
+    atomic<TraceBlock*> next; // Next block, once this one is full
+
+    TraceBlock() : count(0), next(0) {}
+};
+
+/**
+ * @brief The TraceBuffer struct. One thread's events, as a list of blocks. Buffers are never freed, so that events recorded by
+ * threads which have since exited can still be written out.
+ */
+struct TraceBuffer
+{
+    int tid; // Thread # in the trace, in order of the threads' first events
+    TraceBlock* head; // First block
+    TraceBlock* tail; // Block being written. Only used by the owning thread.
+    TraceBuffer* next; // Next buffer in the list of all buffers
+};
+
+/*** Data ***/
+static atomic<TraceBuffer*> s_buffers(0); // List of every thread's buffer, newest first
+static atomic<int> s_nextTid(0); // Thread # of the next thread to record an event
+static thread_local TraceBuffer* t_buffer = 0; // Calling thread's buffer, if it has recorded anything
+
+/*** Helpers ***/
+
+/**
+ * @brief threadBuffer Fetches the calling thread's buffer, creating it and adding it to the list of buffers on first use.
+ * @return The calling thread's buffer.
+ */
+static TraceBuffer* threadBuffer()
+{
+    TraceBuffer* buffer = t_buffer; // The buffer
+
+    if (buffer == 0) // First event on this thread
+    {
+        buffer = new TraceBuffer();
+        buffer->tid = s_nextTid.fetch_add(1, memory_order_relaxed);
+        buffer->head = new TraceBlock();
+        buffer->tail = buffer->head;
+        buffer->next = s_buffers.load(memory_order_relaxed);
+
+        while (!s_buffers.compare_exchange_weak(buffer->next, buffer, memory_order_release, memory_order_relaxed)) // Push onto the list
+        {
+        }
+
+        t_buffer = buffer;
+    }
+
+    return buffer;
+}
+
+/*** Recording ***/
+
+/**
+ * @brief Trace::now Fetches the time since the trace started, which is the first time this is called.
+ * @return Nanoseconds since the trace started.
+ */
+uint64_t Trace::now()
+{
+    static const chrono::steady_clock::time_point epoch = chrono::steady_clock::now(); // Start of the trace
+
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - epoch).count();
+}
+
+/**
+ * @brief Trace::record Appends an event to the calling thread's buffer. Takes no locks; a new block is allocated once every
+ * TRACE_BLOCK_EVENTS events.
+ * @param m_name Name of the phase or counter. Must outlive the trace.
+ * @param m_phase 'X' for a timed phase, 'C' for a counter.
+ * @param m_start Start of the phase, or time of the counter, from now().
+ * @param m_length Duration of the phase in nanoseconds.
+ * @param m_value Value of the counter.
+ */
+void Trace::record(const char* m_name, char m_phase, uint64_t m_start, uint64_t m_length, int64_t m_value)
+{
+    TraceBuffer* buffer = threadBuffer(); // Calling thread's buffer
+    TraceBlock* block = buffer->tail; // Block being written
+    size_t n = block->count.load(memory_order_relaxed); // # of events already in the block
+    TraceEvent* e; // Event being written
+
+    if (n == TRACE_BLOCK_EVENTS) // Block is full
+    {
+        TraceBlock* fresh = new TraceBlock(); // Next block
+
+        block->next.store(fresh, memory_order_release);
+        buffer->tail = fresh;
+        block = fresh;
+        n = 0;
+    }
+
+    e = &block->events[n];
+    e->name = m_name;
+    e->phase = m_phase;
+    e->start = m_start;
+    e->length = m_length;
+    e->value = m_value;
+    block->count.store(n + 1, memory_order_release); // Publish the event
+}
+
+/*** Output ***/
+
+/**
+ * @brief Trace::writeChromeJson Writes every event recorded so far, on every thread, to a file in the Chrome trace event
+ * format. Threads may keep recording while this runs; events recorded after their block was read are left out.
+ * @param m_path Path of the file to write.
+ * @return True if the file was written, false if it couldn't be opened.
+ */
+bool Trace::writeChromeJson(const char* m_path)
+{
+    FILE* out = fopen(m_path, "w"); // Output file
+    const char* sep = ""; // Separator before the next event
+    TraceBuffer* buffer; // Buffer being written
+    TraceBlock* block; // Block being written
+    size_t n; // # of events in the block
+    size_t i; // Event counter
+
+    if (out == 0) // Couldn't open the file
+    {
+        return false;
+    }
+
+    fprintf(out, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+
+    for (buffer = s_buffers.load(memory_order_acquire); buffer != 0; buffer = buffer->next) // Loop through the threads
+    {
+        fprintf(out, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"thread %d\"}}", sep, buffer->tid, buffer->tid);
+        sep = ",";
+
+        for (block = buffer->head; block != 0; block = block->next.load(memory_order_acquire)) // Loop through the thread's blocks
+        {
+            n = block->count.load(memory_order_acquire);
+
+            for (i = 0; i < n; i++) // Loop through the block's events
+            {
+                const TraceEvent& e = block->events[i];
+
+                if (e.phase == 'X') // Timed phase. Times are in microseconds.
+                {
+                    fprintf(out, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+                            e.name, buffer->tid, e.start / 1000.0, e.length / 1000.0);
+                }
+
+                else // Counter
+                {
+                    fprintf(out, ",\n{\"name\": \"%s\", \"ph\": \"C\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"args\": {\"value\": %lld}}",
+                            e.name, buffer->tid, e.start / 1000.0, (long long)e.value);
+                }
+            }
+        }
+    }
+
+    fprintf(out, "\n]}\n");
+    return fclose(out) == 0;
+}
+
+/**
+ * @brief Trace::getEventCount Fetches the # of events recorded so far, on every thread.
+ * @return The # of events.
+ */
+size_t Trace::getEventCount()
+{
+    size_t total = 0; // Running total
+    TraceBuffer* buffer; // Buffer being counted
+    TraceBlock* block; // Block being counted
+
+    for (buffer = s_buffers.load(memory_order_acquire); buffer != 0; buffer = buffer->next)
+    {
+        for (block = buffer->head; block != 0; block = block->next.load(memory_order_acquire))
+        {
+            total += block->count.load(memory_order_acquire);
+        }
+    }
+
+    return total;
+}
@@ -0,0 +1,78 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+/* C++ Headers */
+#include <cstddef> // size_t
+#include <cstdint> // int64_t, uint64_t
+
+using namespace std;
+
+/*
+ * Hot-path tracing. Code marks the phases it wants timed with TRACE_SCOPE, and the counts it wants recorded with
+ * TRACE_COUNTER. Unless SAMEGAME_TRACE is defined (qmake CONFIG+=trace), both macros expand to nothing, so the arguments aren't
+ * even evaluated and the release build pays nothing for them.
+ *
+ * When tracing is on, each thread appends its events to a buffer of its own, so recording takes no locks and doesn't share
+ * cache lines with other threads. A buffer only grows by being handed a new block when the current one fills up, and events
+ * are published to readers by an atomic count, so Trace::writeChromeJson() can run while other threads are still recording.
+ * The output is the Chrome trace event format, which chrome://tracing and Perfetto can open.
+ *
+ * Names must be string literals, or otherwise outlive the trace: only the pointer is stored.
+ */
+
+/**
+ * @brief The TraceEvent struct. One recorded event: a timed phase, or a counter value.
+ */
+struct TraceEvent
+{
+    const char* name; // Name of the phase or counter
+    char phase; // 'X' for a timed phase, 'C' for a counter
+    uint64_t start; // Nanoseconds since the trace started
+    uint64_t length; // Duration of a timed phase in nanoseconds, 0 for a counter
+    int64_t value; // Value of a counter, 0 for a timed phase
+};
+
+/**
+ * @brief The Trace class. The process-wide collection of per-thread event buffers.
+ */
+class Trace
+{
+    public:
+        /* Recording */
+        static uint64_t now(); // Fetches the # of nanoseconds since the trace started
+        static void record(const char* m_name, char m_phase, uint64_t m_start, uint64_t m_length, int64_t m_value); // Appends an event to the calling thread's buffer
+
+        /* Output */
+        static bool writeChromeJson(const char* m_path); // Writes every event recorded so far to a file, as Chrome trace JSON
+        static size_t getEventCount(); // Fetches the # of events recorded so far, on all threads
+};
+
+/**
+ * @brief The TraceScope class. Records a timed phase from its construction to its destruction.
+ */
+class TraceScope
+{
+    public:
+        explicit TraceScope(const char* m_name) : m_name(m_name), m_start(Trace::now()) {} // Starts timing the phase
+        ~TraceScope() { Trace::record(m_name, 'X', m_start, Trace::now() - m_start, 0); } // Records the phase
+
+    private:
+        TraceScope(const TraceScope&); // Not copyable
+        TraceScope& operator=(const TraceScope&);
+
+        const char* m_name; // Name of the phase
+        uint64_t m_start; // When the phase started
+};
+
+/* Macros. The only part of the trace which hot code should use. */
+#ifdef SAMEGAME_TRACE
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name) // Times the rest of the enclosing block
+#define TRACE_COUNTER(name, value) Trace::record((name), 'C', Trace::now(), 0, (value)) // Records a counter's value
+#else
+#define TRACE_SCOPE(name) do {} while (0)
+#define TRACE_COUNTER(name, value) do {} while (0)
+#endif
+
+#endif // TRACE_HPP
@@ -0,0 +1,185 @@
+#include "transpositiontable.hpp"
+
+using namespace std; // To save some typing
+
+/*** Constants ***/
+const int TranspositionTable::BUCKET_SIZE; // Definition, so that the constant can be passed by reference
+
+/* Layout of a packed entry: gain in bits 0-31, x in 32-43, y in 44-55, level+1 in 56-63. A level of 0 means an empty slot. */
+#define TT_COORD_MAX 0xFFF // Largest coord which fits in 12 bits
+#define TT_LEVEL_MAX 0xFE // Deepest level which fits in 8 bits, once 1 is added
+
+/*** Constructor ***/
+
+/**
+ * @brief TranspositionTable::TranspositionTable Constructor. Creates an empty table. The # of buckets is the largest power of
+ * 2 which fits in the memory limit, with at least one bucket.
+ * @param m_maxBytes The memory limit for the slots.
+ */
+TranspositionTable::TranspositionTable(size_t m_maxBytes) :
+    m_nBuckets(1),
+    m_probes(0),
+    m_hits(0),
+    m_stores(0)
+{
+    while (m_nBuckets * 2 * BUCKET_SIZE * sizeof(Slot) <= m_maxBytes) // Double until the next size wouldn't fit
+    {
+        m_nBuckets *= 2;
+    }
+
+    c_slots.reset(new Slot[m_nBuckets * BUCKET_SIZE]);
+    clear();
+}
+
+/*** Access ***/
+
+/**
+ * @brief TranspositionTable::probe Looks a position up.
+ * @param m_hash The position's Zobrist hash.
+ * @param m_entry Receives the entry, if one is found.
+ * @return True if an entry for the position was found.
+ */
+bool TranspositionTable::probe(uint64_t m_hash, TTEntry& m_entry)
+{
+    Slot* bucket = &c_slots[(m_hash & (m_nBuckets - 1)) * BUCKET_SIZE]; // Bucket the position belongs in
+    uint64_t data; // Packed entry in a slot
+    int i; // Slot counter
+
+    m_probes.fetch_add(1, memory_order_relaxed);
+
+    for (i = 0; i < BUCKET_SIZE; i++) // Check each slot
+    {
+        data = bucket[i].data.load(memory_order_relaxed);
+
+        if (data != 0 && (bucket[i].check.load(memory_order_relaxed) ^ data) == m_hash) // Filled in, for this position, and not torn
+        {
+            m_hits.fetch_add(1, memory_order_relaxed);
+            m_entry = unpack(data);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief TranspositionTable::store Records what a search found about a position. If the table already holds a deeper entry for
+ * the position, the new one is dropped.
+ * @param m_hash The position's Zobrist hash.
+ * @param m_entry The entry.
+ */
+void TranspositionTable::store(uint64_t m_hash, const TTEntry& m_entry)
+{
+    Slot* bucket = &c_slots[(m_hash & (m_nBuckets - 1)) * BUCKET_SIZE]; // Bucket the position belongs in
+    Slot* victim = bucket; // Slot to overwrite
+    uint64_t data; // Packed entry in a slot
+    uint64_t packed; // Packed new entry
+    int i; // Slot counter
+
+    if (m_entry.move.x < 0 || m_entry.move.x > TT_COORD_MAX || m_entry.move.y < 0 || m_entry.move.y > TT_COORD_MAX) // Doesn't fit
+    {
+        return;
+    }
+
+    packed = pack(m_entry);
+
+    for (i = 0; i < BUCKET_SIZE; i++) // Look for this position, or the least useful slot
+    {
+        data = bucket[i].data.load(memory_order_relaxed);
+
+        if (data != 0 && (bucket[i].check.load(memory_order_relaxed) ^ data) == m_hash) // Already have this position
+        {
+            if (levelOf(data) > levelOf(packed)) // Keep the deeper entry
+            {
+                return;
+            }
+
+            victim = &bucket[i];
+            break;
+        }
+
+        if (levelOf(data) < levelOf(victim->data.load(memory_order_relaxed))) // Shallower (empty slots are shallowest of all)
+        {
+            victim = &bucket[i];
+        }
+    }
+
+    victim->data.store(packed, memory_order_relaxed);
+    victim->check.store(m_hash ^ packed, memory_order_relaxed);
+    m_stores.fetch_add(1, memory_order_relaxed);
+}
+
+/**
+ * @brief TranspositionTable::clear Empties every slot and resets the counters. Must not be called while other threads use the
+ * table.
+ */
+void TranspositionTable::clear()
+{
+    size_t i; // Slot counter
+
+    for (i = 0; i < getCapacity(); i++)
+    {
+        c_slots[i].data.store(0, memory_order_relaxed);
+        c_slots[i].check.store(0, memory_order_relaxed);
+    }
+
+    m_probes = 0;
+    m_hits = 0;
+    m_stores = 0;
+}
+
+/*** Statistics ***/
+
+/**
+ * @brief TranspositionTable::getHitRate Fetches the fraction of lookups which found an entry.
+ * @return Hits / probes, or 0 if nothing was looked up.
+ */
+double TranspositionTable::getHitRate() const
+{
+    uint64_t probes = getProbes(); // # of lookups
+
+    return (probes > 0) ? double(getHits()) / probes : 0;
+}
+
+/*** Helpers ***/
+
+/**
+ * @brief TranspositionTable::pack Packs an entry into a word. Levels deeper than the largest storable level are stored as it.
+ * @param m_entry The entry. Its coords must fit in 12 bits.
+ * @return The packed entry. Never 0.
+ */
+uint64_t TranspositionTable::pack(const TTEntry& m_entry)
+{
+    uint64_t level = (m_entry.level < 0) ? 0 : (m_entry.level > TT_LEVEL_MAX) ? TT_LEVEL_MAX : m_entry.level; // Clamped level
+
+    return uint64_t(uint32_t(m_entry.gain))
+           | uint64_t(m_entry.move.x) << 32
+           | uint64_t(m_entry.move.y) << 44
+           | (level + 1) << 56;
+}
+
+/**
+ * @brief TranspositionTable::unpack Unpacks a word into an entry.
+ * @param m_data The packed entry.
+ * @return The entry.
+ */
+TTEntry TranspositionTable::unpack(uint64_t m_data)
+{
+    TTEntry entry; // Unpacked entry
+
+    entry.gain = int32_t(uint32_t(m_data));
+    entry.move.x = (m_data >> 32) & TT_COORD_MAX;
+    entry.move.y = (m_data >> 44) & TT_COORD_MAX;
+    entry.level = levelOf(m_data);
+    return entry;
+}
+
+/**
+ * @brief TranspositionTable::levelOf Fetches the level of a packed entry.
+ * @param m_data The packed entry.
+ * @return The level, or -1 for an empty slot.
+ */
+int TranspositionTable::levelOf(uint64_t m_data)
+{
+    return int(m_data >> 56) - 1;
+}
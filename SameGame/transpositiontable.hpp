@@ -0,0 +1,82 @@
+#ifndef TRANSPOSITIONTABLE_HPP
+#define TRANSPOSITIONTABLE_HPP
+
+/* C++ Headers */
+#include <atomic> // Lock-free slots and counters
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+#include <memory> // unique_ptr
+
+/* My headers */
+#include "position.hpp" // Moves
+
+using namespace std;
+
+/**
+ * @brief The TTEntry struct. What the table knows about a position: the best line found from it, as its first move and the
+ * points it gains, and the level of the search which found it.
+ */
+struct TTEntry
+{
+    int gain; // Points scored by the best line from the position, not counting points scored before it
+    Move move; // First move of the best line
+    int level; // Level of the search which found the line. Deeper searches are trusted more.
+};
+
+/**
+ * @brief The TranspositionTable class. A fixed-size hash table from Zobrist hashes of positions to TTEntry records, which can
+ * be shared by search threads without locks.
+ *
+ * Each slot holds two 64-bit words: the entry packed into one word, and the hash XORed with that word. Both are written and
+ * read with separate atomic operations, so a reader can see a slot halfway through a write, but then the check word won't
+ * match the hash and the slot is treated as a miss. Slots are grouped into buckets of 4, which fill one cache line. A new entry
+ * replaces an entry for the same position only if its level is at least as deep; otherwise it replaces the bucket's shallowest
+ * entry.
+ *
+ * Moves are stored in 12 bits per coord, so entries for moves beyond column or row 4095 are not stored.
+ */
+class TranspositionTable
+{
+    public:
+        /* Constructor */
+        explicit TranspositionTable(size_t m_maxBytes); // Creates an empty table which uses at most the given # of bytes
+
+        /* Access */
+        bool probe(uint64_t m_hash, TTEntry& m_entry); // Looks a position up. Returns true and fills in the entry if found.
+        void store(uint64_t m_hash, const TTEntry& m_entry); // Records what a search found about a position
+        void clear(); // Empties the table and resets the counters
+
+        /* Statistics */
+        size_t getCapacity() const { return m_nBuckets * BUCKET_SIZE; } // Fetches the # of slots
+        size_t getBytes() const { return getCapacity() * sizeof(Slot); } // Fetches the memory used by the slots
+        uint64_t getProbes() const { return m_probes.load(memory_order_relaxed); } // Fetches the # of lookups
+        uint64_t getHits() const { return m_hits.load(memory_order_relaxed); } // Fetches the # of lookups which found an entry
+        uint64_t getStores() const { return m_stores.load(memory_order_relaxed); } // Fetches the # of entries written
+        double getHitRate() const; // Fetches hits / probes, or 0 if nothing was looked up
+
+    private:
+        static const int BUCKET_SIZE = 4; // Slots per bucket
+
+        /**
+         * @brief The Slot struct. One entry: the packed entry, and the hash XORed with it.
+         */
+        struct Slot
+        {
+            atomic<uint64_t> check; // Hash ^ data
+            atomic<uint64_t> data; // Packed entry, or 0 if the slot is empty
+        };
+
+        /* Helpers */
+        static uint64_t pack(const TTEntry& m_entry); // Packs an entry into a word
+        static TTEntry unpack(uint64_t m_data); // Unpacks a word into an entry
+        static int levelOf(uint64_t m_data); // Fetches the level of a packed entry
+
+        /* Data */
+        unique_ptr<Slot[]> c_slots; // The slots, bucket by bucket
+        size_t m_nBuckets; // # of buckets. Always a power of 2.
+        atomic<uint64_t> m_probes; // # of lookups
+        atomic<uint64_t> m_hits; // # of lookups which found an entry
+        atomic<uint64_t> m_stores; // # of entries written
+};
+
+#endif // TRANSPOSITIONTABLE_HPP
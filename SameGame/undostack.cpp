@@ -0,0 +1,111 @@
+#include "undostack.hpp"
+
+/* My headers */
+#include "zobrist.hpp" // Hash deltas
+
+using namespace std; // To save some typing
+
+/*** Constructor ***/
+
+/**
+ * @brief UndoStack::UndoStack Constructor. Creates an empty history.
+ */
+UndoStack::UndoStack() :
+    m_top(0)
+{
+}
+
+/*** History ***/
+
+/**
+ * @brief UndoStack::push Records a move which was just played. Any moves which were undone can no longer be redone.
+ * @param m_changes The cells the move changed, as produced by BoardGrid::compact().
+ * @param m_points The points the move scored.
+ * @param m_cell The board index of the clicked block.
+ */
+void UndoStack::push(const vector<CellChange>& m_changes, int m_points, int m_cell)
+{
+    UndoStep step; // The move
+
+    if (m_top < c_steps.size()) // Drop the undone moves and their changes
+    {
+        c_changes.resize(c_steps[m_top].first);
+        c_steps.resize(m_top);
+    }
+
+    step.first = c_changes.size();
+    step.count = m_changes.size();
+    step.points = m_points;
+    step.cell = m_cell;
+    step.hashDelta = zobristUpdate(0, m_changes);
+
+    c_changes.insert(c_changes.end(), m_changes.begin(), m_changes.end());
+    c_steps.push_back(step);
+    m_top++;
+}
+
+/**
+ * @brief UndoStack::undo Reverts the last move which hasn't been undone, by writing back the colour each of its cells had
+ * before it.
+ * @param m_board The board the move was played on, as it is after the move.
+ * @return The move's step, which tells the caller how many points to take back and which cells changed, or 0 if there is
+ * nothing to undo. Valid until the next push() or clear().
+ */
+const UndoStep* UndoStack::undo(BoardGrid& m_board)
+{
+    const UndoStep* step; // The move
+    const CellChange* change; // One of its changes
+    size_t i; // Change counter
+
+    if (m_top == 0) // Nothing to undo
+    {
+        return 0;
+    }
+
+    step = &c_steps[--m_top];
+    change = getChanges(*step);
+
+    for (i = 0; i < step->count; i++)
+    {
+        m_board.setCell(change[i].index, change[i].before);
+    }
+
+    return step;
+}
+
+/**
+ * @brief UndoStack::redo Replays the last move which was undone, by writing the colour each of its cells had after it.
+ * @param m_board The board, as it is before the move.
+ * @return The move's step, or 0 if there is nothing to redo. Valid until the next push() or clear().
+ */
+const UndoStep* UndoStack::redo(BoardGrid& m_board)
+{
+    const UndoStep* step; // The move
+    const CellChange* change; // One of its changes
+    size_t i; // Change counter
+
+    if (m_top == c_steps.size()) // Nothing to redo
+    {
+        return 0;
+    }
+
+    step = &c_steps[m_top++];
+    change = getChanges(*step);
+
+    for (i = 0; i < step->count; i++)
+    {
+        m_board.setCell(change[i].index, change[i].after);
+    }
+
+    return step;
+}
+
+/**
+ * @brief UndoStack::clear Forgets every move, keeping the memory for reuse.
+ */
+void UndoStack::clear()
+{
+    c_steps.clear();
+    c_changes.clear();
+    m_top = 0;
+}
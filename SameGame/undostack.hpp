@@ -0,0 +1,60 @@
+#ifndef UNDOSTACK_HPP
+#define UNDOSTACK_HPP
+
+/* C++ Headers */
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+#include <vector> // STL vectors
+
+/* My headers */
+#include "boardgrid.hpp" // Boards and cell changes
+
+using namespace std;
+
+/**
+ * @brief The UndoStep struct. One move on an UndoStack: where its cell changes are stored, and what else it changed.
+ */
+struct UndoStep
+{
+    size_t first; // Index of the move's first change in the stack's change list
+    size_t count; // # of cells the move changed
+    int points; // Points the move scored
+    int cell; // Board index of the clicked block
+    uint64_t hashDelta; // XOR of the board's Zobrist hash before and after the move
+};
+
+/**
+ * @brief The UndoStack class. Undo and redo history for a board, stored as the cells each move changed. A move's delta is the
+ * CellChange list which BoardGrid::compact() produced for it: the removed group and every block which fell or slid, each with
+ * its colour before and after. Undoing writes the "before" colours back and redoing writes the "after" colours, so both take
+ * time and memory in proportion to the cells the move changed, never to the size of the board.
+ *
+ * All moves' changes share one list, so pushing a move doesn't allocate once the list has grown. Doesn't depend on Qt, so
+ * Game uses it for the player's undo and redo, and search code uses it (through Position) to unmake moves instead of copying
+ * the board.
+ */
+class UndoStack
+{
+    public:
+        /* Constructor */
+        UndoStack(); // Creates an empty history
+
+        /* History */
+        void push(const vector<CellChange>& m_changes, int m_points, int m_cell); // Records a move which was just played, and forgets any undone moves
+        const UndoStep* undo(BoardGrid& m_board); // Reverts the last move's cells. Returns its step, or 0 if there is nothing to undo.
+        const UndoStep* redo(BoardGrid& m_board); // Replays the last undone move's cells. Returns its step, or 0 if there is nothing to redo.
+        void clear(); // Forgets every move
+
+        /* Queries */
+        bool canUndo() const { return m_top > 0; } // True if a move can be undone
+        bool canRedo() const { return m_top < c_steps.size(); } // True if an undone move can be redone
+        size_t getUndoCount() const { return m_top; } // Fetches the # of moves which can be undone
+        const CellChange* getChanges(const UndoStep& m_step) const { return c_changes.data() + m_step.first; } // Fetches a step's cell changes
+
+    private:
+        vector<UndoStep> c_steps; // Every recorded move, oldest first. Those from m_top on have been undone.
+        vector<CellChange> c_changes; // Every recorded move's cell changes, one move after another
+        size_t m_top; // # of moves which haven't been undone
+};
+
+#endif // UNDOSTACK_HPP
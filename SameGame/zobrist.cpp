@@ -0,0 +1,43 @@
+#include "zobrist.hpp"
+
+using namespace std; // To save some typing
+
+/**
+ * @brief zobristHash Hashes a whole board from scratch.
+ * @param m_board The board.
+ * @return The XOR of the keys of every occupied cell.
+ */
+uint64_t zobristHash(const BoardGrid& m_board)
+{
+    uint64_t hash = 0; // Hash so far
+    int x; // Column counter
+    int y; // Row counter
+    int i; // Index of the current cell
+
+    for (y = 0; y < m_board.getRows(); y++) // Loop through the rows
+    {
+        for (x = 0; x < m_board.getCols(); x++) // Loop through the columns
+        {
+            i = m_board.index(x, y);
+            hash ^= zobristKey(i, m_board.cell(i));
+        }
+    }
+
+    return hash;
+}
+
+/**
+ * @brief zobristUpdate Updates a board's hash with the cells changed by a move, as recorded by BoardGrid::compact().
+ * @param m_hash The board's hash before the move.
+ * @param m_changes The cells changed by the move.
+ * @return The board's hash after the move.
+ */
+uint64_t zobristUpdate(uint64_t m_hash, const vector<CellChange>& m_changes)
+{
+    for (vector<CellChange>::const_iterator it = m_changes.begin(); it != m_changes.end(); it++) // Loop through the changed cells
+    {
+        m_hash ^= zobristKey(it->index, it->before) ^ zobristKey(it->index, it->after); // Swap the old colour's key for the new one's
+    }
+
+    return m_hash;
+}
@@ -0,0 +1,40 @@
+#ifndef ZOBRIST_HPP
+#define ZOBRIST_HPP
+
+/* C++ Headers */
+#include <cstdint> // uint64_t
+#include <vector> // STL vectors
+
+/* My headers */
+#include "boardgrid.hpp" // Board being hashed
+
+using namespace std;
+
+/*
+ * Zobrist hashing of boards. Every (cell, colour) pair has a random 64-bit key, and a board's hash is the XOR of the keys of its
+ * occupied cells. A move only has to XOR out the old keys and XOR in the new keys of the cells it changed, so hashes are kept up
+ * to date in time proportional to the # of changed cells. Empty cells have a key of 0.
+ *
+ * The keys are computed from the cell's index and colour with the splitmix64 finaliser rather than read from a table, so boards
+ * of any size share the same keys, and two boards of the same size and contents always get the same hash.
+ */
+
+/**
+ * @brief zobristKey Fetches the key of a colour in a cell.
+ * @param m_i The board index of the cell.
+ * @param m_colour The colour.
+ * @return The key, or 0 for an empty cell.
+ */
+inline uint64_t zobristKey(int m_i, Cell m_colour)
+{
+    uint64_t z = (uint64_t(m_i) << 8 | m_colour) * 0x9E3779B97F4A7C15ULL; // splitmix64, from the cell's index and colour
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return (m_colour == BoardGrid::EMPTY) ? 0 : z ^ (z >> 31);
+}
+
+uint64_t zobristHash(const BoardGrid& m_board); // Hashes a whole board
+uint64_t zobristUpdate(uint64_t m_hash, const vector<CellChange>& m_changes); // Updates a hash with the cells changed by a move
+
+#endif // ZOBRIST_HPP
@@ -0,0 +1,13 @@
+# Benchmark for the Game model. Links the model only (QtCore and QtGui, for QColor), not the widgets.
+
+TARGET = engine
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+QT = core gui
+
+SOURCES += main.cpp
+
+QMAKE_CXXFLAGS += -std=c++11
+
+include(../../SameGame/model.pri)
@@ -0,0 +1,419 @@
+/*
+ * Benchmark for the Game model. For each board size, a game is created from a fixed seed and timed through its public
+ * interface: board set-up (the constructor, which runs initBoard()), bulk generation with BoardGenerator, removeBlock(), isGameOver() (which answers noMovesLeft()),
+ * isBoardEmpty() and getLegalMoves(). compactBoard() is private, so it is timed as the BoardGrid::compact() call it makes, on a copy of the
+ * game's board, for the same moves, and on standard sizes also as the fixed-size BoardT kernel which Game runs there instead.
+ *
+ * Random playouts from the starting board, as the solver runs them, are timed on each of the search backends which fits the
+ * board: Position, and BitPosition for boards with at most BITPOSITION_MAX_ROWS rows.
+ *
+ * Results go to stdout, or to a file, as JSON or CSV, so that runs on different commits can be compared. In a build with
+ * tracing (qmake CONFIG+=trace), --trace writes the per-move phases and counters as Chrome trace JSON.
+ *
+ * Usage: engine [--format json|csv] [--out FILE] [--max-size N] [--colours K] [--trace FILE]
+ */
+
+/* My headers */
+#include "game.hpp" // Model being measured
+#include "boardgenerator.hpp" // Bulk board generation
+#include "bitposition.hpp" // Bitboard search backend
+#include "boardgrid.hpp" // Board, for timing compaction on its own
+#include "boardt.hpp" // Fixed-size compaction
+#include "position.hpp" // Search backend on a board of cells
+#include "trace.hpp" // Chrome trace output
+
+/* STL headers */
+#include <algorithm> // min(), max()
+#include <chrono> // steady_clock
+#include <cstdint> // uint32_t
+#include <cstdio> // fprintf(), fopen()
+#include <cstdlib> // atoi()
+#include <cstring> // strcmp()
+#include <vector> // vector
+
+using namespace std;
+
+typedef chrono::steady_clock Clock; // Clock for all timings
+
+/**
+ * @brief The Result struct. One measurement.
+ */
+struct Result
+{
+    const char* bench; // What was measured
+    int size; // Board side
+    int colours; // # of colours
+    unsigned seed; // Seed the game was created from
+    long long ops; // # of operations timed
+    double nsPerOp; // Average time per operation
+};
+
+/**
+ * @brief elapsedNs Fetches the time since the given point.
+ * @return Nanoseconds since m_start.
+ */
+static double elapsedNs(Clock::time_point m_start)
+{
+    return chrono::duration<double, nano>(Clock::now() - m_start).count();
+}
+
+/**
+ * @brief nextRandom A small xorshift generator for picking cells to click. Independent of the game's own generator.
+ * @param m_state The generator's state. Must not be 0.
+ * @return The next random number.
+ */
+static uint32_t nextRandom(uint32_t& m_state)
+{
+    m_state ^= m_state << 13;
+    m_state ^= m_state >> 17;
+    m_state ^= m_state << 5;
+    return m_state;
+}
+
+/**
+ * @brief timePlayouts Times random playouts, as Solver runs them: list the legal moves, play a random one, until none are left.
+ * @param m_board The starting board.
+ * @param m_reps # of playouts.
+ * @param m_seed Seed for picking the moves.
+ * @return Average time per playout, in nanoseconds.
+ */
+template<class Pos>
+static double timePlayouts(const BoardGrid& m_board, int m_reps, uint32_t m_seed)
+{
+    Pos root(m_board); // Starting position
+    Pos pos; // Position being played out
+    vector<Move> moves; // Legal moves
+    uint32_t rng = m_seed; // Picks the moves
+    volatile int sink = 0; // Stops the compiler from dropping the playouts
+    int n; // # of legal moves
+    int reps; // Repetition counter
+    Clock::time_point start = Clock::now(); // Start of the timing
+
+    for (reps = 0; reps < m_reps; reps++)
+    {
+        pos.assign(root);
+
+        while ((n = pos.legalMoves(moves)) > 0) // Loop until the game is over
+        {
+            pos.play(moves[nextRandom(rng) % n]);
+        }
+
+        sink = sink + pos.getScore();
+    }
+
+    return elapsedNs(start) / m_reps;
+}
+
+/**
+ * @brief benchSize Runs every measurement on boards of one size.
+ * @param m_size The board side.
+ * @param m_colours The # of colours.
+ * @param m_results Receives the results.
+ */
+static void benchSize(int m_size, int m_colours, vector<Result>& m_results)
+{
+    unsigned seed = 1000 + m_size; // Fixed seed for this size
+    int initReps = 400000 / (m_size * m_size) + 1; // Roughly the same amount of work for every size
+    int genCount = 40000000 / (m_size * m_size) + 1; // Boards to generate in bulk
+    int maxMoves = 200; // Moves to time per game
+    int maxTries = 50 * m_size * m_size + 1000; // Clicks to try before giving up on finding a movable block
+    int reps; // Repetition counter
+    int moves = 0; // # of moves timed
+    int tries; // # of clicks tried
+    int x; // Column of a click
+    int y; // Row of a click
+    int n; // # of blocks in the clicked group
+    Cell colour; // Colour of the clicked group
+    uint32_t rng = seed; // Picks the clicks
+    double removeNs = 0; // Total time in removeBlock()
+    double compactNs = 0; // Total time in BoardGrid::compact()
+    double fixedNs = 0; // Total time in the fixed-size compaction kernel
+    BoardKernels kernels; // Fixed-size kernels for this size, if it is a standard one
+    bool haveKernels = boardKernelsFor(m_size, m_size, kernels); // True if it is
+    double ns; // Time for the current measurement
+    volatile bool sink = false; // Stops the compiler from dropping calls
+    Clock::time_point start; // Start of the current timing
+    vector<int> work; // Scratch for the flood fill
+    vector<int> removed; // Cells removed by the flood fill
+    vector<CellChange> changes; // Cells changed by the compaction
+    vector<Cell> column; // Scratch for the compaction
+    Result r; // Result being recorded
+
+    r.size = m_size;
+    r.colours = m_colours;
+    r.seed = seed;
+
+    /* initBoard(), through the constructor */
+    start = Clock::now();
+
+    for (reps = 0; reps < initReps; reps++)
+    {
+        Game g(m_size, m_size, m_colours, seed);
+        sink = g.isBoardEmpty() != sink;
+    }
+
+    r.bench = "init_board";
+    r.ops = initReps;
+    r.nsPerOp = elapsedNs(start) / initReps;
+    m_results.push_back(r);
+
+    /* The same boards, generated in bulk on every core */
+    BoardGenerator generator(m_size, m_size, m_colours);
+
+    start = Clock::now();
+    generator.generate(seed, genCount);
+    r.bench = "generate_board";
+    r.ops = genCount;
+    r.nsPerOp = elapsedNs(start) / genCount;
+    m_results.push_back(r);
+
+    /* removeBlock() and compaction, on the same moves */
+    Game game(m_size, m_size, m_colours, seed);
+    BoardGrid grid = game.getBoard(); // Kept in step with the game, for timing compact() on its own
+    BoardGrid fixed = grid; // The same, for timing the fixed-size kernel
+
+    for (tries = 0; tries < maxTries && moves < maxMoves && !game.isGameOver(); tries++)
+    {
+        x = nextRandom(rng) % m_size;
+        y = nextRandom(rng) % m_size;
+
+        if (game.getGroupSize(x, y) < 2) // Not a legal move
+        {
+            continue;
+        }
+
+        colour = Cell(game.getBlockColour(x, y)); // Fetched before the move, which changes the block at (x, y)
+        start = Clock::now();
+        n = game.removeBlock(x, y);
+        removeNs += elapsedNs(start);
+        game.clearChangedBlocks(); // As the window does after each move
+
+        grid.floodRemove(grid.index(x, y), work, removed, BoardGrid::REMOVED);
+        int lo = m_size; // Columns which lost blocks
+        int hi = -1;
+
+        for (vector<int>::const_iterator it = removed.begin(); it != removed.end(); it++)
+        {
+            lo = min(lo, grid.xOf(*it));
+            hi = max(hi, grid.xOf(*it));
+        }
+
+        start = Clock::now();
+        grid.compact(lo, hi, colour, changes, column);
+        compactNs += elapsedNs(start);
+
+        if (haveKernels)
+        {
+            fixed.floodRemove(fixed.index(x, y), work, removed, BoardGrid::REMOVED);
+            start = Clock::now();
+            kernels.compact(fixed.data(), lo, hi, colour, changes);
+            fixedNs += elapsedNs(start);
+        }
+
+        sink = (n == 0) != sink;
+        moves++;
+    }
+
+    if (moves > 0)
+    {
+        r.bench = "remove_block";
+        r.ops = moves;
+        r.nsPerOp = removeNs / moves;
+        m_results.push_back(r);
+
+        r.bench = "compact_board";
+        r.nsPerOp = compactNs / moves;
+        m_results.push_back(r);
+
+        if (haveKernels)
+        {
+            r.bench = "compact_board_fixed";
+            r.nsPerOp = fixedNs / moves;
+            m_results.push_back(r);
+        }
+    }
+
+    /* noMovesLeft(), through isGameOver(), and isBoardEmpty(), on the board left after the moves */
+    reps = 1000000;
+    start = Clock::now();
+
+    for (int i = 0; i < reps; i++)
+    {
+        sink = game.isGameOver() != sink;
+    }
+
+    ns = elapsedNs(start);
+    r.bench = "no_moves_left";
+    r.ops = reps;
+    r.nsPerOp = ns / reps;
+    m_results.push_back(r);
+
+    reps = 20000000 / (m_size * m_size) + 1;
+    start = Clock::now();
+
+    for (int i = 0; i < reps; i++)
+    {
+        sink = game.isBoardEmpty() != sink;
+    }
+
+    ns = elapsedNs(start);
+    r.bench = "is_board_empty";
+    r.ops = reps;
+    r.nsPerOp = ns / reps;
+    m_results.push_back(r);
+
+    /* getLegalMoves(), on the same board, into a buffer allocated once */
+    vector<LegalMove> legal(game.getLegalMoveCount() + 1); // Big enough for every move
+    reps = 20000000 / (m_size * m_size) + 1;
+    start = Clock::now();
+
+    for (int i = 0; i < reps; i++)
+    {
+        sink = (game.getLegalMoves(legal.data(), legal.size()) == 0) != sink;
+    }
+
+    ns = elapsedNs(start);
+    r.bench = "list_moves";
+    r.ops = reps;
+    r.nsPerOp = ns / reps;
+    m_results.push_back(r);
+
+    /* Random playouts from the starting board, on each search backend which fits it */
+    if (m_size > 100) // Too slow to be worth it
+    {
+        return;
+    }
+
+    Game fresh(m_size, m_size, m_colours, seed); // The starting board again
+    reps = 200000000 / (m_size * m_size * m_size * m_size) + 1; // A playout lists moves over the whole board, once per move
+    r.ops = reps;
+
+    r.bench = "playout_position";
+    r.nsPerOp = timePlayouts<Position>(fresh.getBoard(), reps, seed);
+    m_results.push_back(r);
+
+    if (m_size <= BITPOSITION_MAX_ROWS)
+    {
+        r.bench = "playout_bitposition";
+        r.nsPerOp = timePlayouts<BitPosition>(fresh.getBoard(), reps, seed);
+        m_results.push_back(r);
+    }
+}
+
+/**
+ * @brief writeResults Writes the results as JSON or CSV.
+ * @param m_out File to write to.
+ * @param m_results The results.
+ * @param m_csv True for CSV, false for JSON.
+ */
+static void writeResults(FILE* m_out, const vector<Result>& m_results, bool m_csv)
+{
+    size_t i; // Result counter
+
+    if (m_csv)
+    {
+        fprintf(m_out, "bench,rows,cols,colours,seed,ops,ns_per_op\n");
+
+        for (i = 0; i < m_results.size(); i++)
+        {
+            const Result& r = m_results[i];
+            fprintf(m_out, "%s,%d,%d,%d,%u,%lld,%.1f\n", r.bench, r.size, r.size, r.colours, r.seed, r.ops, r.nsPerOp);
+        }
+    }
+
+    else
+    {
+        fprintf(m_out, "{\n  \"results\": [\n");
+
+        for (i = 0; i < m_results.size(); i++)
+        {
+            const Result& r = m_results[i];
+            fprintf(m_out, "    {\"bench\": \"%s\", \"rows\": %d, \"cols\": %d, \"colours\": %d, \"seed\": %u, \"ops\": %lld, \"ns_per_op\": %.1f}%s\n",
+                    r.bench, r.size, r.size, r.colours, r.seed, r.ops, r.nsPerOp, (i + 1 < m_results.size()) ? "," : "");
+        }
+
+        fprintf(m_out, "  ]\n}\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int sizes[] = { 5, 10, 15, 25, 50, 100, 250, 500, 1000, 2000 }; // Board sides to measure
+    int maxSize = 2000; // Largest side to measure
+    int colours = 5; // # of colours
+    bool csv = false; // Output format
+    const char* outPath = 0; // Output file, or 0 for stdout
+    const char* tracePath = 0; // Trace file, or 0 for none
+    FILE* out = stdout; // Output stream
+    vector<Result> results; // Everything measured
+    size_t s; // Size counter
+    int i; // Argument counter
+
+    for (i = 1; i < argc; i++) // Parse the arguments
+    {
+        if (strcmp(argv[i], "--format") == 0 && i+1 < argc)
+        {
+            csv = strcmp(argv[++i], "csv") == 0;
+        }
+
+        else if (strcmp(argv[i], "--out") == 0 && i+1 < argc)
+        {
+            outPath = argv[++i];
+        }
+
+        else if (strcmp(argv[i], "--max-size") == 0 && i+1 < argc)
+        {
+            maxSize = atoi(argv[++i]);
+        }
+
+        else if (strcmp(argv[i], "--colours") == 0 && i+1 < argc)
+        {
+            colours = atoi(argv[++i]);
+        }
+
+        else if (strcmp(argv[i], "--trace") == 0 && i+1 < argc)
+        {
+            tracePath = argv[++i];
+        }
+
+        else
+        {
+            fprintf(stderr, "usage: %s [--format json|csv] [--out FILE] [--max-size N] [--colours K] [--trace FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]) && sizes[s] <= maxSize; s++) // Loop through the board sizes
+    {
+        fprintf(stderr, "%dx%d...\n", sizes[s], sizes[s]); // Progress
+        benchSize(sizes[s], colours, results);
+    }
+
+    if (outPath != 0 && (out = fopen(outPath, "w")) == 0) // Couldn't open the output file
+    {
+        perror(outPath);
+        return 1;
+    }
+
+    writeResults(out, results, csv);
+
+    if (tracePath != 0)
+    {
+#ifdef SAMEGAME_TRACE
+        if (!Trace::writeChromeJson(tracePath))
+        {
+            perror(tracePath);
+            return 1;
+        }
+#else
+        fprintf(stderr, "%s: built without tracing, rebuild with CONFIG+=trace\n", argv[0]);
+#endif
+    }
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+
+    return 0;
+}
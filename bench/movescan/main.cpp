@@ -0,0 +1,133 @@
+/*
+ * Benchmark for the game-over scan. Times the old per-cell check (nested vectors, a vector of neighbours per cell) against
+ * each of the scan kernels, on boards which have no moves left, so that every scan has to look at every cell.
+ */
+
+/* My headers */
+#include "boardgrid.hpp" // Board
+#include "movescan.hpp" // Kernels being measured
+
+/* STL headers */
+#include <chrono> // steady_clock
+#include <cstdio> // printf()
+#include <utility> // pair
+#include <vector> // vector
+
+using namespace std;
+
+typedef bool (*ScanFunc)(const Cell*, int, int, int); // A scan kernel
+
+/**
+ * @brief colourAt Colour of a cell on a board with no moves: neighbours in a row differ by 1 (mod 3), and neighbours in a
+ * column by 2 (mod 3), so no two neighbours ever match.
+ */
+static int colourAt(int m_x, int m_y)
+{
+    return 1 + (m_x + 2*m_y) % 3;
+}
+
+/**
+ * @brief oldNoMovesLeft The game-over check as Game used to do it, minus the logging: every cell builds a vector of its
+ * neighbours and compares their colours through vector::at().
+ */
+static bool oldNoMovesLeft(const vector<vector<int>>& m_board)
+{
+    int rows = m_board.size(); // # of rows
+    int cols = m_board[0].size(); // # of columns
+    int r; // Row counter
+    int c; // Column counter
+    vector<pair<int, int>> adj; // Neighbours of the current cell
+
+    for (r = 0; r < rows; r++)
+    {
+        for (c = 0; c < cols; c++)
+        {
+            if (m_board.at(r).at(c) != 0) // Not empty
+            {
+                adj.clear();
+                vector<pair<int, int>>().swap(adj); // The old code allocated a fresh vector for every cell
+
+                if (c > 0) adj.push_back(pair<int, int>(r, c-1));
+                if (c < cols-1) adj.push_back(pair<int, int>(r, c+1));
+                if (r > 0) adj.push_back(pair<int, int>(r-1, c));
+                if (r < rows-1) adj.push_back(pair<int, int>(r+1, c));
+
+                for (vector<pair<int, int>>::iterator it = adj.begin(); it != adj.end(); it++)
+                {
+                    if (m_board.at(it->first).at(it->second) == m_board.at(r).at(c))
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief timeIt Runs a function repeatedly and returns the average time per call.
+ * @return Nanoseconds per call.
+ */
+template <typename F>
+static double timeIt(F m_func, int m_reps)
+{
+    int i; // Repetition counter
+    volatile bool sink = false; // Stops the compiler from dropping the calls
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    for (i = 0; i < m_reps; i++)
+    {
+        sink = m_func() != sink;
+    }
+
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / m_reps;
+}
+
+int main()
+{
+    const int sizes[] = { 15, 100, 1000 }; // Board sizes to measure
+    const char* names[] = { "scalar", "sse2", "avx2" }; // Kernel names
+    ScanFunc kernels[] = { scanForMoveScalar, scanForMoveSSE2, scanForMoveAVX2 }; // Kernels
+    int s; // Size counter
+    int k; // Kernel counter
+    int n; // Board side
+    int x; // Column counter
+    int y; // Row counter
+    int reps; // # of times to run each scan
+    double oldNs; // Time taken by the old check
+    double ns; // Time taken by a kernel
+
+    printf("dispatch kernel: %s\n", scanForMoveKernelName());
+    printf("%-10s %-8s %14s %10s\n", "size", "method", "ns/scan", "speedup");
+
+    for (s = 0; s < 3; s++) // Loop through the board sizes
+    {
+        n = sizes[s];
+        BoardGrid grid(n, n);
+        vector<vector<int>> nested(n, vector<int>(n, 0));
+
+        for (y = 0; y < n; y++) // Fill both boards with the same colours
+        {
+            for (x = 0; x < n; x++)
+            {
+                grid.set(x, y, colourAt(x, y));
+                nested[y][x] = colourAt(x, y);
+            }
+        }
+
+        reps = 20000000 / (n*n) + 1; // Roughly the same amount of work for every size
+        oldNs = timeIt([&]() { return oldNoMovesLeft(nested); }, reps / 20 + 1);
+        printf("%4dx%-5d %-8s %14.0f %9.1fx\n", n, n, "old", oldNs, 1.0);
+
+        for (k = 0; k < 3; k++) // Loop through the kernels
+        {
+            ScanFunc kernel = kernels[k];
+            ns = timeIt([&]() { return kernel(grid.data(), grid.index(0, 0), grid.index(n-1, n-1) + 1, grid.getStride()); }, reps);
+            printf("%4dx%-5d %-8s %14.0f %9.1fx\n", n, n, names[k], ns, oldNs / ns);
+        }
+    }
+
+    return 0;
+}
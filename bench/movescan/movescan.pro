@@ -0,0 +1,12 @@
+# Benchmark for the game-over scan. Compares the old per-cell check with the scan kernels in movescan.cpp.
+
+TARGET = movescan
+TEMPLATE = app
+CONFIG += console
+CONFIG -= qt app_bundle
+
+SOURCES += main.cpp
+
+QMAKE_CXXFLAGS += -std=c++11
+
+include(../../SameGame/engine.pri)
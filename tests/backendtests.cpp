@@ -0,0 +1,111 @@
+/*
+ * Search backend tests. BitPosition must play exactly as Position does: random games are played on both, including clicks on
+ * empty cells, single blocks and cells off the board, and after every move both must list the same moves in the same order and
+ * agree on the blocks removed, the board, the score, the hash and whether the game is over.
+ */
+
+/* My headers */
+#include "tests.hpp" // Checks and boards
+#include "bitposition.hpp" // Backend under test
+#include "position.hpp" // Reference backend
+#include "rng.hpp" // Picking moves
+
+/* STL headers */
+#include <vector> // STL vectors
+
+using namespace std;
+
+/**
+ * @brief sameMoves Compares two move lists.
+ * @param m_a A list.
+ * @param m_b Another list.
+ * @return True if they hold the same moves in the same order.
+ */
+static bool sameMoves(const vector<Move>& m_a, const vector<Move>& m_b)
+{
+    size_t i; // Move counter
+
+    if (m_a.size() != m_b.size())
+    {
+        return false;
+    }
+
+    for (i = 0; i < m_a.size(); i++)
+    {
+        if (m_a[i].x != m_b[i].x || m_a[i].y != m_b[i].y)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief testBitPosition Plays random games on Position and BitPosition side by side, on boards up to the tallest a BitPosition
+ * can hold.
+ */
+static void testBitPosition()
+{
+    static const int sizes[][3] = { { 1, 1, 1 }, { 5, 5, 3 }, { 15, 15, 5 }, { 20, 7, 4 }, { 63, 3, 2 }, { 64, 9, 6 }, { 2, 40, 3 } }; // Rows, columns, colours
+    BoardGrid start; // Starting board
+    BoardGrid stored; // BitPosition's board
+    vector<Move> moves; // Position's legal moves
+    vector<Move> bitMoves; // BitPosition's legal moves
+    Move move; // A move or a random click
+    Rng rng(12); // Picks the moves
+    size_t k; // Size counter
+    int game; // Game counter
+    int rows; // # of rows
+    int cols; // # of columns
+    int bad = 0; // # of moves after which the two differed
+
+    for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++)
+    {
+        rows = sizes[k][0];
+        cols = sizes[k][1];
+
+        for (game = 0; game < 20; game++)
+        {
+            makeBoard(rows, cols, sizes[k][2], game, start);
+            Position position(start); // Reference
+            BitPosition bits(start); // Under test
+
+            while (true)
+            {
+                bits.store(stored);
+                bad += position.legalMoves(moves) != bits.legalMoves(bitMoves) || !sameMoves(moves, bitMoves)
+                        || !sameCells(position.getBoard(), stored) || position.getScore() != bits.getScore()
+                        || position.getHash() != bits.getHash() || position.isOver() != bits.isOver();
+
+                if (moves.empty() || bad > 0) // Game over, or they already differ
+                {
+                    break;
+                }
+
+                if (rng.below(4) == 0) // A random click, often illegal, sometimes off the board
+                {
+                    move.x = int(rng.below(cols + 2)) - 1;
+                    move.y = int(rng.below(rows + 2)) - 1;
+                }
+
+                else
+                {
+                    move = moves[rng.below(moves.size())];
+                }
+
+                bad += position.play(move) != bits.play(move);
+            }
+        }
+    }
+
+    CHECK(bad == 0);
+}
+
+/**
+ * @brief testBackends Runs the search backend tests.
+ */
+void testBackends()
+{
+    testBitPosition();
+}
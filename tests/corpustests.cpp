@@ -0,0 +1,287 @@
+/*
+ * Puzzle corpus tests. A corpus of boards of mixed sizes is written and read back, then every truncation of it, hostile
+ * trailers and index entries, and entries with impossible sizes or cells are opened. Corpus must refuse them, in open() or
+ * when the entry is read, without reading outside the file.
+ */
+
+/* My headers */
+#include "tests.hpp" // Checks and boards
+#include "corpus.hpp" // Format under test
+#include "zobrist.hpp" // Board hashes
+
+/* STL headers */
+#include <cstdio> // remove()
+#include <cstring> // memcpy()
+#include <vector> // STL vectors
+
+using namespace std;
+
+/* Defines */
+#define CORPUS_TEST_FILE "samegame-tests.sgc" // Scratch file, in the working directory
+
+/**
+ * @brief loadsSafely Opens a corpus which may be corrupt, and reads every entry it claims to have.
+ * @param m_bytes The corpus.
+ * @return True if the corpus was accepted, and every entry which could be read is a board of the size and # of colours its
+ * header claims.
+ */
+static bool loadsSafely(const vector<uint8_t>& m_bytes)
+{
+    Corpus corpus; // The corpus
+    CorpusEntry entry; // An entry's metadata
+    BoardGrid board; // An entry's board
+    size_t i; // Entry counter
+    int x; // Column counter
+    int y; // Row counter
+    bool valid = true; // False once a bad board has been read
+
+    if (!writeFile(CORPUS_TEST_FILE, m_bytes, m_bytes.size()) || corpus.open(CORPUS_TEST_FILE) != 0) // Refused
+    {
+        return false;
+    }
+
+    for (i = 0; i < corpus.getCount(); i++)
+    {
+        if (corpus.getEntry(i, entry) && corpus.load(i, board)) // Readable, so it has to make sense
+        {
+            valid = valid && board.getRows() == int(entry.header.rows) && board.getCols() == int(entry.header.cols);
+
+            for (y = 0; valid && y < board.getRows(); y++)
+            {
+                for (x = 0; x < board.getCols(); x++)
+                {
+                    valid = valid && board.at(x, y) <= entry.header.nColours;
+                }
+            }
+        }
+    }
+
+    CHECK(valid);
+    return true;
+}
+
+/**
+ * @brief writeCorpus Writes a corpus of boards of mixed sizes, some with moves played, and reads the file back.
+ * @param m_boards Receives the boards, in the order they were written.
+ * @param m_bytes Receives the file.
+ * @return False if the corpus couldn't be written.
+ */
+static bool writeCorpus(vector<BoardGrid>& m_boards, vector<uint8_t>& m_bytes)
+{
+    CorpusWriter writer; // The corpus
+    BoardGrid board; // A board being written
+    int k; // Board counter
+
+    m_boards.clear();
+
+    if (!writer.open(CORPUS_TEST_FILE))
+    {
+        return false;
+    }
+
+    for (k = 0; k < 24; k++)
+    {
+        makeBoard(1 + k % 16, 1 + (k * 7) % 19, 1 + k % 15, 1000 + k, board);
+        playMoves(board, k % 3 * 10, k);
+        writer.add(board, 1 + k % 15, 1000 + k, k * 3, k % 2 ? k * 100 : -1);
+        m_boards.push_back(board);
+    }
+
+    return writer.close() && readFile(CORPUS_TEST_FILE, m_bytes);
+}
+
+/**
+ * @brief testRoundTrip Checks that every board in a corpus reads back with its metadata.
+ */
+static void testRoundTrip()
+{
+    vector<BoardGrid> boards; // Boards written
+    vector<uint8_t> bytes; // The file
+    Corpus corpus; // The file, opened
+    CorpusEntry entry; // An entry's metadata
+    BoardGrid loaded; // An entry's board
+    size_t k; // Board counter
+    int bad = 0; // # of boards which didn't read back
+
+    if (!CHECK(writeCorpus(boards, bytes)) || !CHECK(corpus.open(CORPUS_TEST_FILE) == 0))
+    {
+        return;
+    }
+
+    CHECK(corpus.getCount() == boards.size());
+    CHECK(!corpus.getEntry(boards.size(), entry) && !corpus.load(boards.size(), loaded));
+
+    for (k = 0; k < boards.size(); k++) // In reverse too, since entries are read in any order
+    {
+        bad += !corpus.getEntry(k, entry) || !corpus.load(k, loaded) || !sameCells(boards[k], loaded)
+                || entry.header.nColours != 1 + k % 15 || entry.header.seed != 1000 + k || entry.header.points != int(k * 3)
+                || entry.header.best != (k % 2 ? int(k * 100) : -1) || entry.header.hash != zobristHash(boards[k]);
+        bad += !corpus.load(boards.size() - 1 - k, loaded) || !sameCells(boards[boards.size() - 1 - k], loaded);
+    }
+
+    CHECK(bad == 0);
+}
+
+/**
+ * @brief testTruncated Checks that every proper prefix of a corpus is refused.
+ */
+static void testTruncated()
+{
+    vector<BoardGrid> boards; // Boards written
+    vector<uint8_t> bytes; // The file
+    vector<uint8_t> prefix; // A prefix of it
+    size_t n; // # of bytes kept
+    int bad = 0; // # of prefixes which were accepted
+
+    if (!CHECK(writeCorpus(boards, bytes)))
+    {
+        return;
+    }
+
+    for (n = 0; n < bytes.size(); n++)
+    {
+        prefix.assign(bytes.begin(), bytes.begin() + n);
+        bad += loadsSafely(prefix);
+    }
+
+    CHECK(bad == 0);
+    CHECK(loadsSafely(bytes));
+}
+
+/**
+ * @brief withTrailer Fetches a copy of a corpus with its trailer changed.
+ * @param m_in The corpus.
+ * @param m_indexOffset The new index offset.
+ * @param m_count The new # of entries.
+ * @return The changed copy.
+ */
+static vector<uint8_t> withTrailer(const vector<uint8_t>& m_in, uint64_t m_indexOffset, uint64_t m_count)
+{
+    vector<uint8_t> out(m_in); // The copy
+    CorpusTrailer trailer; // Its trailer
+
+    memcpy(&trailer, out.data() + out.size() - sizeof(trailer), sizeof(trailer));
+    trailer.indexOffset = m_indexOffset;
+    trailer.count = m_count;
+    memcpy(out.data() + out.size() - sizeof(trailer), &trailer, sizeof(trailer));
+    return out;
+}
+
+/**
+ * @brief testHostileTrailers Checks that trailers whose index doesn't fit the file are refused, including offsets inside the
+ * trailer itself, which once wrapped the index size around to nearly 2^64 entries.
+ */
+static void testHostileTrailers()
+{
+    vector<BoardGrid> boards; // Boards written
+    vector<uint8_t> bytes; // The file
+    CorpusTrailer trailer; // Its trailer
+    uint64_t size; // Its size
+    uint64_t offset; // A hostile index offset
+
+    if (!CHECK(writeCorpus(boards, bytes)))
+    {
+        return;
+    }
+
+    memcpy(&trailer, bytes.data() + bytes.size() - sizeof(trailer), sizeof(trailer));
+    size = bytes.size();
+
+    for (offset = size - sizeof(trailer) + 8; offset <= size + 8; offset += 8) // Inside the trailer, or past the end
+    {
+        CHECK(!loadsSafely(withTrailer(bytes, offset, 0)));
+        CHECK(!loadsSafely(withTrailer(bytes, offset, (size - sizeof(trailer) - offset) / 8)));
+    }
+
+    CHECK(!loadsSafely(withTrailer(bytes, trailer.indexOffset + 4, trailer.count))); // Unaligned
+    CHECK(!loadsSafely(withTrailer(bytes, 0, trailer.count))); // Over the header
+    CHECK(!loadsSafely(withTrailer(bytes, uint64_t(-8), trailer.count)));
+    CHECK(!loadsSafely(withTrailer(bytes, trailer.indexOffset, trailer.count + 1)));
+    CHECK(!loadsSafely(withTrailer(bytes, trailer.indexOffset, uint64_t(1) << 61))); // count * 8 would wrap to 0
+    CHECK(loadsSafely(withTrailer(bytes, size - sizeof(trailer), 0))); // An empty index is a valid, empty corpus
+}
+
+/**
+ * @brief testHostileEntries Points index entries at places which aren't entries, and gives entries impossible sizes, # of
+ * colours and cells. The corpus still opens, but those entries can't be read.
+ */
+static void testHostileEntries()
+{
+    vector<BoardGrid> boards; // Boards written
+    vector<uint8_t> bytes; // The file
+    vector<uint8_t> bad; // A changed copy
+    CorpusTrailer trailer; // Its trailer
+    CorpusEntryHeader header; // The first entry's header
+    uint64_t offset; // A hostile entry offset
+    Corpus corpus; // A changed copy, opened
+    CorpusEntry entry; // Its first entry
+    BoardGrid board; // Its first board
+    size_t k; // Case counter
+
+    if (!CHECK(writeCorpus(boards, bytes)))
+    {
+        return;
+    }
+
+    memcpy(&trailer, bytes.data() + bytes.size() - sizeof(trailer), sizeof(trailer));
+    memcpy(&header, bytes.data() + sizeof(CorpusHeader), sizeof(header));
+    const uint64_t offsets[] = { 0, 4, trailer.indexOffset - 8, trailer.indexOffset, bytes.size(), uint64_t(-1) }; // Not entries
+
+    for (k = 0; k < sizeof(offsets) / sizeof(offsets[0]); k++) // The first index entry points elsewhere
+    {
+        bad = bytes;
+        offset = offsets[k];
+        memcpy(bad.data() + trailer.indexOffset, &offset, sizeof(offset));
+
+        if (CHECK(writeFile(CORPUS_TEST_FILE, bad, bad.size()) && corpus.open(CORPUS_TEST_FILE) == 0))
+        {
+            CHECK(!corpus.getEntry(0, entry) && !corpus.load(0, board));
+            CHECK(corpus.load(1, board) && sameCells(boards[1], board)); // The others are unaffected
+            corpus.close();
+        }
+    }
+
+    for (k = 0; k < 5; k++) // The first entry's header is impossible
+    {
+        CorpusEntryHeader h = header; // The changed header
+
+        switch (k)
+        {
+            case 0: h.rows = 16384; h.cols = 16384; break; // Allowed, but its cells would run past the file
+            case 1: h.rows = 0x80000000u; break;
+            case 2: h.nColours = 0; break;
+            case 3: h.nColours = 16; break;
+            default: h.cols = 0x7FFFFFFFu; break;
+        }
+
+        bad = bytes;
+        memcpy(bad.data() + sizeof(CorpusHeader), &h, sizeof(h));
+
+        if (CHECK(writeFile(CORPUS_TEST_FILE, bad, bad.size()) && corpus.open(CORPUS_TEST_FILE) == 0))
+        {
+            CHECK(!corpus.load(0, board));
+            corpus.close();
+        }
+    }
+
+    bad = bytes; // The first board has one colour, so a cell of colour 2 is invalid
+    bad[sizeof(CorpusHeader) + sizeof(CorpusEntryHeader)] = 0x22;
+
+    if (CHECK(header.nColours == 1 && writeFile(CORPUS_TEST_FILE, bad, bad.size()) && corpus.open(CORPUS_TEST_FILE) == 0))
+    {
+        CHECK(corpus.getEntry(0, entry) && !corpus.load(0, board));
+        corpus.close();
+    }
+}
+
+/**
+ * @brief testCorpus Runs the puzzle corpus tests.
+ */
+void testCorpus()
+{
+    testRoundTrip();
+    testTruncated();
+    testHostileTrailers();
+    testHostileEntries();
+    remove(CORPUS_TEST_FILE);
+}
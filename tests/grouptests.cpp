@@ -0,0 +1,269 @@
+/*
+ * Group index tests. Random games are played the way Game plays them: the group is flood-filled and the board compacted, by
+ * BoardGrid or by the fixed-size kernels on standard sizes, then GroupIndex::update() relabels only the columns which changed.
+ * After every move the index must describe the same groups as one rebuilt from scratch, and list the same moves.
+ */
+
+/* My headers */
+#include "tests.hpp" // Checks and boards
+#include "groupindex.hpp" // Index under test
+#include "rng.hpp" // Picking moves
+
+/* STL headers */
+#include <algorithm> // min(), max()
+#include <map> // Matching labels
+#include <vector> // STL vectors
+
+using namespace std;
+
+/**
+ * @brief removeGroup Plays a move exactly as Game::removeBlock() does: the group is marked REMOVED, and the board compacted.
+ * @param m_board The board.
+ * @param m_kernels The fixed-size kernels to use, or 0 to use BoardGrid's operations.
+ * @param m_x The column of a block in the group.
+ * @param m_y The row of a block in the group.
+ * @param m_changes Receives the cells which changed.
+ * @param m_loCol Receives the leftmost column which changed.
+ * @param m_hiCol Receives the rightmost column which changed.
+ * @return The # of blocks removed. 0 if the block was empty or on its own, in which case nothing changed.
+ */
+int removeGroup(BoardGrid& m_board, const BoardKernels* m_kernels, int m_x, int m_y, vector<CellChange>& m_changes, int& m_loCol, int& m_hiCol)
+{
+    vector<int> work; // Fill stack
+    vector<int> removed; // Removed cells
+    vector<Cell> column; // Compaction scratch space
+    Cell colour = m_board.at(m_x, m_y); // The group's colour
+    int last; // Rightmost column compaction changed
+    size_t i; // Cell counter
+
+    m_changes.clear();
+    m_loCol = m_board.getCols();
+    m_hiCol = -1;
+
+    if (colour == BoardGrid::EMPTY || (m_board.at(m_x-1, m_y) != colour && m_board.at(m_x+1, m_y) != colour
+                                       && m_board.at(m_x, m_y-1) != colour && m_board.at(m_x, m_y+1) != colour)) // Not a group
+    {
+        return 0;
+    }
+
+    if (m_kernels != 0)
+    {
+        m_kernels->floodRemove(m_board.data(), m_board.index(m_x, m_y), removed, BoardGrid::REMOVED);
+    }
+
+    else
+    {
+        m_board.floodRemove(m_board.index(m_x, m_y), work, removed, BoardGrid::REMOVED);
+    }
+
+    for (i = 0; i < removed.size(); i++)
+    {
+        m_loCol = min(m_loCol, m_board.xOf(removed[i]));
+        m_hiCol = max(m_hiCol, m_board.xOf(removed[i]));
+    }
+
+    last = m_kernels != 0 ? m_kernels->compact(m_board.data(), m_loCol, m_hiCol, colour, m_changes)
+                          : m_board.compact(m_loCol, m_hiCol, colour, m_changes, column);
+    m_hiCol = max(m_hiCol, last);
+    return removed.size();
+}
+
+/**
+ * @brief sameGroups Compares an index with one rebuilt from scratch. Labels may differ, so they are matched one to one.
+ * @param m_board The board.
+ * @param m_index The index kept up to date for it.
+ * @return True if both indices put the same cells in the same groups, with the same sizes, and count the same movable groups.
+ */
+bool sameGroups(const BoardGrid& m_board, const GroupIndex& m_index)
+{
+    GroupIndex fresh; // Index built from scratch
+    map<int, int> toFresh; // Label in m_index of each label in fresh
+    map<int, int> fromFresh; // Label in fresh of each label in m_index
+    int x; // Column counter
+    int y; // Row counter
+    int i; // Index of a cell
+
+    fresh.rebuild(m_board);
+
+    if (fresh.getMovableCount() != m_index.getMovableCount())
+    {
+        return false;
+    }
+
+    for (y = 0; y < m_board.getRows(); y++)
+    {
+        for (x = 0; x < m_board.getCols(); x++)
+        {
+            i = m_board.index(x, y);
+
+            if ((m_index.getLabel(i) == 0) != (m_board.cell(i) == BoardGrid::EMPTY) || m_index.getGroupSize(i) != fresh.getGroupSize(i)
+                    || toFresh.insert(make_pair(m_index.getLabel(i), fresh.getLabel(i))).first->second != fresh.getLabel(i)
+                    || fromFresh.insert(make_pair(fresh.getLabel(i), m_index.getLabel(i))).first->second != m_index.getLabel(i)) // Split or merged groups
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief listsMoves Checks an index's list of moves: one block of each movable group, with its size, colour and points.
+ * @param m_board The board.
+ * @param m_index The index.
+ * @param m_moves Receives the moves.
+ * @return True if the list is right.
+ */
+static bool listsMoves(const BoardGrid& m_board, GroupIndex& m_index, vector<LegalMove>& m_moves)
+{
+    map<int, int> seen; // Labels listed
+    int n; // # of moves listed
+    int i; // Move counter
+    int cell; // Index of a move's block
+
+    m_moves.resize(m_board.getRows() * m_board.getCols() / 2 + 1);
+    n = m_index.listMovable(m_board, m_moves.data(), m_moves.size());
+    m_moves.resize(max(0, n));
+
+    if (n != m_index.getMovableCount())
+    {
+        return false;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        cell = m_board.index(m_moves[i].x, m_moves[i].y);
+
+        if (!m_board.inBounds(m_moves[i].x, m_moves[i].y) || m_moves[i].size < 2 || m_moves[i].size != m_index.getGroupSize(cell)
+                || m_moves[i].colour != m_board.cell(cell) || m_moves[i].gain != m_moves[i].size * (m_moves[i].size + 1) / 2
+                || !seen.insert(make_pair(m_index.getLabel(cell), i)).second) // Wrong, or a group listed twice
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief testIncremental Plays random games on boards of several sizes, on both move paths, and compares the index with a
+ * rebuilt one after every move.
+ */
+static void testIncremental()
+{
+    static const int sizes[][3] = { { 5, 5, 3 }, { 10, 10, 4 }, { 15, 15, 5 }, { 20, 20, 6 }, { 1, 12, 2 }, { 12, 1, 2 }, { 9, 23, 3 } }; // Rows, columns, colours
+    BoardGrid board; // Board being played
+    BoardKernels kernels; // Its fixed-size kernels, if it has a standard size
+    GroupIndex index; // Its group index
+    vector<LegalMove> moves; // Moves the index lists
+    vector<CellChange> changes; // Cells a move changed
+    Rng rng(5); // Picks the moves
+    int lo; // Leftmost column a move changed
+    int hi; // Rightmost column a move changed
+    size_t k; // Size counter
+    int game; // Game counter
+    int path; // 0 for BoardGrid's operations, 1 for the kernels
+    int nMoves = 0; // # of moves played
+    int bad = 0; // # of moves after which the index was wrong
+
+    for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++)
+    {
+        for (path = 0; path <= int(boardKernelsFor(sizes[k][0], sizes[k][1], kernels)); path++)
+        {
+            for (game = 0; game < 30; game++)
+            {
+                makeBoard(sizes[k][0], sizes[k][1], sizes[k][2], game, board);
+                index.rebuild(board);
+                bad += !listsMoves(board, index, moves);
+
+                while (!moves.empty())
+                {
+                    const LegalMove& move = moves[rng.below(moves.size())]; // A random group
+
+                    if (removeGroup(board, path ? &kernels : 0, move.x, move.y, changes, lo, hi) != move.size) // Listed a move which isn't one
+                    {
+                        bad++;
+                        break;
+                    }
+
+                    index.update(board, lo, hi);
+                    nMoves++;
+
+                    if (!sameGroups(board, index) || !listsMoves(board, index, moves)) // Stop at the first wrong index, so the game can't get stuck
+                    {
+                        bad++;
+                        break;
+                    }
+                }
+
+                bad += moves.empty() && board.hasMoves();
+            }
+        }
+    }
+
+    CHECK(nMoves > 1000);
+    CHECK(bad == 0);
+}
+
+/**
+ * @brief testKernels Checks that the fixed-size kernels change the same cells as BoardGrid's operations, in the same order.
+ */
+static void testKernels()
+{
+    static const int standard[] = { 5, 10, 15, 20 }; // Sizes with kernels
+    BoardGrid board; // Board played with BoardGrid's operations
+    BoardGrid fixed; // The same board, played with the kernels
+    BoardKernels kernels; // The kernels
+    vector<CellChange> changes; // Cells BoardGrid's operations changed
+    vector<CellChange> fixedChanges; // Cells the kernels changed
+    Rng rng(9); // Picks the moves
+    int lo, hi, fixedLo, fixedHi; // Columns the moves changed
+    size_t k; // Size counter
+    size_t i; // Change counter
+    int game; // Game counter
+    int x, y; // A random cell
+    int bad = 0; // # of moves where the two differed
+
+    CHECK(!boardKernelsFor(15, 16, kernels) && !boardKernelsFor(7, 7, kernels));
+
+    for (k = 0; k < sizeof(standard) / sizeof(standard[0]); k++)
+    {
+        CHECK(boardKernelsFor(standard[k], standard[k], kernels));
+
+        for (game = 0; game < 30; game++)
+        {
+            makeBoard(standard[k], standard[k], 4, 100 + game, board);
+            fixed = board;
+
+            while (board.hasMoves())
+            {
+                x = rng.below(standard[k]);
+                y = rng.below(standard[k]);
+
+                if (removeGroup(board, 0, x, y, changes, lo, hi) != removeGroup(fixed, &kernels, x, y, fixedChanges, fixedLo, fixedHi)
+                        || lo != fixedLo || hi != fixedHi || changes.size() != fixedChanges.size() || !sameCells(board, fixed))
+                {
+                    bad++;
+                    break;
+                }
+
+                for (i = 0; i < changes.size(); i++)
+                {
+                    bad += changes[i].index != fixedChanges[i].index || changes[i].before != fixedChanges[i].before || changes[i].after != fixedChanges[i].after;
+                }
+            }
+        }
+    }
+
+    CHECK(bad == 0);
+}
+
+/**
+ * @brief testGroups Runs the group index tests.
+ */
+void testGroups()
+{
+    testIncremental();
+    testKernels();
+}
@@ -0,0 +1,171 @@
+/*
+ * Headless engine tests. Runs every suite declared in tests.hpp and prints how many checks failed. Exits with 1 if any did,
+ * so "make check" and CI runs fail with it.
+ *
+ * Uses only the engine, so it needs neither QtGui nor a display.
+ *
+ * Usage: samegame-tests
+ */
+
+/* My headers */
+#include "tests.hpp" // Suites
+#include "boardgenerator.hpp" // Test boards
+#include "position.hpp" // Playing moves on them
+#include "rng.hpp" // Picking the moves
+
+/* STL headers */
+#include <cstdio> // printf(), fopen()
+#include <vector> // STL vectors
+
+using namespace std;
+
+static int nChecks = 0; // # of checks run
+static int nFailed = 0; // # of checks which failed
+
+/**
+ * @brief checkThat Counts a check, and prints it if it failed.
+ * @param m_ok The outcome of the check.
+ * @param m_what The condition checked, as written.
+ * @param m_file The file the check is in.
+ * @param m_line The line the check is on.
+ * @return The outcome, so that callers can skip checks which depend on it.
+ */
+bool checkThat(bool m_ok, const char* m_what, const char* m_file, int m_line)
+{
+    nChecks++;
+
+    if (!m_ok)
+    {
+        printf("%s:%d: check failed: %s\n", m_file, m_line, m_what);
+        nFailed++;
+    }
+
+    return m_ok;
+}
+
+/**
+ * @brief makeBoard Generates the starting board which Game(rows, cols, nColours, seed) plays on.
+ * @param m_rows The # of rows.
+ * @param m_cols The # of columns.
+ * @param m_nColours The # of colours.
+ * @param m_seed The seed.
+ * @param m_board Receives the board. Resized to fit.
+ */
+void makeBoard(int m_rows, int m_cols, int m_nColours, uint64_t m_seed, BoardGrid& m_board)
+{
+    BoardGenerator generator(m_rows, m_cols, m_nColours); // Same generator as Game's
+
+    generator.generate(m_seed, 1, 1);
+    generator.copyTo(0, m_board);
+}
+
+/**
+ * @brief playMoves Plays random legal moves on a board, so that it has empty cells and dropped columns, as boards from games in
+ * progress do.
+ * @param m_board The board. Receives the position after the moves.
+ * @param m_nMoves The # of moves to play. Fewer are played if the game ends first.
+ * @param m_seed The seed the moves are picked with.
+ */
+void playMoves(BoardGrid& m_board, int m_nMoves, uint64_t m_seed)
+{
+    Position position(m_board); // Position being played
+    vector<Move> moves; // Legal moves in the current position
+    Rng rng(m_seed); // Picks the moves
+    int i; // Move counter
+
+    for (i = 0; i < m_nMoves && position.legalMoves(moves) > 0; i++)
+    {
+        position.play(moves[rng.below(moves.size())]);
+    }
+
+    m_board = position.getBoard();
+}
+
+/**
+ * @brief sameCells Compares two boards.
+ * @param m_a A board.
+ * @param m_b Another board.
+ * @return True if they have the same # of rows and columns, and every cell matches.
+ */
+bool sameCells(const BoardGrid& m_a, const BoardGrid& m_b)
+{
+    int x; // Column counter
+    int y; // Row counter
+
+    if (m_a.getRows() != m_b.getRows() || m_a.getCols() != m_b.getCols()) // Different sizes
+    {
+        return false;
+    }
+
+    for (y = 0; y < m_a.getRows(); y++)
+    {
+        for (x = 0; x < m_a.getCols(); x++)
+        {
+            if (m_a.at(x, y) != m_b.at(x, y))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief readFile Reads a whole file.
+ * @param m_path The file's path.
+ * @param m_bytes Receives its contents.
+ * @return False if it couldn't be read.
+ */
+bool readFile(const char* m_path, vector<uint8_t>& m_bytes)
+{
+    FILE* file = fopen(m_path, "rb"); // The file
+    long size; // Its size
+
+    if (file == 0)
+    {
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    m_bytes.resize(size);
+    size = long(fread(m_bytes.data(), 1, m_bytes.size(), file));
+    fclose(file);
+    return size == long(m_bytes.size());
+}
+
+/**
+ * @brief writeFile Replaces a file with the first bytes of a buffer.
+ * @param m_path The file's path.
+ * @param m_bytes The buffer.
+ * @param m_size The # of bytes to write.
+ * @return False if it couldn't be written.
+ */
+bool writeFile(const char* m_path, const vector<uint8_t>& m_bytes, size_t m_size)
+{
+    FILE* file = fopen(m_path, "wb"); // The file
+    bool ok; // True if every byte was written
+
+    if (file == 0)
+    {
+        return false;
+    }
+
+    ok = m_size == 0 || fwrite(m_bytes.data(), 1, m_size, file) == m_size; // An empty vector may have no data
+    return fclose(file) == 0 && ok;
+}
+
+int main()
+{
+    testSnapshot();
+    testCorpus();
+    testReplay();
+    testGroups();
+    testUndo();
+    testBackends();
+
+    printf("%d checks, %d failed\n", nChecks, nFailed);
+    return nFailed == 0 ? 0 : 1;
+}
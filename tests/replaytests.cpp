@@ -0,0 +1,380 @@
+/*
+ * Replay log tests. Random games are recorded, encoded and decoded back, alone and back to back as in a replay file, and
+ * verified. Every truncation of a log, and logs with hostile headers, moves and varints, must be refused by replayDecode(), and
+ * tampered replays must fail verification with the right outcome.
+ */
+
+/* My headers */
+#include "tests.hpp" // Checks and boards
+#include "position.hpp" // Playing the recorded games
+#include "replay.hpp" // Format under test
+#include "rng.hpp" // Picking moves
+
+/* STL headers */
+#include <cstdio> // remove()
+#include <vector> // STL vectors
+
+using namespace std;
+
+/* Defines */
+#define REPLAY_TEST_FILE "samegame-tests.sgr" // Scratch file, in the working directory
+
+/**
+ * @brief recordGame Plays random moves from the board Game generates for a seed, and records them.
+ * @param m_rows The # of rows.
+ * @param m_cols The # of columns.
+ * @param m_nColours The # of colours.
+ * @param m_seed The seed.
+ * @param m_maxMoves The most moves to play. The game is played to its end if it ends first.
+ * @param m_replay Receives the replay, with the score its moves reach.
+ */
+static void recordGame(int m_rows, int m_cols, int m_nColours, uint64_t m_seed, int m_maxMoves, Replay& m_replay)
+{
+    BoardGrid board; // Starting board
+    vector<Move> moves; // Legal moves in the current position
+    Rng rng(m_seed * 31 + 1); // Picks the moves
+
+    makeBoard(m_rows, m_cols, m_nColours, m_seed, board);
+    Position position(board); // Game being played
+
+    m_replay.rows = m_rows;
+    m_replay.cols = m_cols;
+    m_replay.nColours = m_nColours;
+    m_replay.seed = m_seed;
+    m_replay.moves.clear();
+
+    while (int(m_replay.moves.size()) < m_maxMoves && position.legalMoves(moves) > 0)
+    {
+        m_replay.moves.push_back(moves[rng.below(moves.size())]);
+        position.play(m_replay.moves.back());
+    }
+
+    m_replay.score = position.getScore();
+}
+
+/**
+ * @brief sameReplay Compares two replays.
+ * @param m_a A replay.
+ * @param m_b Another replay.
+ * @return True if every field and every move match.
+ */
+static bool sameReplay(const Replay& m_a, const Replay& m_b)
+{
+    size_t i; // Move counter
+
+    if (m_a.rows != m_b.rows || m_a.cols != m_b.cols || m_a.nColours != m_b.nColours || m_a.seed != m_b.seed
+            || m_a.score != m_b.score || m_a.moves.size() != m_b.moves.size())
+    {
+        return false;
+    }
+
+    for (i = 0; i < m_a.moves.size(); i++)
+    {
+        if (m_a.moves[i].x != m_b.moves[i].x || m_a.moves[i].y != m_b.moves[i].y)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief varint Appends an unsigned LEB128 varint, for building logs by hand.
+ * @param m_value The value.
+ * @param m_out The buffer.
+ */
+static void varint(uint64_t m_value, vector<uint8_t>& m_out)
+{
+    for ( ; m_value >= 0x80; m_value >>= 7)
+    {
+        m_out.push_back(uint8_t(m_value) | 0x80);
+    }
+
+    m_out.push_back(uint8_t(m_value));
+}
+
+/**
+ * @brief decodeCopy Decodes a log from a buffer of exactly its size, so that a read past the end is caught by the address
+ * sanitizer in builds which have it.
+ * @param m_in The log.
+ * @param m_size The # of bytes to decode from.
+ * @return What replayDecode() returned.
+ */
+static size_t decodeCopy(const vector<uint8_t>& m_in, size_t m_size)
+{
+    vector<uint8_t> copy(m_in.begin(), m_in.begin() + m_size); // Nothing after the bytes given
+    Replay replay; // Receives the replay
+
+    return replayDecode(copy.data(), copy.size(), replay);
+}
+
+/**
+ * @brief testRoundTrip Encodes recorded games, one at a time and back to back, decodes them, and verifies them.
+ */
+static void testRoundTrip()
+{
+    vector<Replay> replays; // Recorded games
+    vector<uint8_t> log; // One game's log
+    vector<uint8_t> stream; // Every game's log, back to back
+    Replay decoded; // A decoded game
+    ReplayCheck check; // A game's outcome
+    size_t offset = 0; // Offset of the next log in the stream
+    size_t n; // Size of a decoded log
+    int k; // Game counter
+    int bad = 0; // # of games which didn't survive
+
+    for (k = 0; k < 40; k++) // Sizes up to the largest a replay may have, some played to the end and some not
+    {
+        replays.push_back(Replay());
+        recordGame(1 + k % 7 * 16, 1 + k * 5 % 99, 1 + k % 9, uint64_t(k) << 40 | k, k % 3 ? 1000000 : k, replays.back());
+    }
+
+    for (k = 0; k < int(replays.size()); k++)
+    {
+        log.clear();
+        replayEncode(replays[k], log);
+        replayEncode(replays[k], stream);
+        n = replayDecode(log.data(), log.size(), decoded);
+        check = replayVerify(decoded);
+        bad += n != log.size() || !sameReplay(replays[k], decoded) || check.status != ReplayCheck::VALID
+                || check.score != replays[k].score || check.movesPlayed != int(replays[k].moves.size());
+    }
+
+    CHECK(bad == 0);
+
+    for (k = 0; k < int(replays.size()) && offset < stream.size(); k++) // Logs need no framing
+    {
+        n = replayDecode(stream.data() + offset, stream.size() - offset, decoded);
+        bad += n == 0 || !sameReplay(replays[k], decoded);
+        offset += n == 0 ? stream.size() : n;
+    }
+
+    CHECK(bad == 0 && k == int(replays.size()) && offset == stream.size());
+}
+
+/**
+ * @brief testTruncated Checks that every proper prefix of a log is refused.
+ */
+static void testTruncated()
+{
+    Replay replay; // A recorded game
+    vector<uint8_t> log; // Its log
+    size_t n; // # of bytes kept
+    int bad = 0; // # of prefixes which were accepted
+
+    recordGame(15, 15, 5, 77, 1000000, replay);
+    replay.seed = 0xFEDCBA9876543210ull; // A seed with a long varint
+    replayEncode(replay, log);
+
+    for (n = 0; n < log.size(); n++)
+    {
+        bad += decodeCopy(log, n) != 0;
+    }
+
+    CHECK(bad == 0);
+    CHECK(decodeCopy(log, log.size()) == log.size());
+}
+
+/**
+ * @brief hostileLog Builds a log by hand.
+ * @param m_version The version.
+ * @param m_rows The # of rows.
+ * @param m_cols The # of columns.
+ * @param m_nColours The # of colours.
+ * @param m_score The score.
+ * @param m_nMoves The # of moves claimed.
+ * @param m_cells The cell numbers of the moves which follow.
+ * @return The log.
+ */
+static vector<uint8_t> hostileLog(uint64_t m_version, uint64_t m_rows, uint64_t m_cols, uint64_t m_nColours, uint64_t m_score,
+                                  uint64_t m_nMoves, const vector<uint64_t>& m_cells)
+{
+    vector<uint8_t> log; // The log
+    size_t i; // Move counter
+
+    varint(m_version, log);
+    varint(m_rows, log);
+    varint(m_cols, log);
+    varint(m_nColours, log);
+    varint(1234, log); // Seed
+    varint(m_score, log);
+    varint(m_nMoves, log);
+
+    for (i = 0; i < m_cells.size(); i++)
+    {
+        varint(m_cells[i], log);
+    }
+
+    return log;
+}
+
+/**
+ * @brief testHostile Checks that logs with impossible headers or moves are refused, in particular short logs claiming huge
+ * boards or move lists, which would cost memory and time out of all proportion to their size.
+ */
+static void testHostile()
+{
+    vector<uint64_t> cells(4, 0); // Four moves on the first cell
+    vector<uint64_t> none; // No moves
+    vector<uint8_t> log; // A log built by hand
+    size_t i; // Byte counter
+
+    log = hostileLog(REPLAY_VERSION, 5, 5, 3, 10, 4, cells); // The control case is valid
+    CHECK(decodeCopy(log, log.size()) == log.size());
+    log = hostileLog(REPLAY_VERSION + 1, 5, 5, 3, 10, 4, cells);
+    CHECK(decodeCopy(log, log.size()) == 0);
+    log = hostileLog(REPLAY_VERSION, 0, 5, 3, 0, 0, none);
+    CHECK(decodeCopy(log, log.size()) == 0);
+    log = hostileLog(REPLAY_VERSION, 5, 0, 3, 0, 0, none);
+    CHECK(decodeCopy(log, log.size()) == 0);
+    log = hostileLog(REPLAY_VERSION, 100, 5, 3, 0, 0, none); // One row more than a game can have
+    CHECK(decodeCopy(log, log.size()) == 0);
+    log = hostileLog(REPLAY_VERSION, 16384, 16384, 3, 0, 0, none); // A 10-byte log claiming a board of 2^28 cells
+    CHECK(log.size() <= 12 && decodeCopy(log, log.size()) == 0);
+    log = hostileLog(REPLAY_VERSION, uint64_t(1) << 62, uint64_t(1) << 62, 3, 0, 0, none); // rows * cols wraps
+    CHECK(decodeCopy(log, log.size()) == 0);
+    log = hostileLog(REPLAY_VERSION, 5, 5, 0, 0, 0, none);
+    CHECK(decodeCopy(log, log.size()) == 0);
+    log = hostileLog(REPLAY_VERSION, 5, 5, 254, 0, 0, none); // Would collide with BoardGrid::REMOVED
+    CHECK(decodeCopy(log, log.size()) == 0);
+    log = hostileLog(REPLAY_VERSION, 5, 5, 3, uint64_t(1) << 31, 0, none); // Doesn't fit in an int
+    CHECK(decodeCopy(log, log.size()) == 0);
+    log = hostileLog(REPLAY_VERSION, 5, 5, 3, 0, 13, vector<uint64_t>(13, 0)); // More moves than pairs of blocks
+    CHECK(decodeCopy(log, log.size()) == 0);
+    log = hostileLog(REPLAY_VERSION, 99, 99, 3, 0, 4000, none); // More moves than bytes left
+    CHECK(decodeCopy(log, log.size()) == 0);
+    log = hostileLog(REPLAY_VERSION, 5, 5, 3, 0, 1, vector<uint64_t>(1, 25)); // Off the board
+    CHECK(decodeCopy(log, log.size()) == 0);
+
+    log = hostileLog(REPLAY_VERSION, 5, 5, 3, 0, 0, none); // A seed varint of 11 bytes, longer than 64 bits
+    log.resize(4);
+    log.insert(log.end(), 10, 0xFF);
+    log.push_back(0x01);
+    varint(0, log);
+    varint(0, log);
+    CHECK(decodeCopy(log, log.size()) == 0);
+
+    log.assign(64, 0xFF); // Continuation bits all the way to the end
+    CHECK(decodeCopy(log, log.size()) == 0);
+
+    for (i = 0; i < 256; i++) // Every single-byte log
+    {
+        log.assign(1, uint8_t(i));
+        CHECK(decodeCopy(log, 1) == 0);
+    }
+}
+
+/**
+ * @brief testVerify Checks that tampered replays fail verification with the right outcome, and that verifying in parallel
+ * gives the same outcomes as verifying one at a time.
+ */
+static void testVerify()
+{
+    Replay replay; // A game played to its end
+    Replay tampered; // A changed copy
+    ReplayCheck check; // Its outcome
+    vector<Replay> replays; // Many games
+    vector<ReplayCheck> checks; // Their outcomes
+    size_t k; // Game counter
+    int bad = 0; // # of games verified differently in parallel
+
+    recordGame(15, 15, 5, 2024, 1000000, replay);
+    check = replayVerify(replay);
+    CHECK(check.status == ReplayCheck::VALID && check.finished);
+
+    tampered = replay;
+    tampered.score++;
+    check = replayVerify(tampered);
+    CHECK(check.status == ReplayCheck::WRONG_SCORE && check.score == replay.score);
+
+    tampered = replay; // Once the game is over, every block is on its own
+    tampered.moves.push_back(tampered.moves.front());
+    check = replayVerify(tampered);
+    CHECK(check.status == ReplayCheck::ILLEGAL_MOVE && check.movesPlayed == int(replay.moves.size()) && check.score == replay.score);
+
+    tampered = replay;
+    tampered.rows = 0;
+    CHECK(replayVerify(tampered).status == ReplayCheck::BAD_REPLAY);
+    tampered = replay;
+    tampered.nColours = 254;
+    CHECK(replayVerify(tampered).status == ReplayCheck::BAD_REPLAY);
+
+    for (k = 0; k < 700; k++) // More than one chunk, with every outcome
+    {
+        recordGame(5 + k % 11, 5 + k % 13, 2 + k % 4, k, k % 2 ? 1000000 : 3, replay);
+        replay.score += (k % 5 == 0);
+        replay.rows = (k % 7 == 0) ? 0 : replay.rows;
+        replays.push_back(replay);
+    }
+
+    replayVerifyAll(replays, checks, 4);
+
+    for (k = 0; k < replays.size(); k++)
+    {
+        check = replayVerify(replays[k]);
+        bad += checks[k].status != check.status || checks[k].score != check.score || checks[k].movesPlayed != check.movesPlayed;
+    }
+
+    CHECK(checks.size() == replays.size() && bad == 0);
+}
+
+/**
+ * @brief testReplayFile Checks that ReplayFile appends replays in the order they were added, and reports failed writes.
+ */
+static void testReplayFile()
+{
+    vector<Replay> replays; // Games added
+    vector<uint8_t> bytes; // The file
+    Replay decoded; // A game read back
+    size_t offset = 0; // Offset of the next log in the file
+    size_t n; // Size of a log
+    size_t k; // Game counter
+    int bad = 0; // # of games which didn't read back
+
+    remove(REPLAY_TEST_FILE);
+
+    {
+        ReplayFile file(REPLAY_TEST_FILE); // Written in the background
+        ReplayFile nowhere("no-such-directory/replays.sgr"); // Can't be created
+
+        for (k = 0; k < 50; k++)
+        {
+            replays.push_back(Replay());
+            recordGame(10, 10, 4, k, 1000000, replays.back());
+            file.add(replays.back());
+        }
+
+        nowhere.add(replays.front());
+        file.flush();
+        nowhere.flush();
+        CHECK(!file.hasWriteFailed());
+        CHECK(nowhere.hasWriteFailed());
+    }
+
+    if (CHECK(readFile(REPLAY_TEST_FILE, bytes)))
+    {
+        for (k = 0; k < replays.size() && offset < bytes.size(); k++)
+        {
+            n = replayDecode(bytes.data() + offset, bytes.size() - offset, decoded);
+            bad += n == 0 || !sameReplay(replays[k], decoded);
+            offset += n == 0 ? bytes.size() : n;
+        }
+
+        CHECK(bad == 0 && k == replays.size() && offset == bytes.size());
+    }
+
+    remove(REPLAY_TEST_FILE);
+}
+
+/**
+ * @brief testReplay Runs the replay log tests.
+ */
+void testReplay()
+{
+    testRoundTrip();
+    testTruncated();
+    testHostile();
+    testVerify();
+    testReplayFile();
+}
@@ -0,0 +1,232 @@
+/*
+ * Saved game tests. Snapshots are written and read back for boards of several sizes, with 4 and 8 bits per cell, and every
+ * truncation of a snapshot, every header field set to a hostile value, and random corruption are fed to snapshotRead(), which
+ * must reject them, or accept only a board which is valid, without reading outside the buffer.
+ */
+
+/* My headers */
+#include "tests.hpp" // Checks and boards
+#include "rng.hpp" // Random corruption
+#include "snapshot.hpp" // Format under test
+#include "zobrist.hpp" // Board hashes
+
+/* STL headers */
+#include <cstring> // memcpy()
+#include <vector> // STL vectors
+
+using namespace std;
+
+/**
+ * @brief writeSnapshot Writes a snapshot of a board, with a palette made up from the # of colours.
+ * @param m_board The board.
+ * @param m_nColours The # of colours.
+ * @param m_out Receives the snapshot, replacing its contents.
+ */
+static void writeSnapshot(const BoardGrid& m_board, int m_nColours, vector<uint8_t>& m_out)
+{
+    vector<uint32_t> palette; // Made-up colours, black first
+    int c; // Colour counter
+
+    for (c = 0; c <= m_nColours; c++)
+    {
+        palette.push_back(c == 0 ? 0xFF000000u : 0xFF000000u | uint32_t(c * 0x10203));
+    }
+
+    m_out.resize(snapshotBytes(m_board.getRows(), m_board.getCols(), m_nColours));
+    snapshotWrite(m_out.data(), m_board, m_nColours, palette.data(), 1234, 99, zobristHash(m_board));
+}
+
+/**
+ * @brief readCopy Reads the first bytes of a snapshot from a buffer of exactly that size, so that a read past the end is caught
+ * by the address sanitizer in builds which have it.
+ * @param m_in The snapshot.
+ * @param m_size The # of bytes to read.
+ * @param m_board Receives the board.
+ * @return What snapshotRead() returned.
+ */
+static const char* readCopy(const vector<uint8_t>& m_in, size_t m_size, BoardGrid& m_board)
+{
+    vector<uint8_t> copy(m_in.begin(), m_in.begin() + m_size); // Nothing after the bytes given
+    SnapshotHeader header; // Receives the header
+    vector<uint32_t> palette; // Receives the palette
+
+    return snapshotRead(copy.data(), copy.size(), header, palette, m_board);
+}
+
+/**
+ * @brief withHeader Fetches a copy of a snapshot with its header changed.
+ * @param m_in The snapshot.
+ * @param m_header The new header.
+ * @return The changed copy.
+ */
+static vector<uint8_t> withHeader(const vector<uint8_t>& m_in, const SnapshotHeader& m_header)
+{
+    vector<uint8_t> out(m_in); // The copy
+
+    memcpy(out.data(), &m_header, sizeof(m_header));
+    return out;
+}
+
+/**
+ * @brief testRoundTrip Writes boards of several sizes and # of colours, some with moves played, and checks that they read back
+ * unchanged.
+ */
+static void testRoundTrip()
+{
+    static const int sizes[][3] = { { 1, 1, 1 }, { 5, 5, 3 }, { 15, 15, 5 }, { 7, 33, 15 }, { 20, 9, 20 }, { 3, 4, 200 } }; // Rows, columns, colours
+    vector<uint8_t> bytes; // A snapshot
+    SnapshotHeader header; // Its header, as read
+    vector<uint32_t> palette; // Its palette, as read
+    BoardGrid board; // Board written
+    BoardGrid loaded; // Board read
+    size_t k; // Size counter
+    int moves; // # of moves played before writing
+
+    for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++)
+    {
+        for (moves = 0; moves <= 20; moves += 20) // A new board, and one from a game in progress
+        {
+            makeBoard(sizes[k][0], sizes[k][1], sizes[k][2], 7 + k, board);
+            playMoves(board, moves, k);
+            writeSnapshot(board, sizes[k][2], bytes);
+
+            if (CHECK(snapshotRead(bytes.data(), bytes.size(), header, palette, loaded) == 0))
+            {
+                CHECK(sameCells(board, loaded));
+                CHECK(header.rows == uint32_t(sizes[k][0]) && header.cols == uint32_t(sizes[k][1]));
+                CHECK(header.nColours == uint32_t(sizes[k][2]));
+                CHECK(header.bitsPerCell == (sizes[k][2] <= 15 ? 4u : 8u));
+                CHECK(header.points == 1234 && header.seed == 99 && header.hash == zobristHash(board));
+                CHECK(palette.size() == size_t(sizes[k][2] + 1) && palette[0] == 0xFF000000u);
+            }
+        }
+    }
+}
+
+/**
+ * @brief testTruncated Checks that every proper prefix of a snapshot is rejected.
+ */
+static void testTruncated()
+{
+    static const int colours[] = { 5, 20 }; // One snapshot with 4 bits per cell, one with 8
+    vector<uint8_t> bytes; // A snapshot
+    BoardGrid board; // Board written
+    BoardGrid loaded; // Board read
+    size_t n; // # of bytes kept
+    int bad; // # of prefixes which were accepted
+    int k; // Snapshot counter
+
+    for (k = 0; k < 2; k++)
+    {
+        makeBoard(9, 11, colours[k], 3, board);
+        writeSnapshot(board, colours[k], bytes);
+        bad = 0;
+
+        for (n = 0; n < bytes.size(); n++)
+        {
+            bad += readCopy(bytes, n, loaded) == 0;
+        }
+
+        CHECK(bad == 0);
+        CHECK(readCopy(bytes, bytes.size(), loaded) == 0);
+    }
+}
+
+/**
+ * @brief testHostileHeaders Checks that headers with impossible or oversized fields are rejected, before anything is allocated
+ * for them.
+ */
+static void testHostileHeaders()
+{
+    vector<uint8_t> bytes; // A valid snapshot
+    SnapshotHeader good; // Its header
+    SnapshotHeader h; // A changed header
+    BoardGrid board; // Board written
+    BoardGrid loaded; // Board read
+
+    makeBoard(6, 6, 4, 5, board);
+    writeSnapshot(board, 4, bytes);
+    memcpy(&good, bytes.data(), sizeof(good));
+
+    h = good; h.magic[0] = 'X';
+    CHECK(readCopy(withHeader(bytes, h), bytes.size(), loaded) != 0);
+    h = good; h.version = SNAPSHOT_VERSION + 1;
+    CHECK(readCopy(withHeader(bytes, h), bytes.size(), loaded) != 0);
+    h = good; h.headerBytes = sizeof(SnapshotHeader) - 4;
+    CHECK(readCopy(withHeader(bytes, h), bytes.size(), loaded) != 0);
+    h = good; h.headerBytes = 0xFFFFFFF0u; // Would wrap the size check if it were added before being compared
+    CHECK(readCopy(withHeader(bytes, h), bytes.size(), loaded) != 0);
+    h = good; h.rows = 0;
+    CHECK(readCopy(withHeader(bytes, h), bytes.size(), loaded) != 0);
+    h = good; h.cols = 0;
+    CHECK(readCopy(withHeader(bytes, h), bytes.size(), loaded) != 0);
+    h = good; h.rows = 0x80000000u;
+    CHECK(readCopy(withHeader(bytes, h), bytes.size(), loaded) != 0);
+    h = good; h.rows = 16384; h.cols = 16384; // Allowed, but far bigger than the file
+    CHECK(readCopy(withHeader(bytes, h), bytes.size(), loaded) != 0);
+    h = good; h.nColours = 0;
+    CHECK(readCopy(withHeader(bytes, h), bytes.size(), loaded) != 0);
+    h = good; h.nColours = 0xFFFFFFFFu;
+    CHECK(readCopy(withHeader(bytes, h), bytes.size(), loaded) != 0);
+    h = good; h.bitsPerCell = 8; // Doesn't match the # of colours
+    CHECK(readCopy(withHeader(bytes, h), bytes.size(), loaded) != 0);
+    h = good; h.bitsPerCell = 5;
+    CHECK(readCopy(withHeader(bytes, h), bytes.size(), loaded) != 0);
+
+    bytes.back() = 0x77; // Two cells with colour 7, on a board of 4 colours
+    CHECK(readCopy(bytes, bytes.size(), loaded) != 0);
+}
+
+/**
+ * @brief testCorrupt Changes random bytes of a snapshot, and checks that whatever is accepted is a board of the size and # of
+ * colours its header claims.
+ */
+static void testCorrupt()
+{
+    vector<uint8_t> bytes; // A valid snapshot
+    vector<uint8_t> bad; // A corrupted copy
+    SnapshotHeader header; // Header read from the copy
+    vector<uint32_t> palette; // Palette read from the copy
+    BoardGrid board; // Board written
+    BoardGrid loaded; // Board read
+    Rng rng(42); // Picks the bytes
+    int trial; // Trial counter
+    int x; // Column counter
+    int y; // Row counter
+    bool valid; // True if every loaded cell is a colour index
+
+    makeBoard(8, 8, 6, 11, board);
+    writeSnapshot(board, 6, bytes);
+
+    for (trial = 0; trial < 5000; trial++)
+    {
+        bad = bytes;
+        bad[rng.below(bad.size())] ^= uint8_t(1 + rng.below(255));
+
+        if (snapshotRead(bad.data(), bad.size(), header, palette, loaded) == 0) // Accepted, so it has to make sense
+        {
+            valid = loaded.getRows() == int(header.rows) && loaded.getCols() == int(header.cols) && palette.size() == header.nColours + 1;
+
+            for (y = 0; valid && y < loaded.getRows(); y++)
+            {
+                for (x = 0; x < loaded.getCols(); x++)
+                {
+                    valid = valid && loaded.at(x, y) <= header.nColours;
+                }
+            }
+
+            CHECK(valid);
+        }
+    }
+}
+
+/**
+ * @brief testSnapshot Runs the saved game tests.
+ */
+void testSnapshot()
+{
+    testRoundTrip();
+    testTruncated();
+    testHostileHeaders();
+    testCorrupt();
+}
@@ -0,0 +1,47 @@
+#ifndef TESTS_HPP
+#define TESTS_HPP
+
+/* C++ Headers */
+#include <cstddef> // size_t
+#include <cstdint> // uint8_t, uint64_t
+#include <vector> // STL vectors
+
+/* My headers */
+#include "boardgrid.hpp" // Boards under test
+#include "boardt.hpp" // Fixed-size kernels
+#include "groupindex.hpp" // Group indices
+
+using namespace std;
+
+/*
+ * Headless engine tests. Each suite is a function which runs its checks with CHECK(). A failed check prints its file, line and
+ * condition and the suite carries on, so one run reports every failure. main() runs every suite.
+ */
+
+#define CHECK(m_cond) checkThat((m_cond), #m_cond, __FILE__, __LINE__) // Checks a condition, and reports it if it is false
+
+/* Checks */
+bool checkThat(bool m_ok, const char* m_what, const char* m_file, int m_line); // Counts a check, and reports it if it failed. Returns m_ok.
+
+/* Boards */
+void makeBoard(int m_rows, int m_cols, int m_nColours, uint64_t m_seed, BoardGrid& m_board); // Generates the board Game would for a seed
+void playMoves(BoardGrid& m_board, int m_nMoves, uint64_t m_seed); // Plays up to n random legal moves on a board
+bool sameCells(const BoardGrid& m_a, const BoardGrid& m_b); // True if two boards have the same size and cells
+
+/* Moves */
+int removeGroup(BoardGrid& m_board, const BoardKernels* m_kernels, int m_x, int m_y, vector<CellChange>& m_changes, int& m_loCol, int& m_hiCol); // Plays a move as Game does
+bool sameGroups(const BoardGrid& m_board, const GroupIndex& m_index); // True if an index describes the same groups as a rebuilt one
+
+/* Files */
+bool readFile(const char* m_path, vector<uint8_t>& m_bytes); // Reads a whole file
+bool writeFile(const char* m_path, const vector<uint8_t>& m_bytes, size_t m_size); // Replaces a file with the first bytes of a buffer
+
+/* Suites */
+void testBackends(); // Search backends
+void testCorpus(); // Puzzle corpora
+void testGroups(); // Group indices
+void testReplay(); // Replay logs
+void testSnapshot(); // Saved games
+void testUndo(); // Undo and redo
+
+#endif // TESTS_HPP
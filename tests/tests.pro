@@ -0,0 +1,24 @@
+# Headless tests of the engine: round-trips, truncated and hostile files for the saved game, corpus and replay formats, the
+# group index's incremental updates, undo/redo, and the bitboard search backend. Links the engine only, so it runs on machines
+# without QtGui or a display. "make check" runs it, and it exits with 1 if any check fails.
+
+TARGET = samegame-tests
+TEMPLATE = app
+CONFIG += console testcase
+CONFIG -= qt app_bundle
+
+SOURCES += \
+    main.cpp \
+    backendtests.cpp \
+    corpustests.cpp \
+    grouptests.cpp \
+    replaytests.cpp \
+    snapshottests.cpp \
+    undotests.cpp
+
+HEADERS += \
+    tests.hpp
+
+QMAKE_CXXFLAGS += -std=c++11
+
+include(../SameGame/engine.pri)
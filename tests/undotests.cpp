@@ -0,0 +1,209 @@
+/*
+ * Undo and redo tests. Random games are recorded on an UndoStack the way Game records them, then undone back to the start and
+ * redone to the end. After every step the board must match the one saved at that point, the hash must follow the step's
+ * delta, and the group index, relabelled over the step's columns as Game::applyStep() does it, must match a rebuilt one.
+ * Position's make/unmake is checked the same way.
+ */
+
+/* My headers */
+#include "tests.hpp" // Checks, boards and moves
+#include "position.hpp" // Make/unmake
+#include "rng.hpp" // Picking moves
+#include "undostack.hpp" // History under test
+#include "zobrist.hpp" // Board hashes
+
+/* STL headers */
+#include <algorithm> // min(), max()
+#include <vector> // STL vectors
+
+using namespace std;
+
+/**
+ * @brief applyStep Relabels a group index after an undo or redo, over the columns the step changed, as Game::applyStep() does.
+ * @param m_board The board, after the step.
+ * @param m_undo The history.
+ * @param m_step The step.
+ * @param m_index The index.
+ */
+static void applyStep(const BoardGrid& m_board, const UndoStack& m_undo, const UndoStep& m_step, GroupIndex& m_index)
+{
+    const CellChange* changes = m_undo.getChanges(m_step); // Cells the step changed
+    int lo = m_board.getCols(); // Leftmost changed column
+    int hi = -1; // Rightmost changed column
+    size_t i; // Change counter
+
+    for (i = 0; i < m_step.count; i++)
+    {
+        lo = min(lo, m_board.xOf(changes[i].index));
+        hi = max(hi, m_board.xOf(changes[i].index));
+    }
+
+    m_index.update(m_board, lo, hi);
+}
+
+/**
+ * @brief testUndoRedo Plays random games, undoes every move and redoes them all, checking the board, hash, score and group
+ * index at every step. Then undoes part of a game and plays a new move, which must forget the undone moves.
+ */
+static void testUndoRedo()
+{
+    static const int sizes[][3] = { { 5, 5, 3 }, { 15, 15, 5 }, { 8, 19, 4 }, { 1, 10, 2 } }; // Rows, columns, colours
+    BoardGrid board; // Board being played
+    GroupIndex index; // Its group index
+    UndoStack undo; // Its history
+    vector<BoardGrid> boards; // The board before each move, and at the end
+    vector<uint64_t> hashes; // Their hashes
+    vector<int> scores; // The score before each move, and at the end
+    vector<LegalMove> moves(400); // Legal moves
+    vector<CellChange> changes; // Cells a move changed
+    const UndoStep* step; // A step undone or redone
+    Rng rng(3); // Picks the moves
+    uint64_t hash; // Hash kept up to date from the steps' deltas
+    int score; // Score kept up to date from the steps' points
+    int lo, hi; // Columns a move changed
+    int n; // # of legal moves, or of blocks a move removed
+    size_t k; // Size counter
+    int game; // Game counter
+    int i; // Step counter
+    int bad = 0; // # of steps which went wrong
+
+    for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++)
+    {
+        for (game = 0; game < 20; game++)
+        {
+            makeBoard(sizes[k][0], sizes[k][1], sizes[k][2], game, board);
+            index.rebuild(board);
+            undo.clear();
+            boards.assign(1, board);
+            hashes.assign(1, zobristHash(board));
+            scores.assign(1, 0);
+            bad += undo.canUndo() || undo.canRedo() || undo.undo(board) != 0 || undo.redo(board) != 0;
+
+            while ((n = index.listMovable(board, moves.data(), moves.size())) > 0) // Play the game to its end
+            {
+                const LegalMove move = moves[rng.below(n)]; // A random group
+
+                n = removeGroup(board, 0, move.x, move.y, changes, lo, hi);
+                undo.push(changes, n * (n+1) / 2, board.index(move.x, move.y));
+                index.update(board, lo, hi);
+                boards.push_back(board);
+                hashes.push_back(zobristHash(board));
+                scores.push_back(scores.back() + n * (n+1) / 2);
+            }
+
+            hash = hashes.back();
+            score = scores.back();
+            bad += undo.getUndoCount() != boards.size() - 1;
+
+            for (i = int(boards.size()) - 2; i >= 0; i--) // Undo back to the start
+            {
+                step = undo.undo(board);
+
+                if (step == 0) // Ran out early
+                {
+                    bad++;
+                    break;
+                }
+
+                hash ^= step->hashDelta;
+                score -= step->points;
+                applyStep(board, undo, *step, index);
+                bad += !sameCells(board, boards[i]) || hash != hashes[i] || score != scores[i] || !sameGroups(board, index);
+            }
+
+            bad += undo.canUndo() || undo.undo(board) != 0;
+
+            for (i = 1; i < int(boards.size()); i++) // Redo to the end
+            {
+                step = undo.redo(board);
+
+                if (step == 0)
+                {
+                    bad++;
+                    break;
+                }
+
+                hash ^= step->hashDelta;
+                score += step->points;
+                applyStep(board, undo, *step, index);
+                bad += !sameCells(board, boards[i]) || hash != hashes[i] || score != scores[i] || !sameGroups(board, index);
+            }
+
+            bad += undo.canRedo() || undo.redo(board) != 0;
+
+            for (i = int(boards.size()) - 1; i > int(boards.size()) / 2; i--) // Undo half, then branch off with a new move
+            {
+                applyStep(board, undo, *undo.undo(board), index);
+            }
+
+            if (boards.size() > 2 && (n = index.listMovable(board, moves.data(), moves.size())) > 0)
+            {
+                bad += !undo.canRedo();
+                n = removeGroup(board, 0, moves[0].x, moves[0].y, changes, lo, hi);
+                undo.push(changes, n * (n+1) / 2, board.index(moves[0].x, moves[0].y));
+                bad += undo.canRedo() || undo.redo(board) != 0;
+                bad += undo.undo(board) == 0 || !sameCells(board, boards[boards.size() / 2]);
+            }
+        }
+    }
+
+    CHECK(bad == 0);
+}
+
+/**
+ * @brief testPosition Plays random moves on a Position with an undo stack, and checks that unmaking and remaking them restores
+ * the board, score and hash of the position they were made from.
+ */
+static void testPosition()
+{
+    BoardGrid start; // Starting board
+    UndoStack undo; // The position's history
+    vector<Move> moves; // Legal moves
+    vector<Position> seen; // The position before each move, and at the end
+    Rng rng(8); // Picks the moves
+    int game; // Game counter
+    int i; // Move counter
+    int bad = 0; // # of steps which went wrong
+
+    for (game = 0; game < 40; game++)
+    {
+        makeBoard(6 + game % 10, 6 + game % 7, 3 + game % 3, game, start);
+        Position position(start); // Position being played
+
+        undo.clear();
+        seen.assign(1, position);
+
+        while (position.legalMoves(moves) > 0)
+        {
+            position.play(moves[rng.below(moves.size())], undo);
+            seen.push_back(position);
+        }
+
+        for (i = int(seen.size()) - 2; i >= 0; i--)
+        {
+            bad += !position.undo(undo) || !sameCells(position.getBoard(), seen[i].getBoard())
+                    || position.getScore() != seen[i].getScore() || position.getHash() != seen[i].getHash();
+        }
+
+        bad += position.undo(undo);
+
+        for (i = 1; i < int(seen.size()); i++)
+        {
+            bad += !position.redo(undo) || !sameCells(position.getBoard(), seen[i].getBoard())
+                    || position.getScore() != seen[i].getScore() || position.getHash() != seen[i].getHash();
+        }
+
+        bad += position.redo(undo) || !position.isOver();
+    }
+
+    CHECK(bad == 0);
+}
+
+/**
+ * @brief testUndo Runs the undo and redo tests.
+ */
+void testUndo()
+{
+    testUndoRedo();
+    testPosition();
+}
@@ -0,0 +1,12 @@
+# Headless corpus generator. Links the engine only, so it runs on machines without QtGui or a display.
+
+TARGET = samegame-gencorpus
+TEMPLATE = app
+CONFIG += console
+CONFIG -= qt app_bundle
+
+SOURCES += main.cpp
+
+QMAKE_CXXFLAGS += -std=c++11
+
+include(../../SameGame/engine.pri)
@@ -0,0 +1,151 @@
+/*
+ * Headless corpus generator. Generates the boards for a range of seeds with BoardGenerator, on every core, and writes them to a
+ * corpus file which samegame-solve --corpus, and anything else which reads corpora, can use. Board i gets seed FIRST + i, so
+ * it is the same board as Game(rows, cols, colours, FIRST + i), and the same one samegame-solve --seeds generates.
+ *
+ * Boards are generated in batches of about 64 million cells, so memory use doesn't grow with the # of boards, and each batch
+ * is written out before the next one is generated.
+ *
+ * Uses only the engine, so it needs neither QtGui nor a display.
+ *
+ * Usage: samegame-gencorpus --out FILE --count N [--first SEED] [--rows R] [--cols C] [--colours K] [--threads N]
+ */
+
+/* My headers */
+#include "boardgenerator.hpp" // Bulk generation
+#include "corpus.hpp" // Writing the corpus
+
+/* STL headers */
+#include <algorithm> // min(), max()
+#include <chrono> // steady_clock
+#include <cstdint> // uint64_t
+#include <cstdio> // fprintf()
+#include <cstdlib> // atoi(), strtoull()
+#include <cstring> // strcmp()
+
+using namespace std;
+
+typedef chrono::steady_clock Clock; // Clock for the whole run
+
+/* Defines */
+#define GENCORPUS_MAX_SIDE 16384 // Largest # of rows or columns, as for corpus entries
+#define GENCORPUS_MAX_COLOURS 15 // Largest # of colours, since a corpus stores cells in 4 bits
+#define GENCORPUS_BATCH_CELLS (64 << 20) // # of cells generated at once
+
+/**
+ * @brief usage Prints the usage message.
+ * @param m_name The program's name.
+ * @return The exit code for bad arguments.
+ */
+static int usage(const char* m_name)
+{
+    fprintf(stderr, "usage: %s --out FILE --count N [--first SEED] [--rows R] [--cols C] [--colours K] [--threads N]\n", m_name);
+    return 2;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* outPath = 0; // Corpus file
+    uint64_t first = 0; // Seed of the first board
+    uint64_t count = 0; // # of boards
+    int rows = 15; // # of rows on each board
+    int cols = 15; // # of columns on each board
+    int nColours = 5; // # of colours on each board
+    int threads = 0; // # of threads to generate on, or 0 for one per core
+    int i; // Argument counter
+    uint64_t done = 0; // # of boards written so far
+    size_t batch; // # of boards in the current batch
+    size_t b; // Board counter
+    BoardGrid board; // A board being written
+    CorpusWriter writer; // The corpus
+    double seconds; // Time for the whole run
+    Clock::time_point start; // Start of the run
+
+    for (i = 1; i < argc; i++) // Parse the arguments
+    {
+        if (strcmp(argv[i], "--out") == 0 && i+1 < argc)
+        {
+            outPath = argv[++i];
+        }
+
+        else if (strcmp(argv[i], "--count") == 0 && i+1 < argc)
+        {
+            count = strtoull(argv[++i], 0, 10);
+        }
+
+        else if (strcmp(argv[i], "--first") == 0 && i+1 < argc)
+        {
+            first = strtoull(argv[++i], 0, 10);
+        }
+
+        else if (strcmp(argv[i], "--rows") == 0 && i+1 < argc)
+        {
+            rows = atoi(argv[++i]);
+        }
+
+        else if (strcmp(argv[i], "--cols") == 0 && i+1 < argc)
+        {
+            cols = atoi(argv[++i]);
+        }
+
+        else if (strcmp(argv[i], "--colours") == 0 && i+1 < argc)
+        {
+            nColours = atoi(argv[++i]);
+        }
+
+        else if (strcmp(argv[i], "--threads") == 0 && i+1 < argc)
+        {
+            threads = atoi(argv[++i]);
+        }
+
+        else
+        {
+            return usage(argv[0]);
+        }
+    }
+
+    if (outPath == 0 || count == 0 || rows < 1 || cols < 1 || nColours < 1 || threads < 0) // Need a file, some boards, and a possible board
+    {
+        return usage(argv[0]);
+    }
+
+    if (rows > GENCORPUS_MAX_SIDE || cols > GENCORPUS_MAX_SIDE || nColours > GENCORPUS_MAX_COLOURS) // Doesn't fit in a corpus
+    {
+        fprintf(stderr, "%s: boards can have at most %d rows and columns, and %d colours\n", argv[0], GENCORPUS_MAX_SIDE, GENCORPUS_MAX_COLOURS);
+        return 2;
+    }
+
+    if (!writer.open(outPath))
+    {
+        fprintf(stderr, "%s: couldn't create the corpus\n", outPath);
+        return 1;
+    }
+
+    BoardGenerator generator(rows, cols, nColours);
+    batch = max<size_t>(1, GENCORPUS_BATCH_CELLS / (size_t(rows) * cols));
+    start = Clock::now();
+
+    while (done < count) // Generate a batch on every core, then write it
+    {
+        batch = size_t(min<uint64_t>(batch, count - done));
+        generator.generate(first + done, batch, threads);
+
+        for (b = 0; b < batch; b++)
+        {
+            generator.copyTo(b, board);
+            writer.add(board, nColours, generator.getSeed(b));
+        }
+
+        done += batch;
+    }
+
+    if (!writer.close()) // A write failed somewhere
+    {
+        fprintf(stderr, "%s: couldn't write the corpus\n", outPath);
+        return 1;
+    }
+
+    seconds = chrono::duration<double>(Clock::now() - start).count();
+    fprintf(stderr, "%llu boards in %.2f s (%.0f boards/min)\n", (unsigned long long)count, seconds, seconds > 0 ? count * 60 / seconds : 0.0);
+    return 0;
+}
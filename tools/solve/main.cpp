@@ -0,0 +1,317 @@
+/*
+ * Headless batch solver. Solves a range of boards from a corpus, or the boards generated from a range of seeds (the same boards
+ * Game creates from those seeds), and prints one JSON object per board, on its own line, as each board is finished:
+ *
+ *   {"board": 0, "seed": 1, "rows": 15, "cols": 15, "colours": 5, "start_score": 0, "score": 1234, "moves": [[x, y], ...],
+ *    "playouts": 5678, "table_probes": 910, "table_hits": 123, "table_hit_rate": 0.135, "seconds": 1.002}
+ *
+ * The table fields count transposition table lookups, and are 0 when no table is used (see --table-mb). The totals for the
+ * whole batch are printed to stderr at the end.
+ *
+ * Boards are solved in parallel, one board per task on a work-stealing ThreadPool, and each solve runs on a single thread, so
+ * a batch keeps every core busy without the boards competing for them. Lines come out in the order the boards finish; "board"
+ * gives each one's place in the batch. Boards which can't be read get an "error" instead of a result.
+ *
+ * Uses only the engine, so it needs neither QtGui nor a display.
+ *
+ * Usage: samegame-solve (--corpus FILE [--first N] [--count N] | --seeds FIRST COUNT [--rows R] [--cols C] [--colours K])
+ *                       [--level L] [--time-ms T] [--playouts P] [--table-mb M] [--seed S] [--threads N] [--out FILE]
+ */
+
+/* My headers */
+#include "boardgenerator.hpp" // Boards from seeds
+#include "corpus.hpp" // Boards from corpora
+#include "solver.hpp" // The search
+#include "threadpool.hpp" // Work-stealing workers
+
+/* STL headers */
+#include <algorithm> // min()
+#include <chrono> // steady_clock
+#include <cstdarg> // va_list
+#include <cstdint> // uint64_t
+#include <cstdio> // fprintf(), fopen()
+#include <cstdlib> // atoi(), strtoull()
+#include <cstring> // strcmp()
+#include <mutex> // Output lock
+#include <string> // Output lines
+
+using namespace std;
+
+/* Defines */
+#define SOLVE_MAX_SIDE 16384 // Largest # of rows or columns of a generated board, as for saved games
+
+typedef chrono::steady_clock Clock; // Clock for the whole batch
+
+/**
+ * @brief The Batch struct. What to solve, how, and where to write the results. Shared, read-only, by every task, apart from the
+ * output, which is guarded by its lock.
+ */
+struct Batch
+{
+    const Corpus* corpus; // Corpus to read boards from, or 0 to generate them from seeds
+    uint64_t first; // First corpus entry, or first seed
+    int rows; // # of rows on generated boards
+    int cols; // # of columns on generated boards
+    int nColours; // # of colours on generated boards
+    SolverSettings settings; // Search settings, for every board
+    FILE* out; // Where the JSON lines go
+    uint64_t tableProbes; // Transposition table lookups of the boards finished so far
+    uint64_t tableHits; // Lookups of theirs which found an entry
+    mutex outLock; // Guards out and the totals
+};
+
+/**
+ * @brief appendf Appends formatted text to a string.
+ * @param m_line The string.
+ * @param m_format printf()-style format, followed by its arguments.
+ */
+static void appendf(string& m_line, const char* m_format, ...)
+{
+    char buffer[256]; // Formatted text. Every piece we format is short.
+    va_list args; // The arguments
+    int n; // Length of the text
+
+    va_start(args, m_format);
+    n = vsnprintf(buffer, sizeof(buffer), m_format, args);
+    va_end(args);
+
+    m_line.append(buffer, min<size_t>(max(n, 0), sizeof(buffer) - 1));
+}
+
+/**
+ * @brief solveBoard Reads or generates one board, solves it, and writes its JSON line.
+ * @param m_batch The batch.
+ * @param m_i The board's place in the batch.
+ */
+static void solveBoard(Batch& m_batch, size_t m_i)
+{
+    BoardGrid board; // The board
+    CorpusEntry entry; // Its metadata, for corpus boards
+    SolverSettings settings = m_batch.settings; // This board's settings
+    SolverResult result; // What the search found
+    uint64_t seed; // Seed the board was generated from
+    int startScore = 0; // Points already made on the board
+    string line; // The JSON line
+    size_t k; // Move counter
+
+    if (m_batch.corpus != 0) // Read it
+    {
+        if (!m_batch.corpus->getEntry(size_t(m_batch.first) + m_i, entry) || !m_batch.corpus->load(size_t(m_batch.first) + m_i, board))
+        {
+            appendf(line, "{\"board\": %llu, \"error\": \"corpus entry %llu is missing or corrupt\"}\n", (unsigned long long)m_i, (unsigned long long)(m_batch.first + m_i));
+            lock_guard<mutex> lock(m_batch.outLock); // One line at a time
+            fputs(line.c_str(), m_batch.out);
+            return;
+        }
+
+        seed = entry.header.seed;
+        startScore = entry.header.points;
+    }
+
+    else // Generate it, exactly as Game would
+    {
+        Rng rng(m_batch.first + m_i); // Same generator as the game's
+
+        seed = m_batch.first + m_i;
+        board.resize(m_batch.rows, m_batch.cols);
+        BoardGenerator::skipColours(rng, m_batch.nColours);
+        BoardGenerator::fill(rng, m_batch.nColours, board.data() + board.index(0, 0), board.getRows(), board.getCols(), board.getStride());
+    }
+
+    settings.seed += m_i; // Different random playouts for each board, but the same ones every run
+    result = Solver(settings).solve(board, startScore);
+
+    appendf(line, "{\"board\": %llu, \"seed\": %llu, \"rows\": %d, \"cols\": %d, \"colours\": %d, \"start_score\": %d, \"score\": %d, \"moves\": [",
+            (unsigned long long)m_i, (unsigned long long)seed, board.getRows(), board.getCols(),
+            m_batch.corpus != 0 ? int(entry.header.nColours) : m_batch.nColours, startScore, result.score);
+
+    for (k = 0; k < result.moves.size(); k++)
+    {
+        appendf(line, "%s[%d, %d]", k > 0 ? ", " : "", result.moves[k].x, result.moves[k].y);
+    }
+
+    appendf(line, "], \"playouts\": %lld, \"table_probes\": %llu, \"table_hits\": %llu, \"table_hit_rate\": %.3f, \"seconds\": %.3f}\n",
+            result.playouts, (unsigned long long)result.tableProbes, (unsigned long long)result.tableHits,
+            result.tableProbes > 0 ? double(result.tableHits) / result.tableProbes : 0.0, result.seconds);
+
+    lock_guard<mutex> lock(m_batch.outLock); // One line at a time
+    fputs(line.c_str(), m_batch.out);
+    m_batch.tableProbes += result.tableProbes;
+    m_batch.tableHits += result.tableHits;
+}
+
+/**
+ * @brief usage Prints the usage message.
+ * @param m_name The program's name.
+ * @return The exit code for bad arguments.
+ */
+static int usage(const char* m_name)
+{
+    fprintf(stderr, "usage: %s (--corpus FILE [--first N] [--count N] | --seeds FIRST COUNT [--rows R] [--cols C] [--colours K])\n"
+                    "       [--level L] [--time-ms T] [--playouts P] [--table-mb M] [--seed S] [--threads N] [--out FILE]\n", m_name);
+    return 2;
+}
+
+int main(int argc, char* argv[])
+{
+    Batch batch; // What to solve
+    Corpus corpus; // The corpus, if one was given
+    const char* corpusPath = 0; // Corpus file, or 0 to generate boards
+    const char* outPath = 0; // Output file, or 0 for stdout
+    const char* error; // Why the corpus couldn't be opened
+    bool haveSeeds = false; // True if --seeds was given
+    size_t count = size_t(-1); // # of boards to solve, or -1 for the rest of the corpus
+    int threads = 0; // # of boards solved at once, or 0 for one per core
+    int tableMb = 0; // Transposition table for each board, in MiB, or 0 for none
+    int i; // Argument counter
+    size_t b; // Board counter
+    double seconds; // Time for the whole batch
+    Clock::time_point start; // Start of the batch
+
+    batch.corpus = 0;
+    batch.first = 0;
+    batch.rows = 15;
+    batch.cols = 15;
+    batch.nColours = 5;
+    batch.out = stdout;
+    batch.tableProbes = 0;
+    batch.tableHits = 0;
+    batch.settings.threads = 1; // The batch is parallel across boards
+
+    for (i = 1; i < argc; i++) // Parse the arguments
+    {
+        if (strcmp(argv[i], "--corpus") == 0 && i+1 < argc)
+        {
+            corpusPath = argv[++i];
+        }
+
+        else if (strcmp(argv[i], "--first") == 0 && i+1 < argc)
+        {
+            batch.first = strtoull(argv[++i], 0, 10);
+        }
+
+        else if (strcmp(argv[i], "--count") == 0 && i+1 < argc)
+        {
+            count = strtoull(argv[++i], 0, 10);
+        }
+
+        else if (strcmp(argv[i], "--seeds") == 0 && i+2 < argc)
+        {
+            batch.first = strtoull(argv[++i], 0, 10);
+            count = strtoull(argv[++i], 0, 10);
+            haveSeeds = true;
+        }
+
+        else if (strcmp(argv[i], "--rows") == 0 && i+1 < argc)
+        {
+            batch.rows = atoi(argv[++i]);
+        }
+
+        else if (strcmp(argv[i], "--cols") == 0 && i+1 < argc)
+        {
+            batch.cols = atoi(argv[++i]);
+        }
+
+        else if (strcmp(argv[i], "--colours") == 0 && i+1 < argc)
+        {
+            batch.nColours = atoi(argv[++i]);
+        }
+
+        else if (strcmp(argv[i], "--level") == 0 && i+1 < argc)
+        {
+            batch.settings.level = atoi(argv[++i]);
+        }
+
+        else if (strcmp(argv[i], "--time-ms") == 0 && i+1 < argc)
+        {
+            batch.settings.timeLimitMs = atoi(argv[++i]);
+        }
+
+        else if (strcmp(argv[i], "--playouts") == 0 && i+1 < argc)
+        {
+            batch.settings.maxPlayouts = atoll(argv[++i]);
+        }
+
+        else if (strcmp(argv[i], "--table-mb") == 0 && i+1 < argc)
+        {
+            tableMb = atoi(argv[++i]);
+        }
+
+        else if (strcmp(argv[i], "--seed") == 0 && i+1 < argc)
+        {
+            batch.settings.seed = strtoull(argv[++i], 0, 10);
+        }
+
+        else if (strcmp(argv[i], "--threads") == 0 && i+1 < argc)
+        {
+            threads = atoi(argv[++i]);
+        }
+
+        else if (strcmp(argv[i], "--out") == 0 && i+1 < argc)
+        {
+            outPath = argv[++i];
+        }
+
+        else
+        {
+            return usage(argv[0]);
+        }
+    }
+
+    if ((corpusPath != 0) == haveSeeds || batch.rows < 1 || batch.cols < 1 || batch.nColours < 1 || batch.nColours > 253 // Need exactly one source of boards, and a possible board
+        || batch.settings.level < 0 || threads < 0 || tableMb < 0) // and no negative counts
+    {
+        return usage(argv[0]);
+    }
+
+    if (batch.rows > SOLVE_MAX_SIDE || batch.cols > SOLVE_MAX_SIDE) // The board's cell count wouldn't fit in an int
+    {
+        fprintf(stderr, "%s: --rows and --cols must be at most %d\n", argv[0], SOLVE_MAX_SIDE);
+        return 2;
+    }
+
+    batch.settings.tableBytes = size_t(tableMb) << 20;
+
+    if (corpusPath != 0) // Boards from a corpus
+    {
+        if ((error = corpus.open(corpusPath)) != 0)
+        {
+            fprintf(stderr, "%s: %s\n", corpusPath, error);
+            return 1;
+        }
+
+        batch.corpus = &corpus;
+        batch.first = min<uint64_t>(batch.first, corpus.getCount());
+        count = min<uint64_t>(count, corpus.getCount() - batch.first);
+    }
+
+    if (outPath != 0 && (batch.out = fopen(outPath, "w")) == 0) // Couldn't open the output file
+    {
+        perror(outPath);
+        return 1;
+    }
+
+    start = Clock::now();
+
+    {
+        ThreadPool pool(threads); // Solves the boards
+
+        for (b = 0; b < count; b++)
+        {
+            pool.submit([&batch, b] () { solveBoard(batch, b); });
+        }
+
+        pool.wait();
+        seconds = chrono::duration<double>(Clock::now() - start).count();
+        fprintf(stderr, "%llu boards in %.2f s on %d threads (%.1f boards/s)\n", (unsigned long long)count, seconds, pool.getThreadCount(), seconds > 0 ? count / seconds : 0.0);
+        fprintf(stderr, "transposition table: %llu probes, %llu hits (%.1f%%)\n", (unsigned long long)batch.tableProbes, (unsigned long long)batch.tableHits,
+                batch.tableProbes > 0 ? 100.0 * batch.tableHits / batch.tableProbes : 0.0);
+    }
+
+    if (batch.out != stdout)
+    {
+        fclose(batch.out);
+    }
+
+    return 0;
+}
@@ -0,0 +1,186 @@
+/*
+ * Headless replay verifier. Reads replay files, such as the one the game appends every finished game to, rebuilds each game's
+ * board from its seed, replays its moves, and prints one line per replay:
+ *
+ *   replays.sgr #0: valid, 15x15, 5 colours, seed 1234, score 987, 61 moves
+ *   replays.sgr #1: wrong score, 15x15, 5 colours, seed 1235, claims 990 but scores 987, 61 moves
+ *
+ * A file which stops being readable part-way through, from a torn or corrupt log, gets a line saying where. Replays are verified
+ * in parallel, on a ThreadPool, with replayVerifyAll().
+ *
+ * Uses only the engine, so it needs neither QtGui nor a display. Exits with 0 if every replay is valid, 1 if not.
+ *
+ * Usage: samegame-verify [--threads N] FILE...
+ */
+
+/* My headers */
+#include "mappedfile.hpp" // Reading replay files
+#include "replay.hpp" // Decoding and verifying
+
+/* STL headers */
+#include <chrono> // steady_clock
+#include <cstdio> // printf()
+#include <cstdlib> // atoi()
+#include <cstring> // strcmp()
+#include <vector> // STL vectors
+
+using namespace std;
+
+typedef chrono::steady_clock Clock; // Clock for the whole run
+
+/**
+ * @brief The Source struct. Where a replay came from.
+ */
+struct Source
+{
+    const char* path; // The replay file
+    size_t index; // The replay's place in the file, from 0
+};
+
+/**
+ * @brief statusName Fetches the name printed for a verification outcome.
+ * @param m_status The outcome.
+ * @return The name.
+ */
+static const char* statusName(ReplayCheck::Status m_status)
+{
+    switch (m_status)
+    {
+        case ReplayCheck::VALID: return "valid";
+        case ReplayCheck::ILLEGAL_MOVE: return "illegal move";
+        case ReplayCheck::WRONG_SCORE: return "wrong score";
+        default: return "bad replay";
+    }
+}
+
+/**
+ * @brief readReplays Decodes every replay in a file, stopping at the first log which can't be decoded.
+ * @param m_path The file.
+ * @param m_replays Receives the replays, after any already in it.
+ * @param m_sources Receives where each replay came from.
+ * @return True if the whole file was read.
+ */
+static bool readReplays(const char* m_path, vector<Replay>& m_replays, vector<Source>& m_sources)
+{
+    MappedFile file; // The replay file
+    Replay replay; // The replay being decoded
+    Source source; // Where it came from
+    size_t offset = 0; // Offset of the next log
+    size_t n; // Size of the last log read
+
+    if (!file.open(m_path)) // Missing or unreadable
+    {
+        printf("%s: can't open\n", m_path);
+        return false;
+    }
+
+    source.path = m_path;
+    source.index = 0;
+
+    while (offset < file.size()) // Logs follow each other with no framing
+    {
+        if ((n = replayDecode(file.data() + offset, file.size() - offset, replay)) == 0) // Torn, corrupt, or from another version
+        {
+            printf("%s: unreadable from byte %llu, after %llu replays\n", m_path, (unsigned long long)offset, (unsigned long long)source.index);
+            return false;
+        }
+
+        m_replays.push_back(replay);
+        m_sources.push_back(source);
+        source.index++;
+        offset += n;
+    }
+
+    return true;
+}
+
+/**
+ * @brief usage Prints the usage message.
+ * @param m_name The program's name.
+ * @return The exit code for bad arguments.
+ */
+static int usage(const char* m_name)
+{
+    fprintf(stderr, "usage: %s [--threads N] FILE...\n", m_name);
+    return 2;
+}
+
+int main(int argc, char* argv[])
+{
+    vector<const char*> paths; // Replay files
+    vector<Replay> replays; // Every replay, from every file
+    vector<Source> sources; // Where each one came from
+    vector<ReplayCheck> checks; // Outcome of each one
+    int threads = 0; // # of threads to verify on, or 0 for one per core
+    bool allRead = true; // False if a file couldn't be read to its end
+    size_t valid = 0; // # of valid replays
+    int i; // Argument counter
+    size_t k; // Replay counter
+    double seconds; // Time spent verifying
+    Clock::time_point start; // When verification started
+
+    for (i = 1; i < argc; i++) // Parse the arguments
+    {
+        if (strcmp(argv[i], "--threads") == 0 && i+1 < argc)
+        {
+            threads = atoi(argv[++i]);
+        }
+
+        else if (argv[i][0] == '-') // Unknown option
+        {
+            return usage(argv[0]);
+        }
+
+        else
+        {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    if (paths.empty() || threads < 0) // Nothing to verify, or a negative thread count
+    {
+        return usage(argv[0]);
+    }
+
+    for (k = 0; k < paths.size(); k++) // Decode every file first, so that all of them are verified in one parallel pass
+    {
+        allRead = readReplays(paths[k], replays, sources) && allRead;
+    }
+
+    start = Clock::now();
+    replayVerifyAll(replays, checks, threads);
+    seconds = chrono::duration<double>(Clock::now() - start).count();
+
+    for (k = 0; k < replays.size(); k++) // Report them in file order
+    {
+        const Replay& r = replays[k]; // The replay
+        const ReplayCheck& c = checks[k]; // Its outcome
+
+        printf("%s #%llu: %s, %dx%d, %d colours, seed %llu, ", sources[k].path, (unsigned long long)sources[k].index,
+               statusName(c.status), r.rows, r.cols, r.nColours, (unsigned long long)r.seed);
+
+        if (c.status == ReplayCheck::VALID)
+        {
+            printf("score %d, %d moves%s\n", c.score, c.movesPlayed, c.finished ? "" : ", game not over");
+            valid++;
+        }
+
+        else if (c.status == ReplayCheck::ILLEGAL_MOVE)
+        {
+            printf("move %d of %d is illegal\n", c.movesPlayed + 1, int(r.moves.size()));
+        }
+
+        else if (c.status == ReplayCheck::WRONG_SCORE)
+        {
+            printf("claims %d but scores %d, %d moves\n", r.score, c.score, c.movesPlayed);
+        }
+
+        else // Impossible size or # of colours
+        {
+            printf("no such game\n");
+        }
+    }
+
+    fprintf(stderr, "%llu of %llu replays valid, verified in %.3f s\n", (unsigned long long)valid, (unsigned long long)replays.size(), seconds);
+    return (allRead && valid == replays.size()) ? 0 : 1;
+}